@@ -12,31 +12,73 @@
 #define IS_VECTOR 1
 #define VECTOR_COLS 0
 
+#include <algorithm>
 #include <math.h>
 #include "Activation.h"
 #include "Matrix.h"
 
 /**
- * Accepts activation type (Relu/Softmax)
+ * Accepts activation type (Relu/Softmax/Identity)
  * and defines the instance's activation accordingly.
  *
  * @param actType The type of activation function to use.
  */
 Activation::Activation(ActivationType actType) : _type(actType)
 {
-    _activate = (actType == Relu) ? _relu : _softmax;
+    _activate = (actType == Relu) ? _relu : (actType == Softmax) ? _softmax : _identity;
 }
 
 /**
- * Returns this activation's type (Relu/Softmax).
+ * Returns this activation's type (Relu/Softmax/Identity).
  *
- * @return This activation's type (Relu/Softmax).
+ * @return This activation's type (Relu/Softmax/Identity).
  */
 ActivationType Activation::getActivationType() const
 {
     return _type;
 }
 
+/**
+ * Applies activation function on every row of a batch, in place.
+ * (Each row holds a single sample)
+ *
+ * @param batch The batch to activate.
+ */
+void Activation::activateRows(Matrix &batch) const
+{
+    int rows = batch.getRows(), cols = batch.getCols();
+    for (int i = 0; i < rows && _type != Identity; i++)
+    {
+        if (_type == Relu)
+        {
+            for (int j = 0; j < cols; j++)
+            {
+                if (batch(i, j) < 0.0f)
+                {
+                    batch(i, j) = 0.0f;
+                }
+            }
+            continue;
+        }
+
+        // Shifted by the largest logit, so exp() never overflows (softmax is shift invariant).
+        float largest = batch(i, 0);
+        for (int j = 1; j < cols; j++)
+        {
+            largest = std::max(largest, batch(i, j));
+        }
+        float sum = 0.0f;
+        for (int j = 0; j < cols; j++)
+        {
+            sum += batch(i, j) = exp(batch(i, j) - largest);
+        }
+        for (int j = 0; j < cols; j++)
+        {
+            batch(i, j) *= (1.0f / sum);
+        }
+    }
+}
+
 /**
  * Applies activation function on input.
  * (Does not change input)
@@ -76,10 +118,21 @@ void Activation::_relu(const Matrix &input, Matrix &output)
 void Activation::_softmax(const Matrix &input, Matrix &output)
 {
     int rows = input.getRows();
+    float largest = input(0, VECTOR_COLS); // Shifted by the largest logit, so exp() never overflows.
+    for (int i = 1; i < rows; i++)
+    {
+        largest = std::max(largest, input(i, VECTOR_COLS));
+    }
     float sum = 0.0f;
     for (int i = 0; i < rows; i++)
     {
-        sum += output(i, VECTOR_COLS) = exp(input(i, VECTOR_COLS));
+        sum += output(i, VECTOR_COLS) = exp(input(i, VECTOR_COLS) - largest);
     }
     output = output * (1.0f / sum);
 }
+
+// Identity activation function.
+void Activation::_identity(const Matrix &input, Matrix &output)
+{
+    output = input;
+}
@@ -19,7 +19,8 @@
 enum ActivationType
 {
     Relu,
-    Softmax
+    Softmax,
+    Identity // Passes values as they are (the inner product of a factorized layer).
 };
 
 /**
@@ -30,7 +31,7 @@ class Activation
 public:
     // Constructors.
     /**
-     * Accepts activation type (Relu/Softmax)
+     * Accepts activation type (Relu/Softmax/Identity)
      * and defines the instance's activation accordingly.
      *
      * @param actType The type of activation function to use.
@@ -39,12 +40,20 @@ public:
 
     // Methods.
     /**
-     * Returns this activation's type (Relu/Softmax).
+     * Returns this activation's type (Relu/Softmax/Identity).
      *
-     * @return This activation's type (Relu/Softmax).
+     * @return This activation's type (Relu/Softmax/Identity).
      */
     ActivationType getActivationType() const;
 
+    /**
+     * Applies activation function on every row of a batch, in place.
+     * (Each row holds a single sample)
+     *
+     * @param batch The batch to activate.
+     */
+    void activateRows(Matrix &batch) const;
+
     // Operators.
     /**
      * Applies activation function on input.
@@ -61,6 +70,7 @@ private:
     void (*_activate)(const Matrix &input, Matrix &output);
     static void _relu(const Matrix &input, Matrix &output); // Relu activation function.
     static void _softmax(const Matrix &input, Matrix &output); // Softmax activation function.
+    static void _identity(const Matrix &input, Matrix &output); // Identity activation function.
 };
 
 #endif //ACTIVATION_H
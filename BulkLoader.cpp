@@ -0,0 +1,359 @@
+/**
+ * @file BulkLoader.cpp
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Implementation file for the BulkLoader class which reads many small image files at once through io_uring,
+ * straight into the rows of a batch.
+ */
+
+#define ERROR_NOT_IMAGE_LIST "Error: Neither a directory nor a manifest of images: "
+#define ERROR_RING_FAILED "Error: io_uring failed: "
+
+#define OP_OPEN 0
+#define OP_READ 1
+#define OP_CLOSE 2
+#define OP_BITS 2
+#define OPS_PER_FILE 2 // A file has at most 2 operations in flight at once (its open, or its read and close).
+
+// Trace names.
+#define READ_EVENT "read files"
+#define CONVERT_EVENT "convert images"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include "BulkLoader.h"
+#include "ImageLoader.h"
+#include "Tracer.h"
+
+/**
+ * The rings of an io_uring, as mapped from the kernel. The submission queue is written by the loader
+ * and read by the kernel, the completion queue the other way around; their heads and tails are
+ * loaded and stored with acquire / release ordering.
+ */
+struct BulkLoader::Ring
+{
+    int fd;
+    unsigned entries;
+    void *sqMapping, *cqMapping;
+    size_t sqSize, cqSize, sqesSize;
+    unsigned *sqHead, *sqTail, *sqMask, *sqArray;
+    unsigned *cqHead, *cqTail, *cqMask;
+    io_uring_sqe *sqes;
+    io_uring_cqe *cqes;
+    unsigned queued; // Entries written past the submission queue's tail, not submitted yet.
+};
+
+// Queues an operation on a file, returns its submission queue entry (zeroed but for the user data)
+// to be filled before the next submission.
+io_uring_sqe *BulkLoader::_queue(Ring &ring, size_t file, int op)
+{
+    unsigned index = (*ring.sqTail + ring.queued++) & *ring.sqMask;
+    io_uring_sqe *sqe = &ring.sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->user_data = ((uint64_t) file << OP_BITS) | (uint64_t) op;
+    ring.sqArray[index] = index;
+    return sqe;
+}
+
+// Submits the queued operations and waits for at least one completion, returns false upon failure.
+bool BulkLoader::_submitAndWait(Ring &ring)
+{
+    // The kernel sees the queued entries, complete by now, once the tail moves past them.
+    __atomic_store_n(ring.sqTail, *ring.sqTail + ring.queued, __ATOMIC_RELEASE);
+    while (syscall(__NR_io_uring_enter, ring.fd, ring.queued, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0)
+    {
+        if (errno != EINTR)
+        {
+            return false;
+        }
+    }
+    ring.queued = 0;
+    return true;
+}
+
+// Converts a read file in its row: in place for float32, normalized for uint8,
+// returns false for any other file.
+static bool _convert(long bytes, int length, float row[])
+{
+    if (bytes == (long) (length * sizeof(float)))
+    {
+        return true;
+    }
+    if (bytes == length)
+    {
+        // Moved behind the floats they become, so they are normalized in place (see normalizePixels()).
+        unsigned char *tail = (unsigned char *) row + (size_t) length * (sizeof(float) - 1);
+        memmove(tail, row, (size_t) length);
+        normalizePixels(tail, length, row);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Sets up the io_uring of the loader (or falls back to plain system calls).
+ *
+ * @param depth The maximal amount of operations in flight.
+ */
+BulkLoader::BulkLoader(int depth) : _ring(_setupRing((unsigned) std::max(depth, OPS_PER_FILE)))
+{
+}
+
+/**
+ * Tears down the io_uring.
+ */
+BulkLoader::~BulkLoader()
+{
+    if (_ring != nullptr)
+    {
+        munmap(_ring->sqes, _ring->sqesSize);
+        if (_ring->cqMapping != _ring->sqMapping)
+        {
+            munmap(_ring->cqMapping, _ring->cqSize);
+        }
+        munmap(_ring->sqMapping, _ring->sqSize);
+        close(_ring->fd);
+        delete _ring;
+    }
+}
+
+/**
+ * Loads rows * cols images, a file each, into consecutive rows of the batch.
+ *
+ * @param paths The image files.
+ * @param rows The expected amount of rows of an image.
+ * @param cols The expected amount of columns of an image.
+ * @param pixels Output, a row of rows * cols floats per file (the network's input batch).
+ * @param loaded Output, whether every image was loaded (its row is undefined if not).
+ * @return The amount of loaded images.
+ */
+int BulkLoader::load(const std::vector<std::string> &paths, int rows, int cols, float pixels[], bool loaded[])
+{
+    // Every file is read into its row, and a byte past it which tells a longer file apart.
+    int length = rows * cols;
+    std::vector<unsigned char> spare(paths.size());
+    std::vector<struct iovec> vectors(2 * paths.size());
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        vectors[2 * i] = {pixels + i * length, (size_t) length * sizeof(float)};
+        vectors[2 * i + 1] = {&spare[i], 1};
+    }
+    std::vector<long> bytes(paths.size(), -1);
+    Tracer::Clock::time_point start = Tracer::Clock::now();
+    if (_ring != nullptr)
+    {
+        _readIoUring(paths, vectors, bytes);
+    }
+    else
+    {
+        _readSync(paths, vectors, bytes);
+    }
+    Tracer::record(READ_EVENT, TRACE_LOAD, start, (int) paths.size());
+
+    TraceScope trace(CONVERT_EVENT, TRACE_LOAD, (int) paths.size());
+    int count = 0;
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        float *row = pixels + i * length;
+        loaded[i] = _convert(bytes[i], length, row) || loadImage(paths[i], rows, cols, row) != UnknownImage;
+        count += loaded[i];
+    }
+    return count;
+}
+
+/**
+ * Returns whether the loader goes through io_uring.
+ *
+ * @return false if it fell back to plain system calls.
+ */
+bool BulkLoader::usesIoUring() const
+{
+    return _ring != nullptr;
+}
+
+// Reads every file into its iovecs with io_uring, bytes[i] is the amount read from file i (negative on failure).
+void BulkLoader::_readIoUring(const std::vector<std::string> &paths, std::vector<struct iovec> &vectors,
+                              std::vector<long> &bytes)
+{
+    Ring &ring = *_ring;
+    size_t next = 0, done = 0, inFlight = 0, maxInFlight = ring.entries / OPS_PER_FILE;
+    while (done < paths.size())
+    {
+        for (; next < paths.size() && inFlight < maxInFlight; next++, inFlight++)
+        {
+            io_uring_sqe *openSqe = _queue(ring, next, OP_OPEN);
+            openSqe->opcode = IORING_OP_OPENAT;
+            openSqe->fd = AT_FDCWD;
+            openSqe->addr = (uint64_t) paths[next].c_str();
+            openSqe->open_flags = O_RDONLY | O_CLOEXEC;
+        }
+        if (!_submitAndWait(ring))
+        {
+            std::cerr << ERROR_RING_FAILED << strerror(errno) << std::endl;
+            exit(EXIT_FAILURE);
+        }
+
+        unsigned head = *ring.cqHead, tail = __atomic_load_n(ring.cqTail, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++)
+        {
+            const io_uring_cqe &cqe = ring.cqes[head & *ring.cqMask];
+            size_t file = cqe.user_data >> OP_BITS;
+            int op = (int) (cqe.user_data & ((1 << OP_BITS) - 1));
+            if (op == OP_OPEN && cqe.res >= 0)
+            {
+                // The close is hard linked, so it runs (after the read) even if the read fails.
+                io_uring_sqe *readSqe = _queue(ring, file, OP_READ);
+                readSqe->opcode = IORING_OP_READV;
+                readSqe->fd = cqe.res;
+                readSqe->addr = (uint64_t) &vectors[2 * file];
+                readSqe->len = 2;
+                readSqe->flags = IOSQE_IO_HARDLINK;
+                io_uring_sqe *closeSqe = _queue(ring, file, OP_CLOSE);
+                closeSqe->opcode = IORING_OP_CLOSE;
+                closeSqe->fd = cqe.res;
+                continue;
+            }
+            if (op == OP_READ)
+            {
+                bytes[file] = cqe.res;
+                continue;
+            }
+            // A failed open, or a close: the file is done.
+            inFlight--;
+            done++;
+        }
+        __atomic_store_n(ring.cqHead, head, __ATOMIC_RELEASE);
+    }
+}
+
+// Reads every file into its iovecs with plain system calls.
+void BulkLoader::_readSync(const std::vector<std::string> &paths, std::vector<struct iovec> &vectors,
+                           std::vector<long> &bytes)
+{
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        int fd = open(paths[i].c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd >= 0)
+        {
+            bytes[i] = readv(fd, &vectors[2 * i], 2);
+            close(fd);
+        }
+    }
+}
+
+// Sets up an io_uring of the given depth, nullptr if the kernel doesn't allow it.
+BulkLoader::Ring *BulkLoader::_setupRing(unsigned depth)
+{
+    io_uring_params params = {};
+    int fd = (int) syscall(__NR_io_uring_setup, depth, &params);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+
+    Ring *ring = new Ring();
+    ring->fd = fd;
+    ring->entries = params.sq_entries;
+    ring->sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single)
+    {
+        ring->sqSize = ring->cqSize = std::max(ring->sqSize, ring->cqSize);
+    }
+    ring->sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    ring->sqMapping = mmap(nullptr, ring->sqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                           IORING_OFF_SQ_RING);
+    ring->cqMapping = single ? ring->sqMapping
+                             : mmap(nullptr, ring->cqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                                    IORING_OFF_CQ_RING);
+    void *sqes = mmap(nullptr, ring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                      IORING_OFF_SQES);
+    if (ring->sqMapping == MAP_FAILED || ring->cqMapping == MAP_FAILED || sqes == MAP_FAILED)
+    {
+        if (ring->sqMapping != MAP_FAILED)
+        {
+            munmap(ring->sqMapping, ring->sqSize);
+        }
+        if (!single && ring->cqMapping != MAP_FAILED)
+        {
+            munmap(ring->cqMapping, ring->cqSize);
+        }
+        if (sqes != MAP_FAILED)
+        {
+            munmap(sqes, ring->sqesSize);
+        }
+        close(fd);
+        delete ring;
+        return nullptr;
+    }
+
+    char *sq = (char *) ring->sqMapping, *cq = (char *) ring->cqMapping;
+    ring->sqHead = (unsigned *) (sq + params.sq_off.head);
+    ring->sqTail = (unsigned *) (sq + params.sq_off.tail);
+    ring->sqMask = (unsigned *) (sq + params.sq_off.ring_mask);
+    ring->sqArray = (unsigned *) (sq + params.sq_off.array);
+    ring->cqHead = (unsigned *) (cq + params.cq_off.head);
+    ring->cqTail = (unsigned *) (cq + params.cq_off.tail);
+    ring->cqMask = (unsigned *) (cq + params.cq_off.ring_mask);
+    ring->cqes = (io_uring_cqe *) (cq + params.cq_off.cqes);
+    ring->sqes = (io_uring_sqe *) sqes;
+    return ring;
+}
+
+/**
+ * Lists the image files to score: the regular files of a directory (by name, hidden ones skipped),
+ * or the lines of a manifest file (a path per line).
+ * Exits (code == 1) if the path is neither.
+ *
+ * @param path A directory or a manifest file.
+ * @return The image files.
+ */
+std::vector<std::string> listImageFiles(const std::string &path)
+{
+    std::vector<std::string> files;
+    struct stat status = {};
+    if (stat(path.c_str(), &status) == 0 && S_ISREG(status.st_mode))
+    {
+        std::ifstream manifest(path);
+        std::string line;
+        while (std::getline(manifest, line))
+        {
+            if (!line.empty())
+            {
+                files.push_back(line);
+            }
+        }
+        return files;
+    }
+
+    DIR *directory = opendir(path.c_str());
+    if (directory == nullptr)
+    {
+        std::cerr << ERROR_NOT_IMAGE_LIST << path << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    std::string prefix = (path.back() == '/') ? path : path + "/";
+    for (dirent *entry = readdir(directory); entry != nullptr; entry = readdir(directory))
+    {
+        if (entry->d_name[0] != '.' && (entry->d_type == DT_REG || entry->d_type == DT_UNKNOWN))
+        {
+            files.push_back(prefix + entry->d_name);
+        }
+    }
+    closedir(directory);
+    std::sort(files.begin(), files.end());
+    return files;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file BulkLoader.h
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Header file for the BulkLoader class which reads many small image files at once through io_uring,
+ * straight into the rows of a batch.
+ */
+
+#ifndef BULKLOADER_H
+#define BULKLOADER_H
+
+#include <string>
+#include <vector>
+#include <sys/uio.h>
+
+#define DEFAULT_LOADER_DEPTH 128
+
+/**
+ * The BulkLoader class- loads batches of image files (one image per file) into the rows of a batch.
+ * The opens, reads and closes of the files are queued on an io_uring (set up through raw system
+ * calls, no liburing) with up to depth operations in flight, so a whole batch takes a few system calls
+ * instead of several per file: a file's read is queued as soon as its open completes, with its close
+ * hard-linked behind it. Every read lands directly in the file's row of the batch.
+ * Raw float32 images are used as they are and raw uint8 images are normalized in place, any other
+ * file (PGM, IDX, unexpected sizes) is loaded again through loadImage().
+ * Where io_uring is unavailable (old kernels, seccomp), files are read with plain open/read/close.
+ * Not thread safe, a loader is used by one thread at a time.
+ */
+class BulkLoader
+{
+public:
+    // Constructors.
+    /**
+     * Sets up the io_uring of the loader (or falls back to plain system calls).
+     *
+     * @param depth The maximal amount of operations in flight.
+     */
+    explicit BulkLoader(int depth = DEFAULT_LOADER_DEPTH);
+
+    /**
+     * Tears down the io_uring.
+     */
+    ~BulkLoader();
+
+    BulkLoader(const BulkLoader &other) = delete;
+
+    BulkLoader &operator=(const BulkLoader &other) = delete;
+
+    // Methods.
+    /**
+     * Loads rows * cols images, a file each, into consecutive rows of the batch.
+     *
+     * @param paths The image files.
+     * @param rows The expected amount of rows of an image.
+     * @param cols The expected amount of columns of an image.
+     * @param pixels Output, a row of rows * cols floats per file (the network's input batch).
+     * @param loaded Output, whether every image was loaded (its row is undefined if not).
+     * @return The amount of loaded images.
+     */
+    int load(const std::vector<std::string> &paths, int rows, int cols, float pixels[], bool loaded[]);
+
+    /**
+     * Returns whether the loader goes through io_uring.
+     *
+     * @return false if it fell back to plain system calls.
+     */
+    bool usesIoUring() const;
+
+private:
+    struct Ring; // The mapped rings of the io_uring.
+
+    Ring *_ring; // nullptr without io_uring.
+
+    // Sets up an io_uring of the given depth, nullptr if the kernel doesn't allow it.
+    static Ring *_setupRing(unsigned depth);
+
+    // Queues an operation on a file, returns its submission queue entry (zeroed but for the user data)
+    // to be filled before the next submission.
+    static struct io_uring_sqe *_queue(Ring &ring, size_t file, int op);
+
+    // Submits the queued operations and waits for at least one completion, returns false upon failure.
+    static bool _submitAndWait(Ring &ring);
+
+    // Reads every file into its iovecs with io_uring, bytes[i] is the amount read from file i (negative on failure).
+    void _readIoUring(const std::vector<std::string> &paths, std::vector<struct iovec> &vectors,
+                      std::vector<long> &bytes);
+
+    // Reads every file into its iovecs with plain system calls.
+    static void _readSync(const std::vector<std::string> &paths, std::vector<struct iovec> &vectors,
+                          std::vector<long> &bytes);
+};
+
+/**
+ * Lists the image files to score: the regular files of a directory (by name, hidden ones skipped),
+ * or the lines of a manifest file (a path per line).
+ * Exits (code == 1) if the path is neither.
+ *
+ * @param path A directory or a manifest file.
+ * @return The image files.
+ */
+std::vector<std::string> listImageFiles(const std::string &path);
+
+#endif //BULKLOADER_H
@@ -4,7 +4,8 @@
  * @version 1.0
  * @date 24 January 2020
  *
- * @brief Implementation file for the Dense class which represents a layer in a MlpNetwork.
+ * @brief Implementation file for the BasicDense class which represents a layer in a MlpNetwork,
+ * of weights of any element type.
  */
 
 #include "Dense.h"
@@ -18,9 +19,9 @@
  * @param bias The bias Matrix (Vector) for this layer.
  * @param actType The activation type to be used in this layer.
  */
-Dense::Dense(const Matrix &w, const Matrix &bias, ActivationType actType) : _weights(w),
-                                                                            _bias(bias),
-                                                                            _activation(actType)
+template<typename W, typename A>
+BasicDense<W, A>::BasicDense(const BasicMatrix<W> &w, const Matrix &bias, ActivationType actType)
+        : _weights(w), _bias(bias), _activation(actType)
 {}
 
 /**
@@ -29,7 +30,8 @@ Dense::Dense(const Matrix &w, const Matrix &bias, ActivationType actType) : _wei
  *
  * @return The weights of this layer.
  */
-const Matrix &Dense::getWeights() const
+template<typename W, typename A>
+const BasicMatrix<W> &BasicDense<W, A>::getWeights() const
 {
     return _weights;
 }
@@ -40,7 +42,8 @@ const Matrix &Dense::getWeights() const
  *
  * @return The bias of this layer.
  */
-const Matrix &Dense::getBias() const
+template<typename W, typename A>
+const Matrix &BasicDense<W, A>::getBias() const
 {
     return _bias;
 }
@@ -51,7 +54,8 @@ const Matrix &Dense::getBias() const
  *
  * @return The activation function of this layer.
  */
-const Activation &Dense::getActivation() const
+template<typename W, typename A>
+const Activation &BasicDense<W, A>::getActivation() const
 {
     return _activation;
 }
@@ -62,7 +66,85 @@ const Activation &Dense::getActivation() const
  * @param input The Matrix to apply this layer on.
  * @return The input Matrix after applying this layer on it (new Matrix).
  */
-Matrix Dense::operator()(const Matrix &input) const
+template<typename W, typename A>
+Matrix BasicDense<W, A>::operator()(const Matrix &input) const
 {
-    return _activation((_weights * input) + _bias);
+    return (*this)(input.view());
 }
+
+/**
+ * Applies the layer on a view (i.e. a vectorized image or a row of a batch, reshaped)
+ * without copying it first.
+ *
+ * @param input The view to apply this layer on.
+ * @return The input after applying this layer on it (new Matrix).
+ */
+template<typename W, typename A>
+Matrix BasicDense<W, A>::operator()(const MatrixView &input) const
+{
+    if (_weights.getCols() != input.getRows() || _bias.getRows() != _weights.getRows())
+    {
+        matrixDimsError();
+    }
+
+    Matrix output(_weights.getRows(), input.getCols());
+    for (int i = 0; i < output.getRows(); i++)
+    {
+        for (int j = 0; j < output.getCols(); j++)
+        {
+            A sum = 0;
+            for (int k = 0; k < _weights.getCols(); k++)
+            {
+                sum += (A) widen(_weights.at(i, k)) * (A) input(k, j);
+            }
+            output(i, j) = (float) (sum * (A) _weights.getScale()) + _bias.at(i, 0);
+        }
+    }
+    return _activation(output);
+}
+
+/**
+ * Applies the layer on every row of a batch and returns the output batch.
+ *
+ * @param batch The batch to apply this layer on, a sample in every row.
+ * @return The output batch, a sample in every row (new Matrix).
+ */
+template<typename W, typename A>
+Matrix BasicDense<W, A>::applyBatch(const Matrix &batch) const
+{
+    if (_weights.getCols() != batch.getCols())
+    {
+        matrixDimsError();
+    }
+
+    // The samples (a column each) are widened to A, so their products with the weights accumulate in A.
+    BasicMatrix<A> samples(batch.getCols(), batch.getRows());
+    for (int s = 0; s < batch.getRows(); s++)
+    {
+        for (int k = 0; k < batch.getCols(); k++)
+        {
+            samples(k, s) = (A) batch.at(s, k);
+        }
+    }
+    BasicMatrix<typename ProductTraits<W, A>::Accumulator> product(multiply(_weights, samples));
+
+    Matrix output(batch.getRows(), _weights.getRows());
+    for (int s = 0; s < batch.getRows(); s++)
+    {
+        for (int i = 0; i < _weights.getRows(); i++)
+        {
+            output(s, i) = (float) ((A) product.at(i, s) * (A) product.getScale());
+        }
+    }
+    output.addToEachRow(_bias);
+    _activation.activateRows(output);
+    return output;
+}
+
+// The float layer, and the double precision reference of every element type mlpcompress writes weights in.
+template class BasicDense<float>;
+template class BasicDense<float, double>;
+template class BasicDense<double>;
+template class BasicDense<BFloat16, double>;
+template class BasicDense<int8_t, double>;
+template class BasicDense<int32_t, double>;
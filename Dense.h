@@ -4,7 +4,8 @@
  * @version 1.0
  * @date 24 January 2020
  *
- * @brief Header file for the Dense class which represents a layer in a MlpNetwork.
+ * @brief Header file for the BasicDense class which represents a layer in a MlpNetwork,
+ * of weights of any element type.
  */
 
 #ifndef DENSE_H
@@ -14,9 +15,15 @@
 #include "Activation.h"
 
 /**
- * The Dense class- represents a layer in a MlpNetwork.
+ * The BasicDense class- represents a layer in a MlpNetwork, whose weights are W elements
+ * (quantized weights are scaled back by their scale, see BasicMatrix::quantize()).
+ * Products of the weights and the (float) input accumulate in A, by default the accumulator of
+ * W x float (see ProductTraits), e.g. BasicDense<int8_t, double> is the double precision reference
+ * mlpcompress checks int8 layers against.
+ * Outputs are float, as the activations take them.
  */
-class Dense
+template<typename W, typename A = typename ProductTraits<W, float>::Accumulator>
+class BasicDense
 {
 public:
     // Constructors.
@@ -27,7 +34,7 @@ public:
      * @param bias The bias Matrix (Vector) for this layer.
      * @param actType The activation type to be used in this layer.
      */
-    Dense(const Matrix &w, const Matrix &bias, ActivationType actType);
+    BasicDense(const BasicMatrix<W> &w, const Matrix &bias, ActivationType actType);
 
     // Methods.
     /**
@@ -36,7 +43,7 @@ public:
      *
      * @return The weights of this layer.
      */
-    const Matrix &getWeights() const;
+    const BasicMatrix<W> &getWeights() const;
 
     /**
      * Returns the bias of this layer.
@@ -63,9 +70,30 @@ public:
      */
     Matrix operator()(const Matrix &input) const;
 
+    /**
+     * Applies the layer on a view (i.e. a vectorized image or a row of a batch, reshaped)
+     * without copying it first.
+     *
+     * @param input The view to apply this layer on.
+     * @return The input after applying this layer on it (new Matrix).
+     */
+    Matrix operator()(const MatrixView &input) const;
+
+    /**
+     * Applies the layer on every row of a batch and returns the output batch.
+     *
+     * @param batch The batch to apply this layer on, a sample in every row.
+     * @return The output batch, a sample in every row (new Matrix).
+     */
+    Matrix applyBatch(const Matrix &batch) const;
+
 private:
-    const Matrix& _weights, _bias;
+    const BasicMatrix<W> &_weights;
+    const Matrix &_bias;
     const Activation _activation;
 };
 
+// The layer of float weights.
+typedef BasicDense<float> Dense;
+
 #endif //DENSE_H
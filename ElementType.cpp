@@ -0,0 +1,70 @@
+/**
+ * @file ElementType.cpp
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Implementation file for the element types of a BasicMatrix.
+ */
+
+#include "ElementType.h"
+
+const ElementType ElementTraits<float>::type;
+const ElementType ElementTraits<double>::type;
+const ElementType ElementTraits<BFloat16>::type;
+const ElementType ElementTraits<int8_t>::type;
+const ElementType ElementTraits<uint8_t>::type;
+const ElementType ElementTraits<int32_t>::type;
+const int32_t ElementTraits<int8_t>::quantizedMax;
+const int32_t ElementTraits<uint8_t>::quantizedMax;
+const int32_t ElementTraits<int32_t>::quantizedMax;
+
+static_assert(sizeof(BFloat16) == 2, "A BFloat16 is stored in 2 bytes.");
+
+// Names and sizes by tag.
+static const char *const ELEMENT_NAMES[] = {"f32", "f64", "bf16", "i8", "u8", "i32"};
+static const size_t ELEMENT_SIZES[] = {sizeof(float), sizeof(double), sizeof(BFloat16), sizeof(int8_t),
+                                       sizeof(uint8_t), sizeof(int32_t)};
+static const int ELEMENT_TYPES = sizeof(ELEMENT_SIZES) / sizeof(ELEMENT_SIZES[0]);
+
+/**
+ * Returns the size of an element of a type.
+ *
+ * @param type The element type.
+ * @return Its size in bytes, 0 for an unknown type.
+ */
+size_t elementSize(ElementType type)
+{
+    return (type >= 0 && type < ELEMENT_TYPES) ? ELEMENT_SIZES[type] : 0;
+}
+
+/**
+ * Returns the name of an element type (f32, f64, bf16, i8, u8 or i32).
+ *
+ * @param type The element type.
+ * @return Its name.
+ */
+const char *elementName(ElementType type)
+{
+    return (type >= 0 && type < ELEMENT_TYPES) ? ELEMENT_NAMES[type] : "?";
+}
+
+/**
+ * Parses the name of an element type (see elementName()).
+ *
+ * @param name The name.
+ * @param type Output, the element type (untouched upon failure).
+ * @return false if there is no such type.
+ */
+bool parseElementType(const std::string &name, ElementType &type)
+{
+    for (int i = 0; i < ELEMENT_TYPES; i++)
+    {
+        if (name == ELEMENT_NAMES[i])
+        {
+            type = (ElementType) i;
+            return true;
+        }
+    }
+    return false;
+}
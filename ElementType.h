@@ -0,0 +1,186 @@
+/**
+ * @file ElementType.h
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Header file for the element types of a BasicMatrix: the BFloat16 class, the traits of
+ * every type (its tag, accumulator and quantization range) and the accumulator of mixed products.
+ */
+
+#ifndef ELEMENTTYPE_H
+#define ELEMENTTYPE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+/**
+ * @enum ElementType
+ * @brief The tag of an element type, as stored in a matrix file.
+ */
+enum ElementType
+{
+    FloatElement = 0,
+    DoubleElement = 1,
+    BFloat16Element = 2,
+    Int8Element = 3,
+    UInt8Element = 4,
+    Int32Element = 5
+};
+
+/**
+ * The BFloat16 class- a 16 bit float: the sign, the exponent and the upper 7 bits of the mantissa
+ * of a float. Converted from a float by rounding to nearest even, back to a float exactly.
+ */
+class BFloat16
+{
+public:
+    // Constructors.
+    /**
+     * Constructs a zero.
+     */
+    BFloat16() : _bits(0)
+    {}
+
+    /**
+     * Constructs the BFloat16 nearest to a float.
+     *
+     * @param value The float.
+     */
+    explicit BFloat16(float value) : _bits(_round(value))
+    {}
+
+    // Operators.
+    /**
+     * Returns the value as a float (exact).
+     *
+     * @return The value.
+     */
+    operator float() const
+    {
+        uint32_t bits = (uint32_t) _bits << 16;
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+private:
+    uint16_t _bits;
+
+    // Rounds the bits of a float to its upper half, to nearest even (NaNs stay quiet NaNs).
+    static uint16_t _round(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        if ((bits & 0x7fffffffu) > 0x7f800000u)
+        {
+            return (uint16_t) ((bits >> 16) | 0x40u);
+        }
+        return (uint16_t) ((bits + 0x7fffu + ((bits >> 16) & 1u)) >> 16);
+    }
+};
+
+/**
+ * The ElementTraits struct- what a BasicMatrix knows about its element type:
+ * its tag, the type its products accumulate in and, for integers, the largest quantized magnitude
+ * (an integer matrix holds round(value / scale), see BasicMatrix::quantize()).
+ */
+template<typename T>
+struct ElementTraits;
+
+template<>
+struct ElementTraits<float>
+{
+    static const ElementType type = FloatElement;
+    typedef float Accumulator;
+};
+
+template<>
+struct ElementTraits<double>
+{
+    static const ElementType type = DoubleElement;
+    typedef double Accumulator;
+};
+
+template<>
+struct ElementTraits<BFloat16>
+{
+    static const ElementType type = BFloat16Element;
+    typedef float Accumulator;
+};
+
+template<>
+struct ElementTraits<int8_t>
+{
+    static const ElementType type = Int8Element;
+    typedef int32_t Accumulator;
+    static const int32_t quantizedMax = 127; // Symmetric, -128 is never used.
+};
+
+template<>
+struct ElementTraits<uint8_t>
+{
+    static const ElementType type = UInt8Element;
+    typedef int32_t Accumulator;
+    static const int32_t quantizedMax = 255; // Non negative values only (pixels, Relu activations).
+};
+
+template<>
+struct ElementTraits<int32_t>
+{
+    static const ElementType type = Int32Element;
+    typedef int32_t Accumulator;
+    static const int32_t quantizedMax = 1 << 24; // Every quantized value is exact in a float.
+};
+
+/**
+ * The ProductTraits struct- the accumulator of a product of A and B elements: int32 for two integer
+ * types (int8 x uint8 -> int32), otherwise the wider of their float accumulators (bf16 x fp32 -> fp32).
+ */
+template<typename A, typename B>
+struct ProductTraits
+{
+    typedef decltype(typename ElementTraits<A>::Accumulator() *
+                     typename ElementTraits<B>::Accumulator()) Accumulator;
+};
+
+/**
+ * Converts an element to the type its products accumulate in (BFloat16 to float, int8_t to int32_t..).
+ *
+ * @param value The element.
+ * @return The element as an accumulator.
+ */
+template<typename T>
+inline typename ElementTraits<T>::Accumulator widen(T value)
+{
+    return static_cast<typename ElementTraits<T>::Accumulator>(value);
+}
+
+/**
+ * Returns the size of an element of a type.
+ *
+ * @param type The element type.
+ * @return Its size in bytes, 0 for an unknown type.
+ */
+size_t elementSize(ElementType type);
+
+/**
+ * Returns the name of an element type (f32, f64, bf16, i8, u8 or i32).
+ *
+ * @param type The element type.
+ * @return Its name.
+ */
+const char *elementName(ElementType type);
+
+/**
+ * Parses the name of an element type (see elementName()).
+ *
+ * @param name The name.
+ * @param type Output, the element type (untouched upon failure).
+ * @return false if there is no such type.
+ */
+bool parseElementType(const std::string &name, ElementType &type);
+
+#endif //ELEMENTTYPE_H
@@ -0,0 +1,108 @@
+/**
+ * @file EmbeddedNetwork.cpp
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Implementation file for the EmbeddedNetwork class which runs a network compiled into the binary.
+ */
+
+#define ERROR_BAD_EMBEDDED_DIMS "Error: The embedded model doesn't match the dimensions of an MlpNetwork."
+#define ERROR_BAD_INPUT_DIMS "Error: You have given the embedded network an input of improper dimensions"
+
+#define IS_VECTOR 1
+
+#include <string>
+#include <vector>
+#include "EmbeddedNetwork.h"
+#include "MlpNetwork.h"
+
+/**
+ * Constructs the network of the generated model.
+ * Exits (code == 1) if the model doesn't take an image and return a probability per digit.
+ */
+EmbeddedNetwork::EmbeddedNetwork()
+{
+    std::vector<PackedWeights> layers;
+    std::vector<ActivationType> activations;
+    std::vector<std::string> names;
+    for (int i = 0; i < EMBEDDED_STEP_COUNT; i++)
+    {
+        const EmbeddedStep &step = EMBEDDED_STEPS[i];
+        layers.emplace_back(step.panels, step.rows, step.cols);
+        activations.push_back(step.activation);
+        names.emplace_back(step.name);
+    }
+    if (layers.empty() || layers.front().getCols() != imgDims.rows * imgDims.cols ||
+        layers.back().getRows() != weightsDims[MLP_SIZE - 1].rows || activations.back() != Softmax)
+    {
+        std::cerr << ERROR_BAD_EMBEDDED_DIMS << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    _plan = ExecutionPlan(layers, activations, names);
+}
+
+/**
+ * Applies the network on a view of the input.
+ *
+ * @param input The input view (784 * 1).
+ * @return Digit struct that represents the most likely digit in the image.
+ */
+Digit EmbeddedNetwork::operator()(const MatrixView &input) const
+{
+    if (input.getRows() != (imgDims.rows * imgDims.cols) || input.getCols() != IS_VECTOR)
+    {
+        std::cerr << ERROR_BAD_INPUT_DIMS << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    Matrix workspace(1, (int) _plan.workspaceLength(1));
+    Digit result;
+    if (input.isContiguous())
+    {
+        predictBatch(input.data(), 1, workspace.data(), &result);
+    }
+    else
+    {
+        predictBatch(Matrix(input).data(), 1, workspace.data(), &result);
+    }
+    return result;
+}
+
+/**
+ * Applies the network on count images in a caller-owned workspace, without allocating.
+ *
+ * @param images count vectorized images, one after the other.
+ * @param count The amount of images.
+ * @param workspace At least workspaceLength(count) floats.
+ * @param results Output array with a Digit per image.
+ */
+void EmbeddedNetwork::predictBatch(const float images[], int count, float workspace[], Digit results[]) const
+{
+    const float *result = _plan.run(images, count, workspace);
+    for (int i = 0; i < count; i++)
+    {
+        results[i] = MlpNetwork::mostLikely(result + (size_t) i * _plan.getOutputLength());
+    }
+}
+
+/**
+ * Returns the amount of workspace floats a prediction over count images needs.
+ *
+ * @param count The amount of images.
+ * @return The workspace length.
+ */
+size_t EmbeddedNetwork::workspaceLength(int count) const
+{
+    return _plan.workspaceLength(count);
+}
+
+/**
+ * Returns the execution plan of the network.
+ *
+ * @return The plan.
+ */
+const ExecutionPlan &EmbeddedNetwork::getPlan() const
+{
+    return _plan;
+}
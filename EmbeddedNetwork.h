@@ -0,0 +1,128 @@
+/**
+ * @file EmbeddedNetwork.h
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Header file for the EmbeddedNetwork class which runs a network compiled into the binary,
+ * and for the layout of the generated model it runs (see mlpEmbed.cpp).
+ */
+
+#ifndef EMBEDDEDNETWORK_H
+#define EMBEDDEDNETWORK_H
+
+#include <cstddef>
+#include "Activation.h"
+#include "Digit.h"
+#include "ExecutionPlan.h"
+#include "MatrixView.h"
+#include "PackedWeights.h"
+
+/**
+ * The EmbeddedLayer struct- the packed panels of a step (see PackedWeights.h) as a constant of the
+ * binary, its shape encoded in its type. The generated model chains its steps at compile time,
+ * so a model whose steps don't fit each other doesn't build.
+ */
+template<int ROWS, int COLS>
+struct EmbeddedLayer
+{
+    static constexpr int rows = ROWS;
+    static constexpr int cols = COLS;
+    static constexpr size_t length = (size_t) (ROWS + PackedWeights::PANEL_ROWS - 1) / PackedWeights::PANEL_ROWS *
+                                     PackedWeights::PANEL_ROWS * (COLS + 1);
+    alignas(64) float panels[length];
+};
+
+/**
+ * @struct EmbeddedStep
+ * @brief A step of the generated model.
+ * @var panels - The packed panels of the step (in .rodata)
+ * @var rows - The amount of outputs
+ * @var cols - The amount of inputs
+ * @var activation - The activation of the step
+ * @var name - The name of the step (its events in a trace)
+ */
+typedef struct EmbeddedStep
+{
+    const float *panels;
+    int rows;
+    int cols;
+    ActivationType activation;
+    const char *name;
+} EmbeddedStep;
+
+/**
+ * Returns the step of an embedded layer.
+ *
+ * @param layer The layer.
+ * @param activation The activation of the step.
+ * @param name The name of the step.
+ * @return The step.
+ */
+template<int ROWS, int COLS>
+constexpr EmbeddedStep embeddedStep(const EmbeddedLayer<ROWS, COLS> &layer, ActivationType activation,
+                                    const char *name)
+{
+    return {layer.panels, ROWS, COLS, activation, name};
+}
+
+// Defined by the generated model.
+extern const EmbeddedStep EMBEDDED_STEPS[];
+extern const int EMBEDDED_STEP_COUNT;
+extern const char *const EMBEDDED_SOURCE; // The parameters files it was generated from.
+
+/**
+ * The EmbeddedNetwork class- the network compiled into the binary. Its plan runs straight on the
+ * panels of the generated model, so it is ready to infer without reading a file or copying a weight.
+ * Computes exactly what an MlpNetwork of the parameters files the model was generated from computes.
+ */
+class EmbeddedNetwork
+{
+public:
+    // Constructors.
+    /**
+     * Constructs the network of the generated model.
+     * Exits (code == 1) if the model doesn't take an image and return a probability per digit.
+     */
+    EmbeddedNetwork();
+
+    // Operators.
+    /**
+     * Applies the network on a view of the input.
+     *
+     * @param input The input view (784 * 1).
+     * @return Digit struct that represents the most likely digit in the image.
+     */
+    Digit operator()(const MatrixView &input) const;
+
+    // Methods.
+    /**
+     * Applies the network on count images in a caller-owned workspace, without allocating.
+     *
+     * @param images count vectorized images, one after the other.
+     * @param count The amount of images.
+     * @param workspace At least workspaceLength(count) floats.
+     * @param results Output array with a Digit per image.
+     */
+    void predictBatch(const float images[], int count, float workspace[], Digit results[]) const;
+
+    /**
+     * Returns the amount of workspace floats a prediction over count images needs.
+     *
+     * @param count The amount of images.
+     * @return The workspace length.
+     */
+    size_t workspaceLength(int count) const;
+
+    /**
+     * Returns the execution plan of the network.
+     *
+     * @return The plan.
+     */
+    const ExecutionPlan &getPlan() const;
+
+private:
+    ExecutionPlan _plan;
+};
+
+#endif //EMBEDDEDNETWORK_H
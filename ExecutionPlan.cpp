@@ -0,0 +1,317 @@
+/**
+ * @file ExecutionPlan.cpp
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Implementation file for the ExecutionPlan class, the immutable form a MlpNetwork compiles
+ * itself into: the ordered fused layer steps, their kernels, shapes and workspace offsets.
+ */
+
+#define ERROR_BAD_PLAN "Error: Layers of an execution plan don't match each other."
+#define ERROR_BAD_TUNING "Error: Kernel configuration doesn't fit the execution plan."
+
+#define DEFAULT_L1_BYTES (32 * 1024)
+#define DEFAULT_L2_BYTES (1024 * 1024)
+#define CACHE_SHARE 2 // Leave half of every cache to everything else.
+#define SOFTMAX_EVENT "softmax"
+
+#include <algorithm>
+#include <math.h>
+#include <unistd.h>
+#include "ExecutionPlan.h"
+#include "Tracer.h"
+
+// Returns the size of a data cache (sysconf name), or the fallback if unknown.
+static size_t _cacheBytes(int name, size_t fallback)
+{
+    long bytes = sysconf(name);
+    return (bytes > 0) ? (size_t) bytes : fallback;
+}
+
+// Applies Softmax on every sample of count results of length floats, in place.
+static void _softmax(float values[], int count, int length)
+{
+    for (int i = 0; i < count; i++, values += length)
+    {
+        // Shifted by the largest logit, so exp() never overflows (softmax is shift invariant).
+        float largest = values[0];
+        for (int j = 1; j < length; j++)
+        {
+            largest = std::max(largest, values[j]);
+        }
+        float sum = 0.0f;
+        for (int j = 0; j < length; j++)
+        {
+            sum += values[j] = exp(values[j] - largest);
+        }
+        for (int j = 0; j < length; j++)
+        {
+            values[j] *= (1.0f / sum);
+        }
+    }
+}
+
+/**
+ * Constructs an empty plan (no steps).
+ */
+ExecutionPlan::ExecutionPlan() : _regionLengths{0, 0}, _microBatch(PackedWeights::BATCH_TILE)
+{}
+
+/**
+ * Compiles the layers into a plan. Exits (code == 1) if a layer's inputs
+ * don't match the outputs of the one before it.
+ *
+ * @param layers The packed layers, in order.
+ * @param activations The activation of every layer.
+ * @param names The name of every layer (its events in a trace).
+ * @param tuning The kernel configuration, exits (code == 1) if it doesn't fit the layers.
+ */
+ExecutionPlan::ExecutionPlan(const std::vector<PackedWeights> &layers,
+                             const std::vector<ActivationType> &activations, const std::vector<std::string> &names,
+                             const PlanTuning &tuning)
+        : _regionLengths{0, 0}, _microBatch(0)
+{
+    if (layers.empty() || layers.size() != activations.size() || layers.size() != names.size())
+    {
+        std::cerr << ERROR_BAD_PLAN << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t i = 0; i < layers.size(); i++)
+    {
+        if (i > 0 && layers[i].getCols() != layers[i - 1].getRows())
+        {
+            std::cerr << ERROR_BAD_PLAN << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        size_t &region = _regionLengths[i % 2];
+        region = std::max(region, (size_t) layers[i].getRows());
+    }
+
+    for (size_t i = 0; i < layers.size(); i++)
+    {
+        _steps.push_back({layers[i], nullptr, activations[i] == Relu, 0, activations[i] == Softmax,
+                          Tracer::intern(names[i]), (i % 2 == 0) ? 0 : _regionLengths[0]});
+    }
+    _tune(tuning);
+}
+
+// Resolves the kernel of every step by its tile, and the micro-batch size.
+void ExecutionPlan::_tune(const PlanTuning &tuning)
+{
+    if (tuning.microBatch < 0 || (!tuning.batchTiles.empty() && tuning.batchTiles.size() != _steps.size()))
+    {
+        std::cerr << ERROR_BAD_TUNING << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < _steps.size(); i++)
+    {
+        Step &step = _steps[i];
+        step.batchTile = tuning.batchTiles.empty() ? PackedWeights::BATCH_TILE : tuning.batchTiles[i];
+        step.kernel = PackedWeights::batchKernel(step.relu, step.batchTile);
+        if (step.kernel == nullptr)
+        {
+            std::cerr << ERROR_BAD_TUNING << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    _microBatch = (tuning.microBatch == 0) ? _deriveMicroBatch() : tuning.microBatch;
+}
+
+// Sizes micro-batches so the activations passed between steps fit in (a share of) L1, and the
+// inputs of a micro-batch, its activations and results next to every layer's weights fit in L2.
+// Rounded down to whole kernel tiles.
+int ExecutionPlan::_deriveMicroBatch() const
+{
+    size_t l1 = _cacheBytes(_SC_LEVEL1_DCACHE_SIZE, DEFAULT_L1_BYTES) / CACHE_SHARE;
+    size_t l2 = _cacheBytes(_SC_LEVEL2_CACHE_SIZE, DEFAULT_L2_BYTES) / CACHE_SHARE;
+
+    size_t activationBytes = (_regionLengths[0] + _regionLengths[1]) * sizeof(float);
+    size_t sampleBytes = activationBytes + (getInputLength() + getOutputLength()) * sizeof(float);
+    size_t weightBytes = 0;
+    for (const Step &step : _steps)
+    {
+        weightBytes += step.weights.getPackedLength() * sizeof(float);
+    }
+
+    size_t samples = l1 / activationBytes;
+    if (weightBytes < l2)
+    {
+        samples = std::min(samples, (l2 - weightBytes) / sampleBytes);
+    }
+    samples -= samples % PackedWeights::BATCH_TILE;
+    return std::max((int) samples, PackedWeights::BATCH_TILE);
+}
+
+/**
+ * Returns the amount of inputs of a sample.
+ *
+ * @return The amount of inputs of the first step.
+ */
+int ExecutionPlan::getInputLength() const
+{
+    return _steps.empty() ? 0 : _steps.front().weights.getCols();
+}
+
+/**
+ * Returns the amount of outputs of a sample.
+ *
+ * @return The amount of outputs of the last step.
+ */
+int ExecutionPlan::getOutputLength() const
+{
+    return _steps.empty() ? 0 : _steps.back().weights.getRows();
+}
+
+/**
+ * Returns the amount of steps (layers).
+ *
+ * @return The amount of steps.
+ */
+int ExecutionPlan::getSteps() const
+{
+    return (int) _steps.size();
+}
+
+/**
+ * Returns the packed weights of a step.
+ *
+ * @param step The index of the step.
+ * @return The packed weights of the step.
+ */
+const PackedWeights &ExecutionPlan::getLayer(int step) const
+{
+    return _steps[step].weights;
+}
+
+/**
+ * Returns the activation of a step.
+ *
+ * @param step The index of the step.
+ * @return The activation of the step.
+ */
+ActivationType ExecutionPlan::getActivation(int step) const
+{
+    return _steps[step].relu ? Relu : (_steps[step].softmax ? Softmax : Identity);
+}
+
+/**
+ * Returns the name of a step.
+ *
+ * @param step The index of the step.
+ * @return The name of the step.
+ */
+const char *ExecutionPlan::getName(int step) const
+{
+    return _steps[step].traceName;
+}
+
+/**
+ * Returns the amount of samples run through every step together.
+ *
+ * @return The micro-batch size.
+ */
+int ExecutionPlan::getMicroBatch() const
+{
+    return _microBatch;
+}
+
+/**
+ * Returns the kernel configuration of the plan (a tile for every step, the micro-batch size in use).
+ *
+ * @return The configuration.
+ */
+PlanTuning ExecutionPlan::getTuning() const
+{
+    PlanTuning tuning;
+    tuning.microBatch = _microBatch;
+    for (const Step &step : _steps)
+    {
+        tuning.batchTiles.push_back(step.batchTile);
+    }
+    return tuning;
+}
+
+/**
+ * Returns a copy of the plan which runs with another kernel configuration.
+ * Exits (code == 1) if the configuration doesn't fit the plan's steps.
+ *
+ * @param tuning The configuration.
+ * @return The retuned plan.
+ */
+ExecutionPlan ExecutionPlan::withTuning(const PlanTuning &tuning) const
+{
+    ExecutionPlan plan(*this);
+    plan._tune(tuning);
+    return plan;
+}
+
+/**
+ * Returns the amount of workspace floats a run over count samples needs.
+ *
+ * @param count The amount of samples.
+ * @return The workspace length.
+ */
+size_t ExecutionPlan::workspaceLength(int count) const
+{
+    return (_regionLengths[0] + _regionLengths[1]) * std::min(count, _microBatch) +
+           (size_t) getOutputLength() * count;
+}
+
+/**
+ * Runs every step over count samples.
+ * Given a profiler, step i is attributed to its section sections[i]. While tracing, every step of every
+ * micro-batch is an event (Relu included, being fused into the kernel) and so is every Softmax.
+ *
+ * @param input count samples of getInputLength() floats, one after the other.
+ * @param count The amount of samples.
+ * @param workspace At least workspaceLength(count) floats.
+ * @param profiler The profiler to report to (or nullptr).
+ * @param sections The profiler section of every step (ignored without a profiler).
+ * @return count results of getOutputLength() floats, one after the other (inside the workspace).
+ */
+const float *ExecutionPlan::run(const float input[], int count, float workspace[], PerfProfiler *profiler,
+                                const int sections[]) const
+{
+    // Results follow the activation regions, which are reused by every micro-batch.
+    float *results = workspace + (_regionLengths[0] + _regionLengths[1]) * std::min(count, _microBatch);
+    int inputLength = getInputLength(), outputLength = getOutputLength();
+    bool tracing = Tracer::enabled();
+    Tracer::Clock::time_point start;
+    for (int first = 0; first < count; first += _microBatch)
+    {
+        int samples = std::min(_microBatch, count - first);
+        const float *stepInput = input + (size_t) first * inputLength;
+        for (size_t i = 0; i < _steps.size(); i++)
+        {
+            const Step &step = _steps[i];
+            float *output = (i + 1 == _steps.size()) ? results + (size_t) first * outputLength
+                                                     : workspace + step.outputOffset * samples;
+            if (profiler != nullptr)
+            {
+                profiler->begin(sections[i]);
+            }
+            if (tracing)
+            {
+                start = Tracer::Clock::now();
+            }
+            (step.weights.*step.kernel)(stepInput, samples, output);
+            if (tracing)
+            {
+                Tracer::record(step.traceName, TRACE_LAYER, start, samples);
+            }
+            if (step.softmax)
+            {
+                TraceScope scope(SOFTMAX_EVENT, TRACE_ACTIVATION, samples);
+                _softmax(output, samples, step.weights.getRows());
+            }
+            if (profiler != nullptr)
+            {
+                profiler->end(sections[i]);
+            }
+            stepInput = output;
+        }
+    }
+    return results;
+}
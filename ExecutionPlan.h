@@ -0,0 +1,180 @@
+/**
+ * @file ExecutionPlan.h
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Header file for the ExecutionPlan class, the immutable form a MlpNetwork compiles itself into:
+ * the ordered fused layer steps, their kernels, shapes and workspace offsets.
+ */
+
+#ifndef EXECUTIONPLAN_H
+#define EXECUTIONPLAN_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "Activation.h"
+#include "PackedWeights.h"
+#include "PerfCounters.h"
+
+/**
+ * @struct PlanTuning
+ * @brief The kernel configuration of a plan, measured best for a CPU (see KernelTuner.h).
+ * @var microBatch - Samples per micro-batch (0 derives it from the cache sizes)
+ * @var batchTiles - The batch tile of every step (empty for PackedWeights::BATCH_TILE)
+ */
+typedef struct PlanTuning
+{
+    int microBatch = 0;
+    std::vector<int> batchTiles;
+} PlanTuning;
+
+/**
+ * The ExecutionPlan class- runs a chain of Dense layers as a fixed list of steps.
+ * Every step is a single fused op (W x + b and its activation) whose kernel is resolved when the
+ * plan is built: hidden Relu layers run the kernel with Relu fused into its stores, Softmax is
+ * applied per sample right after the last kernel and Identity steps (the inner factor of a
+ * factorized layer) only run the kernel. Steps ping-pong between two regions of a
+ * caller-owned workspace, at offsets fixed per sample when the plan is built.
+ * Large batches are run depth first: split into micro-batches which go through every step
+ * before the next one starts, sized so the activations passed between steps stay in L1
+ * and the micro-batch's inputs and the weights stay in L2.
+ * A plan never changes after construction, so a single plan is shared by any amount of threads,
+ * each with a workspace of its own.
+ */
+class ExecutionPlan
+{
+public:
+    // Constructors.
+    /**
+     * Constructs an empty plan (no steps).
+     */
+    ExecutionPlan();
+
+    /**
+     * Compiles the layers into a plan. Exits (code == 1) if a layer's inputs
+     * don't match the outputs of the one before it.
+     *
+     * @param layers The packed layers, in order.
+     * @param activations The activation of every layer.
+     * @param names The name of every layer (its events in a trace).
+     * @param tuning The kernel configuration, exits (code == 1) if it doesn't fit the layers.
+     */
+    ExecutionPlan(const std::vector<PackedWeights> &layers, const std::vector<ActivationType> &activations,
+                  const std::vector<std::string> &names, const PlanTuning &tuning = PlanTuning());
+
+    // Methods.
+    /**
+     * Returns the amount of inputs of a sample.
+     *
+     * @return The amount of inputs of the first step.
+     */
+    int getInputLength() const;
+
+    /**
+     * Returns the amount of outputs of a sample.
+     *
+     * @return The amount of outputs of the last step.
+     */
+    int getOutputLength() const;
+
+    /**
+     * Returns the amount of steps (layers).
+     *
+     * @return The amount of steps.
+     */
+    int getSteps() const;
+
+    /**
+     * Returns the packed weights of a step.
+     *
+     * @param step The index of the step.
+     * @return The packed weights of the step.
+     */
+    const PackedWeights &getLayer(int step) const;
+
+    /**
+     * Returns the activation of a step.
+     *
+     * @param step The index of the step.
+     * @return The activation of the step.
+     */
+    ActivationType getActivation(int step) const;
+
+    /**
+     * Returns the name of a step.
+     *
+     * @param step The index of the step.
+     * @return The name of the step.
+     */
+    const char *getName(int step) const;
+
+    /**
+     * Returns the amount of samples run through every step together.
+     *
+     * @return The micro-batch size.
+     */
+    int getMicroBatch() const;
+
+    /**
+     * Returns the kernel configuration of the plan (a tile for every step, the micro-batch size in use).
+     *
+     * @return The configuration.
+     */
+    PlanTuning getTuning() const;
+
+    /**
+     * Returns a copy of the plan which runs with another kernel configuration.
+     * Exits (code == 1) if the configuration doesn't fit the plan's steps.
+     *
+     * @param tuning The configuration.
+     * @return The retuned plan.
+     */
+    ExecutionPlan withTuning(const PlanTuning &tuning) const;
+
+    /**
+     * Returns the amount of workspace floats a run over count samples needs.
+     *
+     * @param count The amount of samples.
+     * @return The workspace length.
+     */
+    size_t workspaceLength(int count) const;
+
+    /**
+     * Runs every step over count samples.
+     * Given a profiler, step i is attributed to its section sections[i]. While tracing, every step of every
+     * micro-batch is an event (Relu included, being fused into the kernel) and so is every Softmax.
+     *
+     * @param input count samples of getInputLength() floats, one after the other.
+     * @param count The amount of samples.
+     * @param workspace At least workspaceLength(count) floats.
+     * @param profiler The profiler to report to (or nullptr).
+     * @param sections The profiler section of every step (ignored without a profiler).
+     * @return count results of getOutputLength() floats, one after the other (inside the workspace).
+     */
+    const float *run(const float input[], int count, float workspace[], PerfProfiler *profiler = nullptr,
+                     const int sections[] = nullptr) const;
+
+private:
+    struct Step
+    {
+        PackedWeights weights;
+        PackedWeights::Kernel kernel;
+        bool relu; // Fused into the kernel.
+        int batchTile; // Of the kernel.
+        bool softmax; // Applied per sample after the kernel.
+        const char *traceName; // Interned (see Tracer::intern()).
+        size_t outputOffset; // Per sample, multiplied by the amount of samples of a micro-batch.
+    };
+
+    std::vector<Step> _steps;
+    size_t _regionLengths[2]; // Widest output written into each workspace region.
+    int _microBatch;
+
+    int _deriveMicroBatch() const; // Sizes micro-batches by the cache sizes and the layer widths.
+
+    void _tune(const PlanTuning &tuning); // Resolves the kernels and the micro-batch size.
+};
+
+#endif //EXECUTIONPLAN_H
@@ -0,0 +1,179 @@
+/**
+ * @file IdxDataset.cpp
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Implementation file for the IdxDataset class which streams labeled images from IDX files
+ * (the MNIST distribution format).
+ */
+
+#define ERROR_BAD_IDX "Error: Invalid IDX file: "
+#define ERROR_IDX_MISMATCH "Error: IDX images and labels have different sample counts."
+#define ERROR_BAD_LABEL "Error: IDX label out of range: "
+
+#define IDX_UBYTE 0x08
+#define IDX_FLOAT 0x0D
+#define IMAGE_DIMS 3
+#define LABEL_DIMS 1
+#define MAX_PIXEL 255.0f
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include "IdxDataset.h"
+
+// Reads a big endian 32 bit integer, returns false on failure.
+static bool _readBigEndian(std::ifstream &is, uint32_t &value)
+{
+    unsigned char bytes[sizeof(uint32_t)];
+    if (!is.read((char *) bytes, sizeof(bytes)))
+    {
+        return false;
+    }
+    value = ((uint32_t) bytes[0] << 24) | ((uint32_t) bytes[1] << 16) |
+            ((uint32_t) bytes[2] << 8) | (uint32_t) bytes[3];
+    return true;
+}
+
+// Reads an IDX header (magic and dimensions), exits on failure.
+static unsigned char _readHeader(std::ifstream &is, const std::string &path, int dimsCount,
+                                 uint32_t dims[])
+{
+    uint32_t magic;
+    if (!is.is_open() || !_readBigEndian(is, magic) || (magic >> 16) != 0 ||
+        (magic & 0xFF) != (uint32_t) dimsCount)
+    {
+        std::cerr << ERROR_BAD_IDX << path << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < dimsCount; i++)
+    {
+        if (!_readBigEndian(is, dims[i]) || dims[i] == 0)
+        {
+            std::cerr << ERROR_BAD_IDX << path << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    return (unsigned char) ((magic >> 8) & 0xFF);
+}
+
+/**
+ * Opens a pair of IDX files and validates their headers.
+ * Exits (code == 1) upon failure.
+ *
+ * @param imagesPath Path of the images file (3 dimensions: count * rows * cols).
+ * @param labelsPath Path of the labels file (1 dimension: count).
+ * @param classes Amount of classes, every label must be below it.
+ */
+IdxDataset::IdxDataset(const std::string &imagesPath, const std::string &labelsPath, int classes)
+        : _images(imagesPath, std::ios::in | std::ios::binary),
+          _labels(labelsPath, std::ios::in | std::ios::binary), _classes(classes), _next(0)
+{
+    uint32_t imageDims[IMAGE_DIMS], labelDims[LABEL_DIMS];
+    unsigned char imageType = _readHeader(_images, imagesPath, IMAGE_DIMS, imageDims);
+    unsigned char labelType = _readHeader(_labels, labelsPath, LABEL_DIMS, labelDims);
+    if ((imageType != IDX_UBYTE && imageType != IDX_FLOAT) || labelType != IDX_UBYTE)
+    {
+        std::cerr << ERROR_BAD_IDX << ((labelType != IDX_UBYTE) ? labelsPath : imagesPath) << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (imageDims[0] != labelDims[0])
+    {
+        std::cerr << ERROR_IDX_MISMATCH << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    _size = (int) imageDims[0];
+    _imageLength = (int) (imageDims[1] * imageDims[2]);
+    _floatPixels = (imageType == IDX_FLOAT);
+    _imagesStart = _images.tellg();
+    _labelsStart = _labels.tellg();
+}
+
+/**
+ * Returns the amount of samples in the dataset.
+ *
+ * @return The amount of samples.
+ */
+int IdxDataset::size() const
+{
+    return _size;
+}
+
+/**
+ * Returns the amount of pixels in every image.
+ *
+ * @return The amount of pixels in an image.
+ */
+int IdxDataset::imageLength() const
+{
+    return _imageLength;
+}
+
+/**
+ * Reads up to count following samples (fewer at the end of the dataset).
+ * Exits (code == 1) if the files are truncated or a label is out of range.
+ *
+ * @param count The maximal amount of samples to read.
+ * @param pixels Output, imageLength() floats per read sample.
+ * @param labels Output, a label per read sample.
+ * @return The amount of samples read (0 at the end of the dataset).
+ */
+int IdxDataset::read(int count, std::vector<float> &pixels, std::vector<int> &labels)
+{
+    count = std::min(count, _size - _next);
+    size_t values = (size_t) count * _imageLength;
+    size_t pixelBytes = _floatPixels ? sizeof(float) : sizeof(unsigned char);
+    _buffer.resize(values * pixelBytes + count);
+    unsigned char *labelBytes = _buffer.data() + values * pixelBytes;
+    if (!_images.read((char *) _buffer.data(), values * pixelBytes) ||
+        !_labels.read((char *) labelBytes, count))
+    {
+        std::cerr << ERROR_BAD_IDX << "truncated" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    pixels.resize(values);
+    if (_floatPixels)
+    {
+        for (size_t i = 0; i < values; i++)
+        {
+            const unsigned char *bytes = &_buffer[i * sizeof(float)];
+            uint32_t word = ((uint32_t) bytes[0] << 24) | ((uint32_t) bytes[1] << 16) |
+                            ((uint32_t) bytes[2] << 8) | (uint32_t) bytes[3];
+            memcpy(&pixels[i], &word, sizeof(float)); // IDX values are big endian.
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < values; i++)
+        {
+            pixels[i] = (float) _buffer[i] / MAX_PIXEL;
+        }
+    }
+
+    labels.assign(labelBytes, labelBytes + count);
+    for (int i = 0; i < count; i++)
+    {
+        if (labels[i] >= _classes)
+        {
+            std::cerr << ERROR_BAD_LABEL << labels[i] << " (sample " << (_next + i) << ")" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    _next += count;
+    return count;
+}
+
+/**
+ * Moves back to the first sample.
+ */
+void IdxDataset::rewind()
+{
+    _images.clear();
+    _labels.clear();
+    _images.seekg(_imagesStart);
+    _labels.seekg(_labelsStart);
+    _next = 0;
+}
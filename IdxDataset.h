@@ -0,0 +1,77 @@
+/**
+ * @file IdxDataset.h
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Header file for the IdxDataset class which streams labeled images from IDX files
+ * (the MNIST distribution format).
+ */
+
+#ifndef IDXDATASET_H
+#define IDXDATASET_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * The IdxDataset class- streams images and labels from a pair of IDX files.
+ * Images may be stored as uint8 (scaled into [0, 1]) or as float32 (used as is),
+ * labels as uint8. Samples are read sequentially, a chunk at a time.
+ */
+class IdxDataset
+{
+public:
+    // Constructors.
+    /**
+     * Opens a pair of IDX files and validates their headers.
+     * Exits (code == 1) upon failure.
+     *
+     * @param imagesPath Path of the images file (3 dimensions: count * rows * cols).
+     * @param labelsPath Path of the labels file (1 dimension: count).
+     * @param classes Amount of classes, every label must be below it.
+     */
+    IdxDataset(const std::string &imagesPath, const std::string &labelsPath, int classes);
+
+    // Methods.
+    /**
+     * Returns the amount of samples in the dataset.
+     *
+     * @return The amount of samples.
+     */
+    int size() const;
+
+    /**
+     * Returns the amount of pixels in every image.
+     *
+     * @return The amount of pixels in an image.
+     */
+    int imageLength() const;
+
+    /**
+     * Reads up to count following samples (fewer at the end of the dataset).
+     * Exits (code == 1) if the files are truncated or a label is out of range.
+     *
+     * @param count The maximal amount of samples to read.
+     * @param pixels Output, imageLength() floats per read sample.
+     * @param labels Output, a label per read sample.
+     * @return The amount of samples read (0 at the end of the dataset).
+     */
+    int read(int count, std::vector<float> &pixels, std::vector<int> &labels);
+
+    /**
+     * Moves back to the first sample.
+     */
+    void rewind();
+
+private:
+    std::ifstream _images, _labels;
+    int _size, _imageLength, _classes, _next;
+    bool _floatPixels;
+    std::streampos _imagesStart, _labelsStart;
+    std::vector<unsigned char> _buffer;
+};
+
+#endif //IDXDATASET_H
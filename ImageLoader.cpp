@@ -0,0 +1,213 @@
+/**
+ * @file ImageLoader.cpp
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Implementation file for the image loaders which read raw float32, raw uint8, PGM and IDX images
+ * straight into the input buffer of the network.
+ */
+
+#define PGM_MAGIC "P5"
+#define PGM_MAX_VALUE 65535
+#define BYTE_MAX_VALUE 255
+#define IDX_UBYTE 0x08
+#define IDX_HEADER_BYTES 4
+#define MAX_HEADER_BYTES 256 // Room for a PGM header with comments.
+#define CONVERT_BLOCK 16 // Pixels per (vectorized) conversion step.
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include "ImageLoader.h"
+
+// Converts length bytes into floats divided by maxValue, a block of pixels at a time.
+static void _normalizeBytes(const unsigned char bytes[], int length, float maxValue, float pixels[])
+{
+    int i = 0;
+    for (; i + CONVERT_BLOCK <= length; i += CONVERT_BLOCK)
+    {
+        // Converted into a local block first: bytes may alias pixels, which would keep the
+        // compiler from vectorizing a direct loop.
+        float block[CONVERT_BLOCK];
+        for (int j = 0; j < CONVERT_BLOCK; j++)
+        {
+            block[j] = (float) bytes[i + j] / maxValue;
+        }
+        for (int j = 0; j < CONVERT_BLOCK; j++)
+        {
+            pixels[i + j] = block[j];
+        }
+    }
+    for (; i < length; i++)
+    {
+        pixels[i] = (float) bytes[i] / maxValue;
+    }
+}
+
+// Converts length big endian 16 bit values into floats divided by maxValue.
+static void _normalizeWords(const unsigned char bytes[], int length, float maxValue, float pixels[])
+{
+    for (int i = 0; i < length; i++)
+    {
+        pixels[i] = (float) ((bytes[2 * i] << 8) | bytes[2 * i + 1]) / maxValue;
+    }
+}
+
+// Reads a decimal header field of a PGM (skipping whitespace and comments), returns -1 on failure.
+static long _readPgmField(const unsigned char bytes[], size_t size, size_t &offset)
+{
+    while (offset < size && (isspace(bytes[offset]) || bytes[offset] == '#'))
+    {
+        if (bytes[offset] == '#')
+        {
+            while (offset < size && bytes[offset] != '\n')
+            {
+                offset++;
+            }
+        }
+        else
+        {
+            offset++;
+        }
+    }
+
+    long value = -1;
+    while (offset < size && isdigit(bytes[offset]) && value <= PGM_MAX_VALUE)
+    {
+        value = ((value < 0) ? 0 : value * 10) + (bytes[offset++] - '0');
+    }
+    return value;
+}
+
+// Converts the pixels of a binary PGM, returns false if it is malformed or has other dimensions.
+static bool _loadPgm(const unsigned char bytes[], size_t size, int rows, int cols, float pixels[])
+{
+    size_t offset = strlen(PGM_MAGIC);
+    long width = _readPgmField(bytes, size, offset);
+    long height = _readPgmField(bytes, size, offset);
+    long maxValue = _readPgmField(bytes, size, offset);
+    if (width != cols || height != rows || maxValue <= 0 || maxValue > PGM_MAX_VALUE ||
+        offset >= size || !isspace(bytes[offset]))
+    {
+        return false;
+    }
+    offset++; // A single whitespace separates the header from the pixels.
+
+    int length = rows * cols;
+    size_t pixelBytes = (maxValue > BYTE_MAX_VALUE) ? 2 : 1;
+    if (size - offset < length * pixelBytes)
+    {
+        return false;
+    }
+    if (pixelBytes == 1)
+    {
+        _normalizeBytes(bytes + offset, length, (float) maxValue, pixels);
+    }
+    else
+    {
+        _normalizeWords(bytes + offset, length, (float) maxValue, pixels);
+    }
+    return true;
+}
+
+// Converts the first image of an IDX uint8 file, returns false if it is malformed or has other dimensions.
+static bool _loadIdx(const unsigned char bytes[], size_t size, int rows, int cols, float pixels[])
+{
+    int dimsCount = bytes[3];
+    size_t offset = IDX_HEADER_BYTES + dimsCount * IDX_HEADER_BYTES;
+    if (size < offset)
+    {
+        return false;
+    }
+
+    uint32_t dims[3];
+    for (int i = 0; i < dimsCount; i++)
+    {
+        const unsigned char *field = bytes + IDX_HEADER_BYTES * (i + 1);
+        dims[i] = ((uint32_t) field[0] << 24) | ((uint32_t) field[1] << 16) |
+                  ((uint32_t) field[2] << 8) | (uint32_t) field[3];
+    }
+    const uint32_t *imageDims = dims + dimsCount - 2;
+    if ((dimsCount == 3 && dims[0] == 0) || imageDims[0] != (uint32_t) rows || imageDims[1] != (uint32_t) cols ||
+        size - offset < (size_t) rows * cols)
+    {
+        return false;
+    }
+    _normalizeBytes(bytes + offset, rows * cols, (float) BYTE_MAX_VALUE, pixels);
+    return true;
+}
+
+/**
+ * Reads a rows * cols image into pixels, row after row, in a single pass.
+ * The format is told by the file's size and header. Integer pixels are normalized into [0, 1]
+ * (divided by 255 or by the PGM's maximal value) while they are converted.
+ *
+ * @param path The image file.
+ * @param rows The expected amount of rows.
+ * @param cols The expected amount of columns.
+ * @param pixels Output, rows * cols floats (the network's input buffer).
+ * @return The format of the image, UnknownImage (pixels undefined) if it is unreadable
+ *         or has other dimensions.
+ */
+ImageFormat loadImage(const std::string &path, int rows, int cols, float pixels[])
+{
+    std::ifstream is(path, std::ios::in | std::ios::binary | std::ios::ate);
+    if (!is.is_open() || rows <= 0 || cols <= 0)
+    {
+        return UnknownImage;
+    }
+
+    size_t length = (size_t) rows * cols;
+    size_t fileSize = (size_t) is.tellg();
+    is.seekg(0, std::ios_base::beg);
+    if (fileSize == length * sizeof(float))
+    {
+        // Already the network's input, read in place.
+        return is.read((char *) pixels, (std::streamsize) fileSize) ? FloatImage : UnknownImage;
+    }
+
+    // Every other format is at most 2 bytes per pixel after its header, later images of an IDX file aren't read.
+    static thread_local std::vector<unsigned char> buffer;
+    size_t size = std::min(fileSize, 2 * length + MAX_HEADER_BYTES);
+    buffer.resize(size);
+    if (!is.read((char *) buffer.data(), (std::streamsize) size))
+    {
+        return UnknownImage;
+    }
+
+    const unsigned char *bytes = buffer.data();
+    if (size >= strlen(PGM_MAGIC) && memcmp(bytes, PGM_MAGIC, strlen(PGM_MAGIC)) == 0 &&
+        _loadPgm(bytes, size, rows, cols, pixels))
+    {
+        return PgmImage;
+    }
+    if (size > IDX_HEADER_BYTES && bytes[0] == 0 && bytes[1] == 0 && bytes[2] == IDX_UBYTE &&
+        (bytes[3] == 2 || bytes[3] == 3) && _loadIdx(bytes, size, rows, cols, pixels))
+    {
+        return IdxImage;
+    }
+    if (fileSize == length)
+    {
+        _normalizeBytes(bytes, (int) length, (float) BYTE_MAX_VALUE, pixels);
+        return ByteImage;
+    }
+    return UnknownImage;
+}
+
+/**
+ * Converts length uint8 pixels into floats normalized into [0, 1].
+ * The bytes may be the last length bytes of the pixels themselves (converted in place).
+ *
+ * @param bytes The uint8 pixels.
+ * @param length The amount of pixels.
+ * @param pixels Output, length floats.
+ */
+void normalizePixels(const unsigned char bytes[], int length, float pixels[])
+{
+    // Going forward, a block is written (4 bytes per pixel) only below the bytes not read yet.
+    _normalizeBytes(bytes, length, (float) BYTE_MAX_VALUE, pixels);
+}
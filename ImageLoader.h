@@ -0,0 +1,53 @@
+/**
+ * @file ImageLoader.h
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Header file for the image loaders which read raw float32, raw uint8, PGM and IDX images
+ * straight into the input buffer of the network.
+ */
+
+#ifndef IMAGELOADER_H
+#define IMAGELOADER_H
+
+#include <string>
+
+/**
+ * @enum ImageFormat
+ * @brief Indicator of the format of an image file.
+ */
+enum ImageFormat
+{
+    UnknownImage,
+    FloatImage, // rows * cols raw float32 (native byte order), used as is.
+    ByteImage, // rows * cols raw uint8.
+    PgmImage, // Binary PGM (P5), 8 or 16 bit.
+    IdxImage // IDX uint8 with 2 (rows, cols) or 3 (count, rows, cols) dimensions, the first image.
+};
+
+/**
+ * Reads a rows * cols image into pixels, row after row, in a single pass.
+ * The format is told by the file's size and header. Integer pixels are normalized into [0, 1]
+ * (divided by 255 or by the PGM's maximal value) while they are converted.
+ *
+ * @param path The image file.
+ * @param rows The expected amount of rows.
+ * @param cols The expected amount of columns.
+ * @param pixels Output, rows * cols floats (the network's input buffer).
+ * @return The format of the image, UnknownImage (pixels undefined) if it is unreadable
+ *         or has other dimensions.
+ */
+ImageFormat loadImage(const std::string &path, int rows, int cols, float pixels[]);
+
+/**
+ * Converts length uint8 pixels into floats normalized into [0, 1].
+ * The bytes may be the last length bytes of the pixels themselves (converted in place).
+ *
+ * @param bytes The uint8 pixels.
+ * @param length The amount of pixels.
+ * @param pixels Output, length floats.
+ */
+void normalizePixels(const unsigned char bytes[], int length, float pixels[]);
+
+#endif //IMAGELOADER_H
@@ -0,0 +1,357 @@
+/**
+ * @file InferenceServer.cpp
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Implementation file for the InferenceServer class which serves a MlpNetwork over a socket
+ * and batches concurrent requests together.
+ */
+
+#define ERROR_BAD_BATCH_SIZE "Error: Maximal batch size must be positive."
+#define SERVING "Serving requests (Ctrl+C to stop).."
+
+#define POLL_TIMEOUT_MS 100
+#define MAX_CONNECTION_BACKLOG 1024 // Requests of a connection queued or answered but not written yet.
+#define DRAIN_TIMEOUT_MS 1000 // How long a stopping server waits for its clients to read their last responses.
+
+// Trace names.
+#define BATCHER_THREAD "batcher"
+#define READER_THREAD "connection "
+#define WRITER_THREAD "writer "
+#define COLLECT_EVENT "collect batch"
+#define BATCH_EVENT "run batch"
+#define RESPOND_EVENT "respond"
+#define CACHED_EVENT "respond from cache"
+
+#include <csignal>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "InferenceServer.h"
+#include "MemoryPlacement.h"
+#include "Tracer.h"
+
+static volatile sig_atomic_t stopRequested = 0;
+
+// Signal handler which asks serve() to return.
+static void _requestStop(int)
+{
+    stopRequested = 1;
+}
+
+/**
+ * A client socket shared by its reader, its writer and the batching thread.
+ * Responses are handed to the writer through an output queue. Closed once the last of them lets go of it.
+ */
+struct InferenceServer::Connection
+{
+    int fd;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<ResponseFrame> responses; // Answered, not written yet.
+    int outstanding; // Queued for a batch, not answered yet.
+    bool reading; // Cleared once the reader exits, the writer exits once everything is written.
+    bool broken; // A write failed, responses are dropped.
+    bool stopped; // Cut off by a stopping server.
+
+    explicit Connection(int socket) : fd(socket), outstanding(0), reading(true), broken(false), stopped(false)
+    {}
+
+    ~Connection()
+    {
+        close(fd);
+    }
+
+    // Hands a response to the writer (of a request queued for a batch, if queued).
+    void respond(const ResponseFrame &response, bool queued)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        outstanding -= queued ? 1 : 0;
+        if (!broken)
+        {
+            responses.push_back(response);
+        }
+        changed.notify_all();
+    }
+
+    // Returns once there is room for another request (see MAX_CONNECTION_BACKLOG),
+    // false if the connection was cut off or broke instead.
+    bool waitForRoom()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this] {
+            return stopped || broken || outstanding + responses.size() < MAX_CONNECTION_BACKLOG;
+        });
+        return !stopped && !broken;
+    }
+
+    // Cuts the connection off: a blocked write fails (so the rest of the responses are dropped)
+    // and a reader waiting for room wakes up.
+    void stop()
+    {
+        shutdown(fd, SHUT_RDWR);
+        std::lock_guard<std::mutex> lock(mutex);
+        stopped = true;
+        changed.notify_all();
+    }
+};
+
+/**
+ * Inits a server for the models of the given registry.
+ *
+ * @param models The registry whose current model is served (must outlive the server).
+ * @param options The batching and caching options.
+ */
+InferenceServer::InferenceServer(const ModelRegistry &models, const ServerOptions &options)
+        : _models(models), _maxBatchSize(options.maxBatchSize), _maxQueueDelay(options.maxQueueDelayUs),
+          _arena(MatrixArena::DEFAULT_CHUNK_BYTES, MemoryPlacement::currentNode()), _stopping(false),
+          _requests(0), _batches(0), _largestBatch(0), _totalWaitUs(0)
+{
+    if (options.maxBatchSize <= 0)
+    {
+        std::cerr << ERROR_BAD_BATCH_SIZE << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (options.cacheEntries > 0)
+    {
+        _cache.reset(new ResultCache(options.cacheEntries));
+    }
+}
+
+/**
+ * Serves clients of the given listening socket until SIGINT or SIGTERM arrives.
+ * Then it answers the requests read so far, but cuts off clients which don't read them within a second.
+ *
+ * @param listenFd A listening socket (see openListener()).
+ */
+void InferenceServer::serve(int listenFd)
+{
+    struct sigaction action = {};
+    action.sa_handler = _requestStop;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    std::thread batcher(&InferenceServer::_runBatches, this);
+    std::cerr << SERVING << std::endl;
+
+    pollfd listener = {listenFd, POLLIN, 0};
+    while (!stopRequested)
+    {
+        if (poll(&listener, 1, POLL_TIMEOUT_MS) <= 0)
+        {
+            continue;
+        }
+
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0)
+        {
+            continue;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); // Fails harmlessly on Unix sockets.
+
+        std::shared_ptr<Connection> connection = std::make_shared<Connection>(fd);
+        std::lock_guard<std::mutex> lock(_mutex);
+        _readers.insert(connection);
+        std::thread(&InferenceServer::_readRequests, this, connection).detach();
+    }
+
+    // Stop reading, let the batcher drain the queue and wait for everyone. Clients which don't read
+    // their responses within DRAIN_TIMEOUT_MS are cut off, so they can't hold the server up.
+    std::unique_lock<std::mutex> lock(_mutex);
+    for (const std::shared_ptr<Connection> &connection : _readers)
+    {
+        shutdown(connection->fd, SHUT_RD);
+    }
+    if (!_readerExited.wait_for(lock, std::chrono::milliseconds(DRAIN_TIMEOUT_MS),
+                                [this] { return _readers.empty(); }))
+    {
+        for (const std::shared_ptr<Connection> &connection : _readers)
+        {
+            connection->stop();
+        }
+        _readerExited.wait(lock, [this] { return _readers.empty(); });
+    }
+    _stopping = true;
+    _queueChanged.notify_all();
+    lock.unlock();
+    batcher.join();
+}
+
+/**
+ * Prints the amount of served requests and batches (and cache and cascade counters).
+ *
+ * @param os The output stream.
+ */
+void InferenceServer::printStats(std::ostream &os) const
+{
+    os << "Requests: " << _requests << ", batches: " << _batches;
+    if (_batches > 0)
+    {
+        os << ", mean batch size: " << (double) _requests / _batches
+           << ", largest batch: " << _largestBatch
+           << ", mean queue wait: " << _totalWaitUs / _requests << "us";
+    }
+    os << std::endl;
+    if (_cache)
+    {
+        _cache->printStats(os);
+    }
+    std::shared_ptr<const Model> model = _models.acquire();
+    if (model->getCascade() != nullptr)
+    {
+        model->getCascade()->printStats(os);
+    }
+}
+
+// A connection's reader thread, queues every request read from the connection
+// (or answers it right away from the cache).
+void InferenceServer::_readRequests(std::shared_ptr<Connection> connection)
+{
+    Tracer::nameThread(READER_THREAD + std::to_string(connection->fd));
+    std::thread writer(&InferenceServer::_writeResponses, connection);
+    Pending request;
+    request.connection = connection;
+    while (true)
+    {
+        // A client which doesn't read its responses isn't read from either.
+        if (!connection->waitForRoom() || !readFully(connection->fd, &request.id, sizeof(RequestHeader)) ||
+            !readFully(connection->fd, request.image, sizeof(request.image)))
+        {
+            break;
+        }
+
+        Digit cached;
+        if (_cache)
+        {
+            // Results of replaced models are never looked up again (and age out).
+            request.key = ResultCache::hash(request.image, IMAGE_LENGTH) ^ (uint64_t) _models.getVersion();
+            if (_cache->lookup(request.key, cached))
+            {
+                TraceScope scope(CACHED_EVENT, TRACE_OUTPUT, 1);
+                connection->respond({request.id, cached.value, cached.probability}, false);
+                continue;
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(connection->mutex);
+            connection->outstanding++;
+        }
+        request.arrived = Clock::now();
+        std::lock_guard<std::mutex> lock(_mutex);
+        _queue.push_back(request);
+        _queueChanged.notify_one();
+    }
+
+    // The writer still answers every request queued so far.
+    request.connection.reset();
+    {
+        std::lock_guard<std::mutex> lock(connection->mutex);
+        connection->reading = false;
+        connection->changed.notify_all();
+    }
+    writer.join();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _readers.erase(connection);
+    _readerExited.notify_all();
+}
+
+// A connection's writer thread, writes the responses handed to it (all that are pending at once)
+// until the reader exited and every queued request was answered.
+void InferenceServer::_writeResponses(std::shared_ptr<Connection> connection)
+{
+    Tracer::nameThread(WRITER_THREAD + std::to_string(connection->fd));
+    std::vector<ResponseFrame> writing;
+    std::unique_lock<std::mutex> lock(connection->mutex);
+    while (true)
+    {
+        connection->changed.wait(lock, [&connection] {
+            return !connection->responses.empty() || (!connection->reading && connection->outstanding == 0);
+        });
+        if (connection->responses.empty())
+        {
+            return;
+        }
+
+        writing.swap(connection->responses);
+        lock.unlock();
+        bool written = writeFully(connection->fd, writing.data(), writing.size() * sizeof(ResponseFrame));
+        writing.clear();
+        lock.lock();
+        connection->broken = connection->broken || !written;
+        connection->changed.notify_all(); // There may be room for the reader now.
+    }
+}
+
+// The batching thread, waits for a full batch or for the oldest request's deadline.
+void InferenceServer::_runBatches()
+{
+    Tracer::nameThread(BATCHER_THREAD);
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true)
+    {
+        _queueChanged.wait(lock, [this] { return !_queue.empty() || _stopping; });
+        if (_queue.empty())
+        {
+            return;
+        }
+
+        // From the first request of the batch until the batch is full or due.
+        Tracer::Clock::time_point collecting = Tracer::Clock::now();
+        Clock::time_point deadline = _queue.front().arrived + _maxQueueDelay;
+        _queueChanged.wait_until(lock, deadline, [this] {
+            return (int) _queue.size() >= _maxBatchSize || _stopping;
+        });
+
+        size_t count = std::min(_queue.size(), (size_t) _maxBatchSize);
+        std::deque<Pending> batch(std::make_move_iterator(_queue.begin()),
+                                  std::make_move_iterator(_queue.begin() + count));
+        _queue.erase(_queue.begin(), _queue.begin() + count);
+        Tracer::record(COLLECT_EVENT, TRACE_BATCH, collecting, (int) count);
+
+        lock.unlock();
+        _runBatch(batch);
+        lock.lock();
+    }
+}
+
+// Runs a single batch through the network and answers every request in it.
+void InferenceServer::_runBatch(std::deque<Pending> &batch)
+{
+    ArenaScope scope(_arena); // Every Matrix of the batch is released together.
+    int count = (int) batch.size();
+    TraceScope trace(BATCH_EVENT, TRACE_BATCH, count);
+    Clock::time_point start = Clock::now();
+    Matrix input(count, IMAGE_LENGTH);
+    for (int i = 0; i < count; i++)
+    {
+        memcpy(input.data() + (size_t) i * IMAGE_LENGTH, batch[i].image, sizeof(batch[i].image));
+        _totalWaitUs += std::chrono::duration<double, std::micro>(start - batch[i].arrived).count();
+    }
+
+    std::vector<Digit> results(count);
+    std::shared_ptr<const Model> model = _models.acquire(); // Kept alive until the batch is answered.
+    model->predictBatch(input, results.data());
+
+    TraceScope respond(RESPOND_EVENT, TRACE_OUTPUT, count);
+    for (int i = 0; i < count; i++)
+    {
+        if (_cache)
+        {
+            _cache->insert(batch[i].key, results[i]);
+        }
+        batch[i].connection->respond({batch[i].id, results[i].value, results[i].probability}, true);
+    }
+
+    _requests += count;
+    _batches++;
+    _largestBatch = std::max(_largestBatch, (long) count);
+}
@@ -0,0 +1,123 @@
+/**
+ * @file InferenceServer.h
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Header file for the InferenceServer class which serves a MlpNetwork over a socket
+ * and batches concurrent requests together.
+ */
+
+#ifndef INFERENCESERVER_H
+#define INFERENCESERVER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <set>
+
+#include "MatrixAllocator.h"
+#include "ModelRegistry.h"
+#include "Protocol.h"
+#include "ResultCache.h"
+
+#define DEFAULT_MAX_BATCH 32
+#define DEFAULT_MAX_DELAY_US 500
+
+/**
+ * @struct ServerOptions
+ * @brief Tuning knobs of an InferenceServer.
+ * @var maxBatchSize - The maximal amount of requests in a single batch
+ * @var maxQueueDelayUs - The maximal time (microseconds) a request waits for its batch to fill
+ * @var cacheEntries - The capacity of the result cache (0 disables caching)
+ */
+typedef struct ServerOptions
+{
+    int maxBatchSize = DEFAULT_MAX_BATCH;
+    long maxQueueDelayUs = DEFAULT_MAX_DELAY_US;
+    size_t cacheEntries = 0;
+} ServerOptions;
+
+/**
+ * The InferenceServer class- serves the current model of a ModelRegistry over a socket (see Protocol.h).
+ * Every connection gets a reader thread which queues its requests, and a single batching
+ * thread runs up to maxBatchSize queued requests at a time through the model it acquires per batch,
+ * so a reloaded model takes over from the next batch on.
+ * A batch is started once it is full or once its oldest request waited maxQueueDelay.
+ * The batching thread never writes to a socket: it hands every response to the writer thread of its
+ * connection, so a client which stops reading only stalls itself (its reader stops taking requests
+ * once too many of its responses are pending).
+ * With a result cache, repeated images are answered by the reader without being queued
+ * (results are cached per model version).
+ */
+class InferenceServer
+{
+public:
+    // Constructors.
+    /**
+     * Inits a server for the models of the given registry.
+     *
+     * @param models The registry whose current model is served (must outlive the server).
+     * @param options The batching and caching options.
+     */
+    InferenceServer(const ModelRegistry &models, const ServerOptions &options);
+
+    InferenceServer(const InferenceServer &other) = delete;
+
+    InferenceServer &operator=(const InferenceServer &other) = delete;
+
+    // Methods.
+    /**
+     * Serves clients of the given listening socket until SIGINT or SIGTERM arrives.
+     * Then it answers the requests read so far, but cuts off clients which don't read them within a second.
+     *
+     * @param listenFd A listening socket (see openListener()).
+     */
+    void serve(int listenFd);
+
+    /**
+     * Prints the amount of served requests and batches (and cache and cascade counters).
+     *
+     * @param os The output stream.
+     */
+    void printStats(std::ostream &os) const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Connection; // A client socket shared by its reader, its writer and the batching thread.
+
+    struct Pending
+    {
+        std::shared_ptr<Connection> connection;
+        uint32_t id;
+        uint64_t key;
+        Clock::time_point arrived;
+        float image[IMAGE_LENGTH];
+    };
+
+    const ModelRegistry &_models;
+    const int _maxBatchSize;
+    const std::chrono::microseconds _maxQueueDelay;
+    std::unique_ptr<ResultCache> _cache;
+    MatrixArena _arena; // Temporaries of a batch, used by the batching thread only (on the server's node).
+
+    std::mutex _mutex;
+    std::condition_variable _queueChanged, _readerExited;
+    std::deque<Pending> _queue;
+    std::set<std::shared_ptr<Connection>> _readers; // Of the connections whose reader is running.
+    bool _stopping;
+
+    long _requests, _batches, _largestBatch;
+    double _totalWaitUs;
+
+    void _readRequests(std::shared_ptr<Connection> connection); // A connection's reader thread.
+    static void _writeResponses(std::shared_ptr<Connection> connection); // A connection's writer thread.
+    void _runBatches(); // The batching thread.
+    void _runBatch(std::deque<Pending> &batch); // Runs and answers a single batch.
+};
+
+#endif //INFERENCESERVER_H
@@ -0,0 +1,287 @@
+/**
+ * @file KernelTuner.cpp
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Implementation file for the KernelTuner class which measures the fastest kernel configuration of
+ * an execution plan on the running CPU, and keeps the winners in a tuning file.
+ */
+
+#define ERROR_TUNING_WRITE "Error: failed to write the tuning file: "
+#define TUNING_HEADER "# mlpnetwork kernel tuning: cpu model, shape (inputs x outputs per step), micro-batch, tiles"
+#define CPU_INFO "/proc/cpuinfo"
+#define CPU_MODEL_KEY "model name"
+#define UNKNOWN_CPU "unknown"
+#define TEMPORARY_SUFFIX ".tmp"
+#define COMMENT '#'
+#define FIELD_SEPARATOR '\t'
+#define LIST_SEPARATOR ','
+
+#define TUNE_BATCH 256 // Images per run when timing micro-batch sizes.
+#define TUNE_ROUNDS 5 // Timings are the fastest of the rounds.
+#define TUNE_ROUND_NS 10000000.0 // Runs are repeated for at least this long per round.
+#define TUNE_SEED 7
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <vector>
+#include "KernelTuner.h"
+#include "Matrix.h"
+
+static const int TILE_CANDIDATES[] = {1, 2, 4, PackedWeights::MAX_BATCH_TILE};
+static const int MICRO_BATCH_CANDIDATES[] = {4, 8, 16, 32, 64, 128, 256};
+
+// Returns the time (nanoseconds) of a single run, the fastest of TUNE_ROUNDS rounds.
+// A round repeats the run for about TUNE_ROUND_NS (the amount of repeats is set by a first round).
+template<typename Run>
+static double _fastestNs(Run run)
+{
+    typedef std::chrono::steady_clock Clock;
+    run(); // Warms the caches up.
+    int repeats = 0;
+    Clock::time_point start = Clock::now();
+    double elapsed;
+    do
+    {
+        run();
+        repeats++;
+        elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    } while (elapsed < TUNE_ROUND_NS);
+
+    double fastest = elapsed / repeats;
+    for (int round = 1; round < TUNE_ROUNDS; round++)
+    {
+        start = Clock::now();
+        for (int i = 0; i < repeats; i++)
+        {
+            run();
+        }
+        fastest = std::min(fastest, std::chrono::duration<double, std::nano>(Clock::now() - start).count() / repeats);
+    }
+    return fastest;
+}
+
+// Fills an array with uniform values in [0, 1), as images and Relu activations are.
+static void _fillRandom(float values[], size_t length)
+{
+    std::mt19937 generator(TUNE_SEED);
+    std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+    for (size_t i = 0; i < length; i++)
+    {
+        values[i] = distribution(generator);
+    }
+}
+
+// Splits a line into its fields.
+static std::vector<std::string> _split(const std::string &line, char separator)
+{
+    std::vector<std::string> fields;
+    std::istringstream stream(line);
+    std::string field;
+    while (std::getline(stream, field, separator))
+    {
+        fields.push_back(field);
+    }
+    return fields;
+}
+
+/**
+ * Returns the model name of the running CPU.
+ *
+ * @return The "model name" of /proc/cpuinfo, "unknown" if there is none.
+ */
+std::string KernelTuner::cpuModel()
+{
+    std::ifstream file(CPU_INFO);
+    std::string line;
+    while (std::getline(file, line))
+    {
+        size_t colon = line.find(':');
+        if (line.rfind(CPU_MODEL_KEY, 0) == 0 && colon != std::string::npos)
+        {
+            size_t first = line.find_first_not_of(' ', colon + 1);
+            return (first == std::string::npos) ? UNKNOWN_CPU : line.substr(first);
+        }
+    }
+    return UNKNOWN_CPU;
+}
+
+/**
+ * Returns the shape of a plan: the inputs x outputs of every step, comma separated.
+ *
+ * @param plan The plan.
+ * @return The shape.
+ */
+std::string KernelTuner::shapeKey(const ExecutionPlan &plan)
+{
+    std::string shape;
+    for (int i = 0; i < plan.getSteps(); i++)
+    {
+        const PackedWeights &layer = plan.getLayer(i);
+        shape += (i == 0 ? "" : std::string(1, LIST_SEPARATOR)) + std::to_string(layer.getCols()) + "x" +
+                 std::to_string(layer.getRows());
+    }
+    return shape;
+}
+
+/**
+ * Measures every candidate configuration of a plan and returns the fastest, reporting the
+ * timings as it goes.
+ *
+ * @param plan The plan.
+ * @param os The output stream of the report.
+ * @return The fastest configuration.
+ */
+PlanTuning KernelTuner::tune(const ExecutionPlan &plan, std::ostream &os)
+{
+    PlanTuning tuning;
+    os << "Tuning " << shapeKey(plan) << " on " << cpuModel() << std::endl;
+
+    // The tile of every step, on its own, over a micro-batch of the untuned plan.
+    int count = plan.getMicroBatch();
+    for (int i = 0; i < plan.getSteps(); i++)
+    {
+        const PackedWeights &layer = plan.getLayer(i);
+        Matrix input(count, layer.getCols()), output(count, layer.getRows());
+        _fillRandom(input.data(), (size_t) count * layer.getCols());
+
+        os << "step " << i + 1 << " (" << layer.getCols() << "x" << layer.getRows() << ")\t";
+        double fastest = 0.0;
+        int bestTile = PackedWeights::BATCH_TILE;
+        for (int tile : TILE_CANDIDATES)
+        {
+            PackedWeights::Kernel kernel = PackedWeights::batchKernel(plan.getActivation(i) == Relu, tile);
+            double ns = _fastestNs([&] { (layer.*kernel)(input.data(), count, output.data()); });
+            os << "tile " << tile << ": " << ns / count << "ns per image\t";
+            if (fastest == 0.0 || ns < fastest)
+            {
+                fastest = ns;
+                bestTile = tile;
+            }
+        }
+        os << "-> tile " << bestTile << std::endl;
+        tuning.batchTiles.push_back(bestTile);
+    }
+
+    // The micro-batch size, running the whole plan with the chosen tiles.
+    std::vector<int> microBatches(std::begin(MICRO_BATCH_CANDIDATES), std::end(MICRO_BATCH_CANDIDATES));
+    microBatches.push_back(count);
+    std::sort(microBatches.begin(), microBatches.end());
+    microBatches.erase(std::unique(microBatches.begin(), microBatches.end()), microBatches.end());
+
+    Matrix images(TUNE_BATCH, plan.getInputLength());
+    _fillRandom(images.data(), (size_t) TUNE_BATCH * plan.getInputLength());
+    double fastest = 0.0;
+    for (int microBatch : microBatches)
+    {
+        PlanTuning candidate = tuning;
+        candidate.microBatch = microBatch;
+        ExecutionPlan tuned = plan.withTuning(candidate);
+        Matrix workspace(1, (int) tuned.workspaceLength(TUNE_BATCH));
+        double ns = _fastestNs([&] { tuned.run(images.data(), TUNE_BATCH, workspace.data()); });
+        os << "micro-batch " << microBatch << ": " << ns / TUNE_BATCH << "ns per image" << std::endl;
+        if (fastest == 0.0 || ns < fastest)
+        {
+            fastest = ns;
+            tuning.microBatch = microBatch;
+        }
+    }
+    os << "-> micro-batch " << tuning.microBatch << std::endl;
+    return tuning;
+}
+
+/**
+ * Looks up the configuration of a plan on the running CPU in a tuning file.
+ *
+ * @param path The tuning file.
+ * @param plan The plan.
+ * @param tuning Output, the configuration (untouched if there is none).
+ * @return false if the file is missing or has no usable entry for this CPU and shape.
+ */
+bool KernelTuner::load(const std::string &path, const ExecutionPlan &plan, PlanTuning &tuning)
+{
+    std::ifstream file(path);
+    std::string cpu = cpuModel(), shape = shapeKey(plan), line;
+    while (std::getline(file, line))
+    {
+        std::vector<std::string> fields = _split(line, FIELD_SEPARATOR);
+        if (line.empty() || line[0] == COMMENT || fields.size() != 4 || fields[0] != cpu || fields[1] != shape)
+        {
+            continue;
+        }
+
+        // Entries are written by store(), anything else (a hand edit gone wrong) is ignored.
+        PlanTuning entry;
+        entry.microBatch = std::atoi(fields[2].c_str());
+        for (const std::string &tile : _split(fields[3], LIST_SEPARATOR))
+        {
+            entry.batchTiles.push_back(std::atoi(tile.c_str()));
+        }
+        bool usable = entry.microBatch > 0 && (int) entry.batchTiles.size() == plan.getSteps();
+        for (int i = 0; usable && i < plan.getSteps(); i++)
+        {
+            usable = PackedWeights::batchKernel(plan.getActivation(i) == Relu, entry.batchTiles[i]) != nullptr;
+        }
+        if (usable)
+        {
+            tuning = entry;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Stores the configuration of a plan on the running CPU in a tuning file, replacing a previous
+ * entry of the same CPU and shape and keeping every other entry.
+ *
+ * @param path The tuning file.
+ * @param plan The plan.
+ * @param tuning The configuration.
+ * @return false if the file couldn't be written.
+ */
+bool KernelTuner::store(const std::string &path, const ExecutionPlan &plan, const PlanTuning &tuning)
+{
+    std::string cpu = cpuModel(), shape = shapeKey(plan), line;
+    std::vector<std::string> lines;
+    std::ifstream existing(path);
+    while (std::getline(existing, line))
+    {
+        std::vector<std::string> fields = _split(line, FIELD_SEPARATOR);
+        if (line != TUNING_HEADER && !(fields.size() >= 2 && fields[0] == cpu && fields[1] == shape))
+        {
+            lines.push_back(line);
+        }
+    }
+    existing.close();
+
+    std::ostringstream entry;
+    entry << cpu << FIELD_SEPARATOR << shape << FIELD_SEPARATOR << tuning.microBatch << FIELD_SEPARATOR;
+    for (size_t i = 0; i < tuning.batchTiles.size(); i++)
+    {
+        entry << (i == 0 ? "" : std::string(1, LIST_SEPARATOR)) << tuning.batchTiles[i];
+    }
+    lines.push_back(entry.str());
+
+    // Through a temporary file, so a process starting meanwhile never reads a partial file.
+    std::string temporary = path + TEMPORARY_SUFFIX;
+    std::ofstream file(temporary, std::ios::out | std::ios::trunc);
+    file << TUNING_HEADER << std::endl;
+    for (const std::string &kept : lines)
+    {
+        file << kept << std::endl;
+    }
+    file.close();
+    if (!file || std::rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        std::cerr << ERROR_TUNING_WRITE << path << std::endl;
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,78 @@
+/**
+ * @file KernelTuner.h
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Header file for the KernelTuner class which measures the fastest kernel configuration of
+ * an execution plan on the running CPU, and keeps the winners in a tuning file.
+ */
+
+#ifndef KERNELTUNER_H
+#define KERNELTUNER_H
+
+#include <iostream>
+#include <string>
+#include "ExecutionPlan.h"
+
+/**
+ * The KernelTuner class- benchmarks the candidate configurations of a plan (the batch tile of every
+ * step, then the micro-batch size) on the actual shapes of its layers, and picks the fastest.
+ * Winners are kept in a tuning file, a line per CPU model and model shape:
+ *     cpu model <TAB> shape <TAB> micro-batch <TAB> tile,tile,..
+ * where the shape lists the inputs x outputs of every step ("784x128,128x64,64x20,20x10"), so the
+ * file is shared by a whole fleet and every machine (and factorized model) finds its own entry.
+ * Every candidate computes the very same results, tuning only changes speed.
+ */
+class KernelTuner
+{
+public:
+    // Methods.
+    /**
+     * Returns the model name of the running CPU.
+     *
+     * @return The "model name" of /proc/cpuinfo, "unknown" if there is none.
+     */
+    static std::string cpuModel();
+
+    /**
+     * Returns the shape of a plan: the inputs x outputs of every step, comma separated.
+     *
+     * @param plan The plan.
+     * @return The shape.
+     */
+    static std::string shapeKey(const ExecutionPlan &plan);
+
+    /**
+     * Measures every candidate configuration of a plan and returns the fastest, reporting the
+     * timings as it goes.
+     *
+     * @param plan The plan.
+     * @param os The output stream of the report.
+     * @return The fastest configuration.
+     */
+    static PlanTuning tune(const ExecutionPlan &plan, std::ostream &os);
+
+    /**
+     * Looks up the configuration of a plan on the running CPU in a tuning file.
+     *
+     * @param path The tuning file.
+     * @param plan The plan.
+     * @param tuning Output, the configuration (untouched if there is none).
+     * @return false if the file is missing or has no usable entry for this CPU and shape.
+     */
+    static bool load(const std::string &path, const ExecutionPlan &plan, PlanTuning &tuning);
+
+    /**
+     * Stores the configuration of a plan on the running CPU in a tuning file, replacing a previous
+     * entry of the same CPU and shape and keeping every other entry.
+     *
+     * @param path The tuning file.
+     * @param plan The plan.
+     * @param tuning The configuration.
+     * @return false if the file couldn't be written.
+     */
+    static bool store(const std::string &path, const ExecutionPlan &plan, const PlanTuning &tuning);
+};
+
+#endif //KERNELTUNER_H
@@ -0,0 +1,348 @@
+/**
+ * @file LowRankDense.cpp
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Implementation file for the LowRankDense class which represents a layer whose weights are stored
+ * as two low-rank factors, and for the truncated SVD which computes them.
+ */
+
+#define ERROR_BAD_FACTORS "Error: Factors of a low rank layer don't match each other or its bias."
+#define ERROR_BAD_RANK "Error: Rank must be between 1 and the smaller dimension of the weights."
+
+#define FACTORS_MAGIC "MLPLOWR1"
+#define FACTORS_MAGIC_LENGTH 8
+#define MAX_SWEEPS 50
+#define CONVERGED 1e-22 // Off-diagonal mass (relative to the total) at which Jacobi stops.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <vector>
+#include "LowRankDense.h"
+
+/**
+ * Inits a new layer with given parameters.
+ *
+ * @param u The outer factor (rows * rank) for this layer.
+ * @param v The inner factor (rank * cols) for this layer.
+ * @param bias The bias Matrix (Vector) for this layer.
+ * @param actType The activation type to be used in this layer.
+ */
+LowRankDense::LowRankDense(const Matrix &u, const Matrix &v, const Matrix &bias, ActivationType actType)
+        : _u(u), _v(v), _bias(bias), _activation(actType)
+{
+    if (u.getCols() != v.getRows() || bias.getRows() != u.getRows() || bias.getCols() != 1)
+    {
+        std::cerr << ERROR_BAD_FACTORS << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * Returns the outer factor of this layer.
+ * Forbids modification.
+ *
+ * @return The outer factor (rows * rank) of this layer.
+ */
+const Matrix &LowRankDense::getU() const
+{
+    return _u;
+}
+
+/**
+ * Returns the inner factor of this layer.
+ * Forbids modification.
+ *
+ * @return The inner factor (rank * cols) of this layer.
+ */
+const Matrix &LowRankDense::getV() const
+{
+    return _v;
+}
+
+/**
+ * Returns the bias of this layer.
+ * Forbids modification.
+ *
+ * @return The bias of this layer.
+ */
+const Matrix &LowRankDense::getBias() const
+{
+    return _bias;
+}
+
+/**
+ * Returns the activation function of this layer.
+ * forbids modification.
+ *
+ * @return The activation function of this layer.
+ */
+const Activation &LowRankDense::getActivation() const
+{
+    return _activation;
+}
+
+/**
+ * Returns the rank of the factorization.
+ *
+ * @return The rank.
+ */
+int LowRankDense::getRank() const
+{
+    return _v.getRows();
+}
+
+/**
+ * Applies the layer on input and returns output Matrix.
+ *
+ * @param input The Matrix to apply this layer on.
+ * @return The input Matrix after applying this layer on it (new Matrix).
+ */
+Matrix LowRankDense::operator()(const Matrix &input) const
+{
+    return (*this)(input.view());
+}
+
+/**
+ * Applies the layer on a view without copying it first.
+ *
+ * @param input The view to apply this layer on.
+ * @return The input after applying this layer on it (new Matrix).
+ */
+Matrix LowRankDense::operator()(const MatrixView &input) const
+{
+    Matrix inner(_v * input);
+    return _activation((_u * inner) + _bias);
+}
+
+/**
+ * Applies the layer on every row of a batch and returns the output batch.
+ *
+ * @param batch The batch to apply this layer on, a sample in every row.
+ * @return The output batch, a sample in every row (new Matrix).
+ */
+Matrix LowRankDense::applyBatch(const Matrix &batch) const
+{
+    Matrix output(batch.multiplyTransposed(_v).multiplyTransposed(_u));
+    output.addToEachRow(_bias);
+    _activation.activateRows(output);
+    return output;
+}
+
+// Diagonalizes the symmetric n * n matrix a (row after row) in place with cyclic Jacobi rotations,
+// the eigenvalues are left on its diagonal and the eigenvectors in the columns of vectors.
+static void _symmetricEigen(std::vector<double> &a, int n, std::vector<double> &vectors)
+{
+    vectors.assign((size_t) n * n, 0.0);
+    for (int i = 0; i < n; i++)
+    {
+        vectors[(size_t) i * n + i] = 1.0;
+    }
+
+    double total = 0.0;
+    for (double value : a)
+    {
+        total += value * value;
+    }
+    for (int sweep = 0; sweep < MAX_SWEEPS; sweep++)
+    {
+        double off = 0.0;
+        for (int p = 0; p < n; p++)
+        {
+            for (int q = p + 1; q < n; q++)
+            {
+                off += a[(size_t) p * n + q] * a[(size_t) p * n + q];
+            }
+        }
+        if (off <= CONVERGED * total)
+        {
+            return;
+        }
+
+        for (int p = 0; p < n; p++)
+        {
+            for (int q = p + 1; q < n; q++)
+            {
+                double apq = a[(size_t) p * n + q];
+                if (apq == 0.0)
+                {
+                    continue;
+                }
+                // The rotation which zeroes a[p][q] (applied to both sides of a, and to the vectors).
+                double theta = (a[(size_t) q * n + q] - a[(size_t) p * n + p]) / (2.0 * apq);
+                double t = ((theta >= 0.0) ? 1.0 : -1.0) / (std::fabs(theta) + std::sqrt(theta * theta + 1.0));
+                double c = 1.0 / std::sqrt(t * t + 1.0), s = t * c;
+                for (int k = 0; k < n; k++)
+                {
+                    double akp = a[(size_t) k * n + p], akq = a[(size_t) k * n + q];
+                    a[(size_t) k * n + p] = c * akp - s * akq;
+                    a[(size_t) k * n + q] = s * akp + c * akq;
+                }
+                for (int k = 0; k < n; k++)
+                {
+                    double apk = a[(size_t) p * n + k], aqk = a[(size_t) q * n + k];
+                    a[(size_t) p * n + k] = c * apk - s * aqk;
+                    a[(size_t) q * n + k] = s * apk + c * aqk;
+                }
+                for (int k = 0; k < n; k++)
+                {
+                    double vkp = vectors[(size_t) k * n + p], vkq = vectors[(size_t) k * n + q];
+                    vectors[(size_t) k * n + p] = c * vkp - s * vkq;
+                    vectors[(size_t) k * n + q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Computes the truncated SVD of weights: the factors U and V of rank whose product U V is
+ * the closest rank matrix to weights (in the Frobenius norm).
+ * Exits (code == 1) if the rank is not between 1 and min(rows, cols).
+ *
+ * @param weights The weights Matrix (rows * cols) to factorize.
+ * @param rank The rank of the factors.
+ * @param u Output, the outer factor (rows * rank).
+ * @param v Output, the inner factor (rank * cols).
+ */
+void LowRankDense::factorize(const Matrix &weights, int rank, Matrix &u, Matrix &v)
+{
+    int rows = weights.getRows(), cols = weights.getCols();
+    if (rank < 1 || rank > std::min(rows, cols))
+    {
+        std::cerr << ERROR_BAD_RANK << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // The singular vectors of the smaller side are the eigenvectors of its Gram matrix
+    // (W W^T or W^T W), ordered by their eigenvalues (the squared singular values).
+    bool byRows = rows <= cols;
+    int n = byRows ? rows : cols, inner = byRows ? cols : rows;
+    std::vector<double> gram((size_t) n * n, 0.0);
+    for (int i = 0; i < n; i++)
+    {
+        for (int j = i; j < n; j++)
+        {
+            double sum = 0.0;
+            for (int k = 0; k < inner; k++)
+            {
+                sum += byRows ? (double) weights.at(i, k) * weights.at(j, k)
+                              : (double) weights.at(k, i) * weights.at(k, j);
+            }
+            gram[(size_t) i * n + j] = gram[(size_t) j * n + i] = sum;
+        }
+    }
+    std::vector<double> vectors;
+    _symmetricEigen(gram, n, vectors);
+    std::vector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&gram, n](int first, int second)
+    {
+        return gram[(size_t) first * n + first] > gram[(size_t) second * n + second];
+    });
+
+    // The top singular vectors are one factor, the weights projected onto them are the other.
+    u = Matrix(rows, rank);
+    v = Matrix(rank, cols);
+    for (int r = 0; r < rank; r++)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            float component = (float) vectors[(size_t) i * n + order[r]];
+            if (byRows)
+            {
+                u(i, r) = component;
+            }
+            else
+            {
+                v(r, i) = component;
+            }
+        }
+    }
+    for (int r = 0; r < rank; r++)
+    {
+        for (int k = 0; k < inner; k++)
+        {
+            double sum = 0.0;
+            for (int i = 0; i < n; i++)
+            {
+                sum += byRows ? (double) u.at(i, r) * weights.at(i, k) : (double) weights.at(k, i) * v.at(r, i);
+            }
+            if (byRows)
+            {
+                v(r, k) = (float) sum;
+            }
+            else
+            {
+                u(k, r) = (float) sum;
+            }
+        }
+    }
+}
+
+/**
+ * Writes the factors of a layer into a factors file (a header followed by U and V).
+ *
+ * @param path The factors file.
+ * @param u The outer factor.
+ * @param v The inner factor.
+ * @return false upon failure.
+ */
+bool LowRankDense::write(const std::string &path, const Matrix &u, const Matrix &v)
+{
+    std::ofstream os(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    int32_t header[] = {u.getRows(), v.getCols(), v.getRows()};
+    os.write(FACTORS_MAGIC, FACTORS_MAGIC_LENGTH);
+    os.write((const char *) header, sizeof(header));
+    for (const Matrix *factor : {&u, &v})
+    {
+        os.write((const char *) factor->data(),
+                 (std::streamsize) ((size_t) factor->getRows() * factor->getCols() * sizeof(float)));
+    }
+    return (bool) os.flush();
+}
+
+/**
+ * Reads the factors of a rows * cols layer from a factors file.
+ *
+ * @param path The factors file.
+ * @param rows The amount of outputs of the layer.
+ * @param cols The amount of inputs of the layer.
+ * @param u Output, the outer factor.
+ * @param v Output, the inner factor.
+ * @return false (u and v unchanged) if the file isn't a factors file of such a layer.
+ */
+bool LowRankDense::read(const std::string &path, int rows, int cols, Matrix &u, Matrix &v)
+{
+    std::ifstream is(path, std::ios::in | std::ios::binary);
+    char magic[FACTORS_MAGIC_LENGTH];
+    int32_t header[3];
+    if (!is.read(magic, FACTORS_MAGIC_LENGTH) || memcmp(magic, FACTORS_MAGIC, FACTORS_MAGIC_LENGTH) != 0 ||
+        !is.read((char *) header, sizeof(header)) || header[0] != rows || header[1] != cols ||
+        header[2] < 1 || header[2] > std::min(rows, cols))
+    {
+        return false;
+    }
+
+    Matrix outer(rows, header[2]), inner(header[2], cols);
+    for (Matrix *factor : {&outer, &inner})
+    {
+        if (!is.read((char *) factor->data(),
+                     (std::streamsize) ((size_t) factor->getRows() * factor->getCols() * sizeof(float))))
+        {
+            return false;
+        }
+    }
+    if (is.peek() != std::ifstream::traits_type::eof())
+    {
+        return false;
+    }
+    u = std::move(outer);
+    v = std::move(inner);
+    return true;
+}
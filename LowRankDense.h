@@ -0,0 +1,142 @@
+/**
+ * @file LowRankDense.h
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Header file for the LowRankDense class which represents a layer whose weights are stored
+ * as two low-rank factors, and for the truncated SVD which computes them.
+ */
+
+#ifndef LOWRANKDENSE_H
+#define LOWRANKDENSE_H
+
+#include <string>
+#include "Matrix.h"
+#include "Activation.h"
+
+/**
+ * The LowRankDense class- represents a layer whose rows * cols weights W are stored as the factors
+ * U (rows * rank) and V (rank * cols) with W ~ U V, and applied as two back-to-back products:
+ * act(U (V x) + b). Takes rank * (rows + cols) multiplications per sample instead of rows * cols.
+ */
+class LowRankDense
+{
+public:
+    // Constructors.
+    /**
+     * Inits a new layer with given parameters.
+     *
+     * @param u The outer factor (rows * rank) for this layer.
+     * @param v The inner factor (rank * cols) for this layer.
+     * @param bias The bias Matrix (Vector) for this layer.
+     * @param actType The activation type to be used in this layer.
+     */
+    LowRankDense(const Matrix &u, const Matrix &v, const Matrix &bias, ActivationType actType);
+
+    // Methods.
+    /**
+     * Returns the outer factor of this layer.
+     * Forbids modification.
+     *
+     * @return The outer factor (rows * rank) of this layer.
+     */
+    const Matrix &getU() const;
+
+    /**
+     * Returns the inner factor of this layer.
+     * Forbids modification.
+     *
+     * @return The inner factor (rank * cols) of this layer.
+     */
+    const Matrix &getV() const;
+
+    /**
+     * Returns the bias of this layer.
+     * Forbids modification.
+     *
+     * @return The bias of this layer.
+     */
+    const Matrix &getBias() const;
+
+    /**
+     * Returns the activation function of this layer.
+     * forbids modification.
+     *
+     * @return The activation function of this layer.
+     */
+    const Activation &getActivation() const;
+
+    /**
+     * Returns the rank of the factorization.
+     *
+     * @return The rank.
+     */
+    int getRank() const;
+
+    // Operators.
+    /**
+     * Applies the layer on input and returns output Matrix.
+     *
+     * @param input The Matrix to apply this layer on.
+     * @return The input Matrix after applying this layer on it (new Matrix).
+     */
+    Matrix operator()(const Matrix &input) const;
+
+    /**
+     * Applies the layer on a view without copying it first.
+     *
+     * @param input The view to apply this layer on.
+     * @return The input after applying this layer on it (new Matrix).
+     */
+    Matrix operator()(const MatrixView &input) const;
+
+    /**
+     * Applies the layer on every row of a batch and returns the output batch.
+     *
+     * @param batch The batch to apply this layer on, a sample in every row.
+     * @return The output batch, a sample in every row (new Matrix).
+     */
+    Matrix applyBatch(const Matrix &batch) const;
+
+    // Static methods.
+    /**
+     * Computes the truncated SVD of weights: the factors U and V of rank whose product U V is
+     * the closest rank matrix to weights (in the Frobenius norm).
+     * Exits (code == 1) if the rank is not between 1 and min(rows, cols).
+     *
+     * @param weights The weights Matrix (rows * cols) to factorize.
+     * @param rank The rank of the factors.
+     * @param u Output, the outer factor (rows * rank).
+     * @param v Output, the inner factor (rank * cols).
+     */
+    static void factorize(const Matrix &weights, int rank, Matrix &u, Matrix &v);
+
+    /**
+     * Writes the factors of a layer into a factors file (a header followed by U and V).
+     *
+     * @param path The factors file.
+     * @param u The outer factor.
+     * @param v The inner factor.
+     * @return false upon failure.
+     */
+    static bool write(const std::string &path, const Matrix &u, const Matrix &v);
+
+    /**
+     * Reads the factors of a rows * cols layer from a factors file.
+     *
+     * @param path The factors file.
+     * @param rows The amount of outputs of the layer.
+     * @param cols The amount of inputs of the layer.
+     * @param u Output, the outer factor.
+     * @param v Output, the inner factor.
+     * @return false (u and v unchanged) if the file isn't a factors file of such a layer.
+     */
+    static bool read(const std::string &path, int rows, int cols, Matrix &u, Matrix &v);
+
+private:
+    const Matrix &_u, &_v, &_bias;
+    const Activation _activation;
+};
+
+#endif //LOWRANKDENSE_H
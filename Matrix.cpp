@@ -4,52 +4,139 @@
  * @version 1.0
  * @date 24 January 2020
  *
- * @brief Implementation file for the Matrix class which represents a 2D matrix or 1D vector.
+ * @brief Implementation file for the BasicMatrix class which represents a 2D matrix or 1D vector of any
+ * element type, and the Matrix class, the float matrix the network computes with.
  */
 
 #define ERROR_BAD_MATRIX_INPUT "Error: Invalid Matrix input."
 #define ERROR_MATRIX_DIMS "Error: Can't use operation on two Matrices with incompatible dimensions."
 #define ERROR_BAD_MATRIX_INDEX "Error: Invalid index to access matrix."
 
+#define MATRIX_MAGIC "MLPM"
+#define MATRIX_MAGIC_LENGTH 4
+
 #define NO_PIXEL "  "
 #define YES_PIXEL "**"
 
 #define DEFAULT_SIZE 1
 #define PRINT_THRESHOLD 0.1f
+#define GEMM_BLOCK_ROWS 64
+#define GEMM_BLOCK_DEPTH 256
+#define GEMM_BLOCK_COLS 256
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <iostream>
+#include <type_traits>
+#include <vector>
 #include "Matrix.h"
+#include "MatrixAllocator.h"
 
-// Returns pointer to a malloced array of the given length, filled with 0.
-static float *_createZeroVector(int length)
+/**
+ * Prints the incompatible dimensions error and exits (code == 1).
+ */
+void matrixDimsError()
 {
-    auto *vector = new float[length];
-    for (int i = 0; i < length; i++)
-    {
-        vector[i] = 0.0f;
-    }
-    return vector;
+    std::cerr << ERROR_MATRIX_DIMS << std::endl;
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * The header write() puts before the elements of a matrix.
+ */
+struct MatrixHeader
+{
+    char magic[MATRIX_MAGIC_LENGTH];
+    int32_t type; // An ElementType.
+    int32_t rows, cols;
+    float scale;
+};
+
+// Returns storage for length elements of type T (see MatrixAllocator.h), filled with 0.
+template<typename T>
+static T *_createZeroArray(size_t length)
+{
+    size_t floats = (length * sizeof(T) + sizeof(float) - 1) / sizeof(float);
+    float *array = MatrixAllocator::allocate(floats);
+    std::memset(array, 0, floats * sizeof(float));
+    return reinterpret_cast<T *>(array);
+}
+
+// Releases storage of _createZeroArray().
+template<typename T>
+static void _releaseArray(T *array)
+{
+    MatrixAllocator::release(reinterpret_cast<float *>(array));
+}
+
+// Returns the element nearest to a real value (for types which aren't quantized).
+template<typename T>
+static T _fromReal(float value)
+{
+    return static_cast<T>(value);
+}
+
+template<>
+BFloat16 _fromReal<BFloat16>(float value)
+{
+    return BFloat16(value);
 }
 
-// Returns pointer to a malloced copy of the given array.
-static float *_copyVector(int length, const float vector[])
+// Returns the real value of element i of an array of elements of the given type.
+static float _decode(const char elements[], ElementType type, size_t i, float scale)
 {
-    auto *newVector = new float[length];
-    for (int i = 0; i < length; i++)
+    switch (type)
     {
-        newVector[i] = vector[i];
+        case FloatElement:
+        {
+            float value;
+            std::memcpy(&value, elements + i * sizeof(value), sizeof(value));
+            return value * scale;
+        }
+        case DoubleElement:
+        {
+            double value;
+            std::memcpy(&value, elements + i * sizeof(value), sizeof(value));
+            return (float) value * scale;
+        }
+        case BFloat16Element:
+        {
+            BFloat16 value;
+            std::memcpy(&value, elements + i * sizeof(value), sizeof(value));
+            return (float) value * scale;
+        }
+        case Int8Element:
+            return (float) (int8_t) elements[i] * scale;
+        case UInt8Element:
+            return (float) (uint8_t) elements[i] * scale;
+        default:
+        {
+            int32_t value;
+            std::memcpy(&value, elements + i * sizeof(value), sizeof(value));
+            return (float) value * scale;
+        }
     }
-    return newVector;
+}
+
+// Returns whether a stream has nothing left to read (and clears its state).
+static bool _atEnd(std::istream &is)
+{
+    char test;
+    bool end = !is.read(&test, 1);
+    is.clear();
+    return end;
 }
 
 /**
- * Constructs Matrix rows * cols.
+ * Constructs BasicMatrix rows * cols.
  * Inits all elements to 0.
  *
  * @param rows Number of rows the matrix will have.
- * @param colsNumber of columns the matrix will have.
+ * @param cols Number of columns the matrix will have.
  */
-Matrix::Matrix(int rows, int cols) : _rows(rows), _cols(cols)
+template<typename T>
+BasicMatrix<T>::BasicMatrix(int rows, int cols) : _rows(rows), _cols(cols), _scale(1.0f)
 {
     if (rows <= 0 || cols <= 0)
     {
@@ -58,91 +145,67 @@ Matrix::Matrix(int rows, int cols) : _rows(rows), _cols(cols)
         exit(EXIT_FAILURE);
     }
 
-    if (cols == DEFAULT_SIZE)
-    {
-        _matrix = nullptr;
-        _vector = _createZeroVector(rows);
-    }
-    else
-    {
-        _vector = nullptr;
-        _matrix = new float *[rows];
-        for (int i = 0; i < rows; i++)
-        {
-            _matrix[i] = _createZeroVector(cols);
-        }
-    }
+    _data = _createZeroArray<T>((size_t) rows * cols);
 }
 
 /**
- * Constructs 1*1 Matrix.
+ * Constructs 1*1 BasicMatrix.
  * Inits the single element to 0.
  */
-Matrix::Matrix() : _rows(DEFAULT_SIZE), _cols(DEFAULT_SIZE), _matrix(nullptr)
-{
-    _vector = _createZeroVector(DEFAULT_SIZE);
-}
+template<typename T>
+BasicMatrix<T>::BasicMatrix() : _rows(DEFAULT_SIZE), _cols(DEFAULT_SIZE), _data(_createZeroArray<T>(DEFAULT_SIZE)),
+                                _scale(1.0f)
+{}
 
 /**
- * Copies another Matrix into this one. (Private method)
+ * Copies another BasicMatrix into this one. (Private method)
  *
  * @param other The matrix to copy.
  */
-void Matrix::_copyMatrix(const Matrix &other)
+template<typename T>
+void BasicMatrix<T>::_copyMatrix(const BasicMatrix &other)
 {
     _rows = other._rows;
     _cols = other._cols;
-    if (other._matrix == nullptr)
-    {
-        _matrix = nullptr;
-        _vector = _copyVector(_rows, other._vector);
-    }
-    else
-    {
-        _vector = nullptr;
-        _matrix = new float *[_rows];
-        for (int i = 0; i < _rows; i++)
-        {
-            _matrix[i] = _copyVector(_cols, other._matrix[i]);
-        }
-    }
+    _scale = other._scale;
+    _data = _createZeroArray<T>(_size());
+    std::memcpy(_data, other._data, _size() * sizeof(T));
 }
 
 /**
- * Constructs Matrix from another Matrix m.
+ * Constructs BasicMatrix from another BasicMatrix m.
  *
- * @param m The Matrix to copy.
+ * @param m The BasicMatrix to copy.
  */
-Matrix::Matrix(const Matrix &m)
+template<typename T>
+BasicMatrix<T>::BasicMatrix(const BasicMatrix &m)
 {
     _copyMatrix(m);
 }
 
 /**
- * Frees the memory occupied by the arrays. (private)
+ * Constructs BasicMatrix by taking over the memory of another BasicMatrix m,
+ * which is left as a 1*1 BasicMatrix.
+ *
+ * @param m The BasicMatrix to move.
  */
-void Matrix::_freeArrays()
+template<typename T>
+BasicMatrix<T>::BasicMatrix(BasicMatrix &&m) noexcept : _rows(m._rows), _cols(m._cols), _data(m._data),
+                                                         _scale(m._scale)
 {
-    if (_matrix == nullptr)
-    {
-        delete[] _vector;
-    }
-    else
-    {
-        for (int i = 0; i < _rows; i++)
-        {
-            delete[] _matrix[i];
-        }
-        delete[] _matrix;
-    }
+    m._rows = DEFAULT_SIZE;
+    m._cols = DEFAULT_SIZE;
+    m._data = _createZeroArray<T>(DEFAULT_SIZE);
+    m._scale = 1.0f;
 }
 
 /**
- * Destroys the Matrix and frees the memory occupied by it.
+ * Destroys the BasicMatrix and frees the memory occupied by it.
  */
-Matrix::~Matrix()
+template<typename T>
+BasicMatrix<T>::~BasicMatrix()
 {
-    _freeArrays();
+    _releaseArray(_data);
 }
 
 /**
@@ -150,7 +213,8 @@ Matrix::~Matrix()
  *
  * @return The amount of rows as int.
  */
-int Matrix::getRows() const
+template<typename T>
+int BasicMatrix<T>::getRows() const
 {
     return _rows;
 }
@@ -160,257 +224,280 @@ int Matrix::getRows() const
  *
  * @return The amount of columns as int.
  */
-int Matrix::getCols() const
+template<typename T>
+int BasicMatrix<T>::getCols() const
 {
     return _cols;
 }
 
 /**
- * Transforms a matrix into a column vector.
- * Supports function calling concatenation.
- * i.e.(1) Matrix m(5,4);... m.vectorize()
- * m.getCols() == 1
- * m.getRows() == 20
- * i.e.(2) Matrix m(5,4), b(20, 1); then
- * m.vectorize() + b should be a valid expression.
+ * Returns the real value of a unit of an element (1 unless quantized).
+ *
+ * @return The scale.
  */
-Matrix &Matrix::vectorize()
+template<typename T>
+float BasicMatrix<T>::getScale() const
 {
-    if (_matrix != nullptr)
-    {
-        int newRows = _rows * _cols;
-        _vector = new float[newRows];
-        for (int y = 0, i = 0; y < _rows; y++)
-        {
-            float *row = _matrix[y];
-            for (int x = 0; x < _cols; x++, i++)
-            {
-                _vector[i] = row[x];
-            }
-            delete[] row;
-        }
-        delete[] _matrix;
-        _matrix = nullptr;
-        _rows = newRows;
-        _cols = DEFAULT_SIZE;
-    }
-    return *this;
+    return _scale;
 }
 
 /**
- * Prints matrix elements, no return value.
- * prints space after each element (incl. last element in the row).
- * prints newline after each row (incl. last row).
+ * Sets the real value of a unit of an element.
+ *
+ * @param scale The scale.
  */
-void Matrix::plainPrint() const
+template<typename T>
+void BasicMatrix<T>::setScale(float scale)
 {
-    if (_matrix == nullptr)
-    {
-        for (int i = 0; i < _rows; i++)
-        {
-            std::cout << _vector[i] << " " << std::endl;
-        }
-    }
-    else
-    {
-        for (int i = 0; i < _rows; i++)
-        {
-            float *row = _matrix[i];
-            for (int j = 0; j < _cols; j++)
-            {
-                std::cout << row[j] << " ";
-            }
-            std::cout << std::endl;
-        }
-    }
+    _scale = scale;
 }
 
 /**
- * Matrix copy constructor (Matrix a,b; ... a = b;)
+ * Returns the elements, stored row after row.
  *
- * @param other The matrix to copy.
- * @return A reference to this Matrix after copying the other Matrix.
+ * @return The elements of this BasicMatrix.
  */
-Matrix &Matrix::operator=(const Matrix &other)
+template<typename T>
+T *BasicMatrix<T>::data()
 {
-    if (this != &other)
-    {
-        _freeArrays();
-        _copyMatrix(other);
-    }
-    return *this;
+    return _data;
 }
 
 /**
- * Matrix a,b; -> a * b
+ * Returns the elements, stored row after row.
  *
- * @param other The other matrix.
- * @return A reference to the result as a Matrix.
+ * @return The elements of this BasicMatrix.
  */
-Matrix Matrix::operator*(const Matrix &other) const
+template<typename T>
+const T *BasicMatrix<T>::data() const
 {
-    if (_cols != other._rows)
+    return _data;
+}
+
+/**
+ * Prints matrix elements (their real values), no return value.
+ * prints space after each element (incl. last element in the row).
+ * prints newline after each row (incl. last row).
+ */
+template<typename T>
+void BasicMatrix<T>::plainPrint() const
+{
+    for (int i = 0; i < _rows; i++)
     {
-        std::cerr << ERROR_MATRIX_DIMS << std::endl;
-        exit(EXIT_FAILURE);
+        const T *row = _row(i);
+        for (int j = 0; j < _cols; j++)
+        {
+            std::cout << (double) widen(row[j]) * _scale << " ";
+        }
+        std::cout << std::endl;
     }
+}
 
-    Matrix newMatrix(_rows, other._cols);
-
-    if (_matrix == nullptr)
+/**
+ * Converts a float matrix into this element type. Integer types are quantized symmetrically:
+ * the scale maps the largest magnitude to ElementTraits<T>::quantizedMax and every value is
+ * rounded to the nearest unit (uint8_t clamps negative values to 0).
+ *
+ * @param matrix The float matrix.
+ * @return The converted matrix.
+ */
+template<typename T>
+BasicMatrix<T> BasicMatrix<T>::quantize(const BasicMatrix<float> &matrix)
+{
+    BasicMatrix result(matrix.getRows(), matrix.getCols());
+    const float *values = matrix.data();
+    size_t size = result._size();
+    if constexpr (std::is_integral<T>::value)
     {
-        if (other._matrix == nullptr)
+        const long largest = ElementTraits<T>::quantizedMax;
+        const long smallest = std::is_signed<T>::value ? -largest : 0;
+        float magnitude = 0.0f;
+        for (size_t i = 0; i < size; i++)
         {
-            // Vector * 1*1 Vector.
-            float otherVal = other._vector[0];
-            for (int i = 0; i < newMatrix._rows; i++)
-            {
-                newMatrix._vector[i] = _vector[i] * otherVal;
-            }
-            return newMatrix;
+            magnitude = std::max(magnitude, std::fabs(values[i] * matrix.getScale()));
         }
-
-        // Vector * Matrix.
-        for (int i = 0; i < newMatrix._rows; i++)
+        result._scale = (magnitude > 0.0f) ? magnitude / (float) largest : 1.0f;
+        for (size_t i = 0; i < size; i++)
         {
-            for (int j = 0; j < newMatrix._cols; j++)
-            {
-                newMatrix._matrix[i][j] = _vector[i] * other._matrix[0][j];
-            }
+            long unit = std::lround(values[i] * matrix.getScale() / result._scale);
+            result._data[i] = (T) std::min(std::max(unit, smallest), largest);
         }
-        return newMatrix;
     }
-
-    if (other._matrix == nullptr)
+    else
     {
-        // Matrix * Vector.
-        for (int i = 0; i < newMatrix._rows; i++)
+        for (size_t i = 0; i < size; i++)
         {
-            float &sum = newMatrix._vector[i];
-            for (int k = 0; k < _cols; k++)
-            {
-                sum += _matrix[i][k] * other._vector[k];
-            }
+            result._data[i] = _fromReal<T>(values[i] * matrix.getScale());
         }
-        return newMatrix;
     }
+    return result;
+}
 
-    // Matrix * Matrix.
-    for (int i = 0; i < newMatrix._rows; i++)
+/**
+ * Returns the real values of the elements as a float matrix.
+ *
+ * @return The float matrix.
+ */
+template<typename T>
+BasicMatrix<float> BasicMatrix<T>::dequantize() const
+{
+    BasicMatrix<float> result(_rows, _cols);
+    float *values = result.data();
+    for (size_t i = 0; i < _size(); i++)
     {
-        for (int j = 0; j < newMatrix._cols; j++)
-        {
-            float &sum = newMatrix._matrix[i][j];
-            for (int k = 0; k < _cols; k++)
-            {
-                sum += _matrix[i][k] * other._matrix[k][j];
-            }
-        }
+        values[i] = (float) widen(_data[i]) * _scale;
     }
-    return newMatrix;
+    return result;
 }
 
 /**
- *  Matrix m; float c; -> m * c
+ * Reads a matrix of this one's dimensions, written by write() (in any element type, converted
+ * to T through its real values unless it is T) or as raw float32 elements.
+ * Has to read input stream fully.
  *
- * @param matrix A matrix.
- * @param scalar A scalar (float).
- * @return A reference to the result as a Matrix.
+ * @param is The input stream.
+ * @return false if the stream holds anything else (this is left unchanged).
  */
-Matrix Matrix::operator*(float scalar) const
+template<typename T>
+bool BasicMatrix<T>::read(std::istream &is)
 {
-    Matrix newMatrix(*this);
-    if (_matrix == nullptr)
+    MatrixHeader header;
+    is.read((char *) &header, sizeof(header));
+    size_t headerBytes = (size_t) is.gcount();
+    ElementType type = FloatElement;
+    float scale = 1.0f;
+    std::vector<char> elements;
+    if (headerBytes == sizeof(header) && std::memcmp(header.magic, MATRIX_MAGIC, MATRIX_MAGIC_LENGTH) == 0)
     {
-        for (int i = 0; i < newMatrix._rows; i++)
+        type = (ElementType) header.type;
+        scale = header.scale;
+        if (elementSize(type) == 0 || header.rows != _rows || header.cols != _cols)
+        {
+            return false;
+        }
+        elements.resize(_size() * elementSize(type));
+        if (!is.read(elements.data(), (std::streamsize) elements.size()))
         {
-            newMatrix._vector[i] *= scalar;
+            return false;
         }
     }
     else
     {
-        for (int i = 0; i < newMatrix._rows; i++)
+        // Raw float32 elements, the first of which were read as a header.
+        elements.resize(_size() * sizeof(float));
+        if (headerBytes > elements.size())
         {
-            for (int j = 0; j < newMatrix._cols; j++)
-            {
-                newMatrix._matrix[i][j] *= scalar;
-            }
+            return false;
+        }
+        std::memcpy(elements.data(), &header, headerBytes);
+        is.clear();
+        if (headerBytes < elements.size() &&
+            !is.read(elements.data() + headerBytes, (std::streamsize) (elements.size() - headerBytes)))
+        {
+            return false;
         }
     }
+    if (!_atEnd(is))
+    {
+        return false;
+    }
 
-    return newMatrix;
+    if (type == ElementTraits<T>::type)
+    {
+        std::memcpy(_data, elements.data(), elements.size());
+        _scale = scale;
+        return true;
+    }
+    BasicMatrix<float> values(_rows, _cols);
+    for (size_t i = 0; i < _size(); i++)
+    {
+        values.data()[i] = _decode(elements.data(), type, i, scale);
+    }
+    *this = quantize(values);
+    return true;
 }
 
 /**
- *  Matrix m; float c; -> c * m
+ * Writes the matrix in binary: a header (element type, dimensions and scale), then the elements.
  *
- * @param matrix A matrix.
- * @param scalar A scalar (float).
- * @return A reference to the result as a Matrix.
+ * @param os The output stream.
  */
-Matrix operator*(float scalar, const Matrix &matrix)
+template<typename T>
+void BasicMatrix<T>::write(std::ostream &os) const
 {
-    return (matrix * scalar);
+    MatrixHeader header = {{}, ElementTraits<T>::type, _rows, _cols, _scale};
+    std::memcpy(header.magic, MATRIX_MAGIC, MATRIX_MAGIC_LENGTH);
+    os.write((const char *) &header, sizeof(header));
+    os.write((const char *) _data, (std::streamsize) (_size() * sizeof(T)));
 }
 
 /**
- * Matrix a,b; -> a += b
+ * Reinterprets the elements (row after row) as a rows * cols matrix, without copying them.
+ * Exits (code == 1) if the amount of elements differs. (Private method)
  *
- * @param other The other matrix.
- * @return A reference to this Matrix after addition.
+ * @param rows The new amount of rows.
+ * @param cols The new amount of columns.
  */
-Matrix &Matrix::operator+=(const Matrix &other)
+template<typename T>
+void BasicMatrix<T>::_reshape(int rows, int cols)
 {
-    if (_cols != other._cols || _rows != other._rows)
+    if (rows <= 0 || cols <= 0 || (size_t) rows * cols != _size())
     {
         std::cerr << ERROR_MATRIX_DIMS << std::endl;
         exit(EXIT_FAILURE);
     }
+    _rows = rows;
+    _cols = cols;
+}
 
-    if (_matrix == nullptr)
+/**
+ * BasicMatrix copy assignment (BasicMatrix a,b; ... a = b;)
+ *
+ * @param other The matrix to copy.
+ * @return A reference to this BasicMatrix after copying the other BasicMatrix.
+ */
+template<typename T>
+BasicMatrix<T> &BasicMatrix<T>::operator=(const BasicMatrix &other)
+{
+    if (this != &other)
     {
-        for (int i = 0; i < _rows; i++)
+        if (_size() == other._size())
         {
-            _vector[i] += other._vector[i];
+            _rows = other._rows;
+            _cols = other._cols;
+            _scale = other._scale;
+            std::memcpy(_data, other._data, _size() * sizeof(T));
         }
-    }
-    else
-    {
-        for (int i = 0; i < _rows; i++)
+        else
         {
-            float *row = _matrix[i], *otherRow = other._matrix[i];
-            for (int j = 0; j < _cols; j++)
-            {
-                row[j] += otherRow[j];
-            }
+            _releaseArray(_data);
+            _copyMatrix(other);
         }
     }
-
     return *this;
 }
 
 /**
- * Matrix a,b; -> a + b
+ * BasicMatrix move assignment (BasicMatrix a; ... a = BasicMatrix(3, 4);)
  *
- * @param other The other matrix.
- * @return A reference to the result as a Matrix.
+ * @param other The matrix to move, left as a 1*1 BasicMatrix.
+ * @return A reference to this BasicMatrix after taking over the other BasicMatrix.
  */
-Matrix Matrix::operator+(const Matrix &other) const
+template<typename T>
+BasicMatrix<T> &BasicMatrix<T>::operator=(BasicMatrix &&other) noexcept
 {
-    if (_cols != other._cols || _rows != other._rows)
-    {
-        std::cerr << ERROR_MATRIX_DIMS << std::endl;
-        exit(EXIT_FAILURE);
-    }
-
-    Matrix newMatrix(*this);
-    return (newMatrix += other);
+    std::swap(_rows, other._rows);
+    std::swap(_cols, other._cols);
+    std::swap(_data, other._data);
+    std::swap(_scale, other._scale);
+    return *this;
 }
 
 /**
  * Double index access. (private)
  */
-float &Matrix::_accessCell(int i, int j) const
+template<typename T>
+T &BasicMatrix<T>::_accessCell(int i, int j) const
 {
     if (i < 0 || j < 0 || i >= _rows || j >= _cols)
     {
@@ -418,17 +505,14 @@ float &Matrix::_accessCell(int i, int j) const
         exit(EXIT_FAILURE);
     }
 
-    if (_matrix == nullptr)
-    {
-        return _vector[i];
-    }
-    return _matrix[i][j];
+    return _row(i)[j];
 }
 
 /**
  * Single index access. (private)
  */
-float &Matrix::_accessCell(int i) const
+template<typename T>
+T &BasicMatrix<T>::_accessCell(int i) const
 {
     int x = i % _cols;
     int y = (i - x) / _cols;
@@ -436,134 +520,494 @@ float &Matrix::_accessCell(int i) const
 }
 
 /**
- * For i,j indices, Matrix m:
+ * For i,j indices, BasicMatrix m:
  * m(i,j) will return the i,j element.
  *
  * @param i The row index.
  * @param j The column index.
- * @return The i,j element in this Matrix.
+ * @return The i,j element in this BasicMatrix.
  */
-float &Matrix::operator()(int i, int j)
+template<typename T>
+T &BasicMatrix<T>::operator()(int i, int j)
 {
     return _accessCell(i, j);
 }
 
 /**
- * For i index, Matrix m:
+ * For i index, BasicMatrix m:
  * m[i] will return the i'th element.
  *
- * @param i The index in the Matrix.
- * @return The i'th element in this Matrix.
+ * @param i The index in the BasicMatrix.
+ * @return The i'th element in this BasicMatrix.
  */
-float &Matrix::operator[](int i)
+template<typename T>
+T &BasicMatrix<T>::operator[](int i)
 {
     return _accessCell(i);
 }
 
 /**
- * For i,j indices, Matrix m:
+ * For i,j indices, BasicMatrix m:
  * m(i,j) will return the i,j element.
  *
  * @param i The row index.
  * @param j The column index.
- * @return The i,j element in this Matrix.
+ * @return The i,j element in this BasicMatrix.
  */
-float Matrix::operator()(int i, int j) const
+template<typename T>
+T BasicMatrix<T>::operator()(int i, int j) const
 {
     return _accessCell(i, j);
 }
 
 /**
- * For i index, Matrix m:
+ * For i index, BasicMatrix m:
  * m[i] will return the i'th element.
  *
- * @param i The index in the Matrix.
- * @return The i'th element in this Matrix.
+ * @param i The index in the BasicMatrix.
+ * @return The i'th element in this BasicMatrix.
  */
-float Matrix::operator[](int i) const
+template<typename T>
+T BasicMatrix<T>::operator[](int i) const
 {
     return _accessCell(i);
 }
 
 /**
- * Fills matrix elements.
- * Has to read input stream fully, otherwise, that's an error.
- * istream is; Matrix m(rows, cols); ... is >> m;
+ * Fills matrix elements, from a stream written by write() or of raw float32 elements (see read()).
+ * Has to read input stream fully, otherwise, that's an error (exits, code == 1).
+ * istream is; BasicMatrix<T> m(rows, cols); ... is >> m;
  *
  * @param is The input stream.
- * @param matrix The Matrix.
+ * @param matrix The BasicMatrix.
  * @return A reference to the input stream.
  */
-std::istream &operator>>(std::istream &is, Matrix &matrix)
+template<typename T>
+std::istream &operator>>(std::istream &is, BasicMatrix<T> &matrix)
+{
+    if (!matrix.read(is))
+    {
+        std::cerr << ERROR_BAD_MATRIX_INPUT << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    return is;
+}
+
+/**
+ * Multiplies matrices of (possibly) different element types, accumulating in the accumulator of
+ * the pair (see ProductTraits): int8 x uint8 -> int32, int8 x int8 -> int32, uint8 x uint8 -> int32,
+ * bf16 x fp32 -> fp32, fp32 x fp32 -> fp32, and any type x fp64 -> fp64 (the double precision
+ * reference of BasicDense).
+ * The scale of the result is the product of the scales, so it dequantizes to the real product.
+ * Exits (code == 1) if a's columns aren't b's rows.
+ *
+ * @param a The left matrix (n * k).
+ * @param b The right matrix (k * m).
+ * @return The n * m product.
+ */
+template<typename A, typename B>
+BasicMatrix<typename ProductTraits<A, B>::Accumulator> multiply(const BasicMatrix<A> &a, const BasicMatrix<B> &b)
 {
-    if (matrix._matrix == nullptr)
+    typedef typename ProductTraits<A, B>::Accumulator Accumulator;
+    if (a.getCols() != b.getRows())
+    {
+        matrixDimsError();
+    }
+
+    // Every element of a row of a meets a whole row of b, read in order.
+    BasicMatrix<Accumulator> product(a.getRows(), b.getCols());
+    int cols = b.getCols();
+    for (int i = 0; i < a.getRows(); i++)
     {
-        for (int i = 0; i < matrix._rows; i++)
+        Accumulator *row = product.data() + (size_t) i * cols;
+        for (int k = 0; k < a.getCols(); k++)
         {
-            is.read((char *)&(matrix._vector[i]), sizeof(float));
-            if (is.fail())
+            Accumulator value = (Accumulator) widen(a.at(i, k));
+            const B *otherRow = b.data() + (size_t) k * cols;
+            for (int j = 0; j < cols; j++)
             {
-                std::cerr << ERROR_BAD_MATRIX_INPUT << std::endl;
-                exit(EXIT_FAILURE);
+                row[j] += value * (Accumulator) widen(otherRow[j]);
             }
         }
     }
-    else
+    product.setScale(a.getScale() * b.getScale());
+    return product;
+}
+
+// The element types and mixed products of BasicMatrix.
+template class BasicMatrix<float>;
+template class BasicMatrix<double>;
+template class BasicMatrix<BFloat16>;
+template class BasicMatrix<int8_t>;
+template class BasicMatrix<uint8_t>;
+template class BasicMatrix<int32_t>;
+template std::istream &operator>>(std::istream &is, BasicMatrix<float> &matrix);
+template std::istream &operator>>(std::istream &is, BasicMatrix<double> &matrix);
+template std::istream &operator>>(std::istream &is, BasicMatrix<BFloat16> &matrix);
+template std::istream &operator>>(std::istream &is, BasicMatrix<int8_t> &matrix);
+template std::istream &operator>>(std::istream &is, BasicMatrix<uint8_t> &matrix);
+template std::istream &operator>>(std::istream &is, BasicMatrix<int32_t> &matrix);
+template BasicMatrix<int32_t> multiply(const BasicMatrix<int8_t> &a, const BasicMatrix<uint8_t> &b);
+template BasicMatrix<int32_t> multiply(const BasicMatrix<int8_t> &a, const BasicMatrix<int8_t> &b);
+template BasicMatrix<int32_t> multiply(const BasicMatrix<uint8_t> &a, const BasicMatrix<uint8_t> &b);
+template BasicMatrix<float> multiply(const BasicMatrix<BFloat16> &a, const BasicMatrix<float> &b);
+template BasicMatrix<float> multiply(const BasicMatrix<float> &a, const BasicMatrix<float> &b);
+template BasicMatrix<double> multiply(const BasicMatrix<float> &a, const BasicMatrix<double> &b);
+template BasicMatrix<double> multiply(const BasicMatrix<double> &a, const BasicMatrix<double> &b);
+template BasicMatrix<double> multiply(const BasicMatrix<BFloat16> &a, const BasicMatrix<double> &b);
+template BasicMatrix<double> multiply(const BasicMatrix<int8_t> &a, const BasicMatrix<double> &b);
+template BasicMatrix<double> multiply(const BasicMatrix<int32_t> &a, const BasicMatrix<double> &b);
+
+/**
+ * Constructs Matrix rows * cols.
+ * Inits all elements to 0.
+ *
+ * @param rows Number of rows the matrix will have.
+ * @param colsNumber of columns the matrix will have.
+ */
+Matrix::Matrix(int rows, int cols) : BasicMatrix<float>(rows, cols)
+{}
+
+/**
+ * Constructs 1*1 Matrix.
+ * Inits the single element to 0.
+ */
+Matrix::Matrix() : BasicMatrix<float>()
+{}
+
+/**
+ * Constructs Matrix from another Matrix m.
+ *
+ * @param m The Matrix to copy.
+ */
+Matrix::Matrix(const Matrix &m) : BasicMatrix<float>(m), MatrixExpression<Matrix>()
+{}
+
+/**
+ * Constructs Matrix by taking over the memory of another Matrix m,
+ * which is left as a 1*1 Matrix.
+ *
+ * @param m The Matrix to move.
+ */
+Matrix::Matrix(Matrix &&m) noexcept : BasicMatrix<float>(std::move(m)), MatrixExpression<Matrix>()
+{}
+
+/**
+ * Constructs Matrix by taking over the memory of a BasicMatrix<float> m (i.e. a dequantized matrix),
+ * which is left as a 1*1 BasicMatrix.
+ *
+ * @param m The BasicMatrix to move.
+ */
+Matrix::Matrix(BasicMatrix<float> &&m) noexcept : BasicMatrix<float>(std::move(m))
+{}
+
+/**
+ * Constructs Matrix from a plain product of two Matrices (a * b),
+ * which is computed by the blocked product instead of element by element.
+ *
+ * @param product The product to evaluate.
+ */
+Matrix::Matrix(const MatrixProduct<Matrix, Matrix> &product) : Matrix(product.left()._multiply(product.right()))
+{}
+
+/**
+ * Transforms a matrix into a column vector.
+ * Supports function calling concatenation.
+ * i.e.(1) Matrix m(5,4);... m.vectorize()
+ * m.getCols() == 1
+ * m.getRows() == 20
+ * i.e.(2) Matrix m(5,4), b(20, 1); then
+ * m.vectorize() + b should be a valid expression.
+ * Elements are stored row after row, so nothing is copied.
+ *
+ * @return A reference to this Matrix after vectorizing it.
+ */
+Matrix &Matrix::vectorize()
+{
+    return reshape(_rows * _cols, DEFAULT_SIZE);
+}
+
+/**
+ * Reinterprets the elements (row after row) as a rows * cols Matrix, without copying them.
+ * Exits (code == 1) if the amount of elements differs.
+ *
+ * @param rows The new amount of rows.
+ * @param cols The new amount of columns.
+ * @return A reference to this Matrix after reshaping it.
+ */
+Matrix &Matrix::reshape(int rows, int cols)
+{
+    _reshape(rows, cols);
+    return *this;
+}
+
+/**
+ * Returns a view of the whole Matrix.
+ * The view is valid until the Matrix is destroyed, reassigned or moved.
+ *
+ * @return A view of this Matrix.
+ */
+MatrixView Matrix::view() const
+{
+    return MatrixView(_data, _rows, _cols, _cols);
+}
+
+/**
+ * Returns a view of count rows starting at row first (a single image of a batch: rowRange(i, 1)).
+ *
+ * @param first The first row of the view.
+ * @param count The amount of rows in the view.
+ * @return A view of the rows.
+ */
+MatrixView Matrix::rowRange(int first, int count) const
+{
+    return view().rowRange(first, count);
+}
+
+/**
+ * Returns a view of count columns starting at column first.
+ *
+ * @param first The first column of the view.
+ * @param count The amount of columns in the view.
+ * @return A view of the columns.
+ */
+MatrixView Matrix::colRange(int first, int count) const
+{
+    return view().colRange(first, count);
+}
+
+/**
+ * Returns a view of the rows * cols block whose top left element is row, col.
+ *
+ * @param row The first row of the block.
+ * @param col The first column of the block.
+ * @param rows The amount of rows in the block.
+ * @param cols The amount of columns in the block.
+ * @return A view of the block.
+ */
+MatrixView Matrix::block(int row, int col, int rows, int cols) const
+{
+    return view().block(row, col, rows, cols);
+}
+
+/**
+ * Multiplies this Matrix by the transpose of another one.
+ * Matrix a(n, k), b(m, k); -> a.multiplyTransposed(b) is the n * m Matrix a * b^T.
+ * Used for batches which hold a sample in every row.
+ *
+ * @param other The Matrix whose transpose to multiply by.
+ * @return The result as a new Matrix.
+ */
+Matrix Matrix::multiplyTransposed(const Matrix &other) const
+{
+    if (_cols != other._cols)
     {
-        for (int i = 0; i < matrix._rows; i++)
+        std::cerr << ERROR_MATRIX_DIMS << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // Each row of other is read once and stays in cache while it meets every row of this.
+    Matrix newMatrix(_rows, other._rows);
+    for (int j = 0; j < other._rows; j++)
+    {
+        const float *otherRow = other._row(j);
+        for (int i = 0; i < _rows; i++)
         {
-            float *row = matrix._matrix[i];
-            for (int j = 0; j < matrix._cols; j++)
+            const float *row = _row(i);
+            float sum = 0.0f;
+            for (int k = 0; k < _cols; k++)
             {
-                is.read((char *)&(row[j]), sizeof(float));
-                if (is.fail())
-                {
-                    std::cerr << ERROR_BAD_MATRIX_INPUT << std::endl;
-                    exit(EXIT_FAILURE);
-                }
+                sum += row[k] * otherRow[k];
             }
+            newMatrix._row(i)[j] = sum;
+        }
+    }
+    return newMatrix;
+}
+
+/**
+ * Returns the transpose of this Matrix.
+ * Matrix m(n, k); -> m.transpose() is a k * n Matrix.
+ *
+ * @return The transpose as a new Matrix.
+ */
+Matrix Matrix::transpose() const
+{
+    Matrix newMatrix(_cols, _rows);
+    for (int i = 0; i < _rows; i++)
+    {
+        const float *row = _row(i);
+        for (int j = 0; j < _cols; j++)
+        {
+            newMatrix._row(j)[i] = row[j];
         }
     }
+    return newMatrix;
+}
 
-    // Check if can read anymore.
-    float test;
-    if (is.read((char *)&test, sizeof(float)))
+/**
+ * Adds a column vector (with as many rows as this Matrix has columns) to every row.
+ * Matrix m(n, k), b(k, 1); -> m.addToEachRow(b)
+ *
+ * @param vector The vector to add.
+ * @return A reference to this Matrix after addition.
+ */
+Matrix &Matrix::addToEachRow(const Matrix &vector)
+{
+    if (vector._cols != DEFAULT_SIZE || vector._rows != _cols)
     {
-        std::cerr << ERROR_BAD_MATRIX_INPUT << std::endl;
+        std::cerr << ERROR_MATRIX_DIMS << std::endl;
         exit(EXIT_FAILURE);
     }
-    is.clear();
-    return is;
+
+    for (int i = 0; i < _rows; i++)
+    {
+        float *row = _row(i);
+        for (int j = 0; j < _cols; j++)
+        {
+            row[j] += vector._data[j];
+        }
+    }
+    return *this;
 }
 
 /**
- * Pretty export of the matrix.
+ * Matrix copy constructor (Matrix a,b; ... a = b;)
  *
- * @param os The output stream.
- * @param matrix The matrix.
- * @return A reference to the output stream.
+ * @param other The matrix to copy.
+ * @return A reference to this Matrix after copying the other Matrix.
  */
-std::ostream &operator<<(std::ostream &os, const Matrix &matrix)
+Matrix &Matrix::operator=(const Matrix &other)
+{
+    BasicMatrix<float>::operator=(other);
+    return *this;
+}
+
+/**
+ * Matrix move assignment (Matrix a; ... a = Matrix(3, 4);)
+ *
+ * @param other The matrix to move, left as a 1*1 Matrix.
+ * @return A reference to this Matrix after taking over the other Matrix.
+ */
+Matrix &Matrix::operator=(Matrix &&other) noexcept
+{
+    BasicMatrix<float>::operator=(std::move(other));
+    return *this;
+}
+
+/**
+ * Evaluates a plain product of two Matrices (a * b) into this Matrix
+ * by the blocked product.
+ *
+ * @param product The product to evaluate.
+ * @return A reference to this Matrix after the evaluation.
+ */
+Matrix &Matrix::operator=(const MatrixProduct<Matrix, Matrix> &product)
 {
-    if (matrix._matrix == nullptr)
+    return (*this = product.left()._multiply(product.right()));
+}
+
+/**
+ * Computes this * other. (private)
+ * Matrix * vector is a row by row dot product, Matrix * Matrix is blocked.
+ */
+Matrix Matrix::_multiply(const Matrix &other) const
+{
+    if (_cols != other._rows)
     {
-        for (int i = 0; i < matrix._rows; i++)
+        std::cerr << ERROR_MATRIX_DIMS << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    Matrix newMatrix(_rows, other._cols);
+
+    if (other._cols == DEFAULT_SIZE)
+    {
+        // Matrix * Vector.
+        for (int i = 0; i < newMatrix._rows; i++)
         {
-            os << ((matrix._vector[i] <= PRINT_THRESHOLD) ? NO_PIXEL : YES_PIXEL) << std::endl;
+            const float *row = _row(i);
+            float sum = 0.0f;
+            for (int k = 0; k < _cols; k++)
+            {
+                sum += row[k] * other._data[k];
+            }
+            newMatrix._data[i] = sum;
         }
+        return newMatrix;
     }
-    else
+
+    // Matrix * Matrix, blocked so a block of other stays in cache while it is reused.
+    for (int ii = 0; ii < newMatrix._rows; ii += GEMM_BLOCK_ROWS)
     {
-        for (int i = 0; i < matrix._rows; i++)
+        int iEnd = std::min(ii + GEMM_BLOCK_ROWS, newMatrix._rows);
+        for (int kk = 0; kk < _cols; kk += GEMM_BLOCK_DEPTH)
         {
-            float *row = matrix._matrix[i];
-            for (int j = 0; j < matrix._cols; j++)
+            int kEnd = std::min(kk + GEMM_BLOCK_DEPTH, _cols);
+            for (int jj = 0; jj < newMatrix._cols; jj += GEMM_BLOCK_COLS)
             {
-                os << ((row[j] <= PRINT_THRESHOLD) ? NO_PIXEL : YES_PIXEL);
+                int jEnd = std::min(jj + GEMM_BLOCK_COLS, newMatrix._cols);
+                for (int i = ii; i < iEnd; i++)
+                {
+                    const float *row = _row(i);
+                    float *newRow = newMatrix._row(i);
+                    for (int k = kk; k < kEnd; k++)
+                    {
+                        float value = row[k];
+                        const float *otherRow = other._row(k);
+                        for (int j = jj; j < jEnd; j++)
+                        {
+                            newRow[j] += value * otherRow[j];
+                        }
+                    }
+                }
             }
-            os << std::endl;
         }
     }
+    return newMatrix;
+}
+
+/**
+ * Matrix a,b; -> a += b
+ *
+ * @param other The other matrix.
+ * @return A reference to this Matrix after addition.
+ */
+Matrix &Matrix::operator+=(const Matrix &other)
+{
+    if (_cols != other._cols || _rows != other._rows)
+    {
+        std::cerr << ERROR_MATRIX_DIMS << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t i = 0; i < _size(); i++)
+    {
+        _data[i] += other._data[i];
+    }
+
+    return *this;
+}
+
+/**
+ * Pretty export of the matrix (an image, an element per pixel).
+ * Matrices are serialized by write() and read by operator>> (see BasicMatrix).
+ *
+ * @param os The output stream.
+ * @param matrix The matrix.
+ * @return A reference to the output stream.
+ */
+std::ostream &operator<<(std::ostream &os, const Matrix &matrix)
+{
+    for (int i = 0; i < matrix._rows; i++)
+    {
+        const float *row = matrix._row(i);
+        for (int j = 0; j < matrix._cols; j++)
+        {
+            os << ((row[j] <= PRINT_THRESHOLD) ? NO_PIXEL : YES_PIXEL);
+        }
+        os << std::endl;
+    }
 
     return os;
-}
\ No newline at end of file
+}
@@ -4,13 +4,18 @@
  * @version 1.0
  * @date 24 January 2020
  *
- * @brief Header file for the Matrix class which represents a 2D matrix or 1D vector.
+ * @brief Header file for the BasicMatrix class which represents a 2D matrix or 1D vector of any element type,
+ * and the Matrix class, the float matrix the network computes with.
  */
 
 #ifndef MATRIX_H
 #define MATRIX_H
 
+#include <cstddef>
 #include <iostream>
+#include "ElementType.h"
+#include "MatrixExpression.h"
+#include "MatrixView.h"
 
 /**
  * @struct MatrixDims
@@ -22,38 +27,56 @@ typedef struct MatrixDims
 } MatrixDims;
 
 /**
- * The Matrix class- represents a 2D matrix or 1D vector.
+ * The BasicMatrix class- represents a 2D matrix or 1D vector of elements of type T:
+ * float, double, BFloat16, int8_t, uint8_t or int32_t.
+ * Elements are stored contiguously row after row, in storage of the MatrixAllocator (see MatrixAllocator.h).
+ * An integer matrix is quantized: element i,j stands for the real value at(i, j) * getScale()
+ * (the scale of any other matrix is 1).
+ * Matrices are read (operator>>) and written (write()) along with their element type, so a
+ * matrix file of any type is read into a matrix of any other type.
  */
-class Matrix
+template<typename T>
+class BasicMatrix
 {
 public:
+    typedef T Element;
+    typedef typename ElementTraits<T>::Accumulator Accumulator;
+
     // Constructors.
     /**
-     * Constructs Matrix rows * cols.
+     * Constructs BasicMatrix rows * cols.
      * Inits all elements to 0.
      *
      * @param rows Number of rows the matrix will have.
-     * @param colsNumber of columns the matrix will have.
+     * @param cols Number of columns the matrix will have.
      */
-    Matrix(int rows, int cols);
+    BasicMatrix(int rows, int cols);
 
     /**
-     * Constructs 1*1 Matrix.
+     * Constructs 1*1 BasicMatrix.
      * Inits the single element to 0.
      */
-    Matrix();
+    BasicMatrix();
 
     /**
-     * Constructs Matrix from another Matrix m.
+     * Constructs BasicMatrix from another BasicMatrix m.
      *
-     * @param m The Matrix to copy.
+     * @param m The BasicMatrix to copy.
      */
-    Matrix(const Matrix &m);
+    BasicMatrix(const BasicMatrix &m);
+
+    /**
+     * Constructs BasicMatrix by taking over the memory of another BasicMatrix m,
+     * which is left as a 1*1 BasicMatrix.
+     *
+     * @param m The BasicMatrix to move.
+     */
+    BasicMatrix(BasicMatrix &&m) noexcept;
 
     /**
-     * Destroys the Matrix and frees the memory occupied by it.
+     * Destroys the BasicMatrix and frees the memory occupied by it.
      */
-    ~Matrix();
+    ~BasicMatrix();
 
     // Methods.
     /**
@@ -71,125 +94,396 @@ public:
     int getCols() const;
 
     /**
-     * Transforms a matrix into a column vector.
-     * Supports function calling concatenation.
-     * i.e.(1) Matrix m(5,4);... m.vectorize()
-     * m.getCols() == 1
-     * m.getRows() == 20
-     * i.e.(2) Matrix m(5,4), b(20, 1); then
-     * m.vectorize() + b should be a valid expression.
+     * Returns the real value of a unit of an element (1 unless quantized).
+     *
+     * @return The scale.
+     */
+    float getScale() const;
+
+    /**
+     * Sets the real value of a unit of an element.
+     *
+     * @param scale The scale.
      */
-    void vectorize();
+    void setScale(float scale);
 
     /**
-     * Prints matrix elements, no return value.
+     * Returns the elements, stored row after row.
+     *
+     * @return The elements of this BasicMatrix.
+     */
+    T *data();
+
+    /**
+     * Returns the elements, stored row after row.
+     *
+     * @return The elements of this BasicMatrix.
+     */
+    const T *data() const;
+
+    /**
+     * Prints matrix elements (their real values), no return value.
      * prints space after each element (incl. last element in the row).
      * prints newline after each row (incl. last row).
      */
     void plainPrint() const;
 
-    // Operators.
     /**
-     * Matrix copy constructor (Matrix a,b; ... a = b;)
+     * Converts a float matrix into this element type. Integer types are quantized symmetrically:
+     * the scale maps the largest magnitude to ElementTraits<T>::quantizedMax and every value is
+     * rounded to the nearest unit (uint8_t clamps negative values to 0).
      *
-     * @param other The matrix to copy.
-     * @return A reference to this Matrix after copying the other Matrix.
+     * @param matrix The float matrix.
+     * @return The converted matrix.
      */
-    Matrix &operator=(const Matrix &other);
+    static BasicMatrix quantize(const BasicMatrix<float> &matrix);
 
     /**
-     * Matrix a,b; -> a * b
+     * Returns the real values of the elements as a float matrix.
      *
-     * @param other The other matrix.
-     * @return A reference to the result as a Matrix.
+     * @return The float matrix.
      */
-    Matrix operator*(const Matrix &other) const;
+    BasicMatrix<float> dequantize() const;
 
     /**
-     *  Matrix m; float c; -> m * c
+     * Reads a matrix of this one's dimensions, written by write() (in any element type, converted
+     * to T through its real values unless it is T) or as raw float32 elements.
+     * Has to read input stream fully.
      *
-     * @param matrix A matrix.
-     * @param scalar A scalar (float).
-     * @return A reference to the result as a Matrix.
+     * @param is The input stream.
+     * @return false if the stream holds anything else (this is left unchanged).
      */
-    Matrix operator*(float scalar) const;
+    bool read(std::istream &is);
 
     /**
-     *  Matrix m; float c; -> c * m
+     * Writes the matrix in binary: a header (element type, dimensions and scale), then the elements.
      *
-     * @param matrix A matrix.
-     * @param scalar A scalar (float).
-     * @return A reference to the result as a Matrix.
+     * @param os The output stream.
      */
-    friend Matrix operator*(float scalar, const Matrix &matrix);
+    void write(std::ostream &os) const;
 
+    // Operators.
     /**
-     * Matrix a,b; -> a += b
+     * BasicMatrix copy assignment (BasicMatrix a,b; ... a = b;)
      *
-     * @param other The other matrix.
-     * @return A reference to this Matrix after addition.
+     * @param other The matrix to copy.
+     * @return A reference to this BasicMatrix after copying the other BasicMatrix.
      */
-    Matrix &operator+=(const Matrix &other);
+    BasicMatrix &operator=(const BasicMatrix &other);
 
     /**
-     * Matrix a,b; -> a + b
+     * BasicMatrix move assignment (BasicMatrix a; ... a = BasicMatrix(3, 4);)
      *
-     * @param other The other matrix.
-     * @return A reference to the result as a Matrix.
+     * @param other The matrix to move, left as a 1*1 BasicMatrix.
+     * @return A reference to this BasicMatrix after taking over the other BasicMatrix.
      */
-    Matrix operator+(const Matrix &other) const;
+    BasicMatrix &operator=(BasicMatrix &&other) noexcept;
 
     /**
-     * For i,j indices, Matrix m:
+     * For i,j indices, BasicMatrix m:
      * m(i,j) will return the i,j element.
      *
      * @param i The row index.
      * @param j The column index.
-     * @return The i,j element in this Matrix.
+     * @return The i,j element in this BasicMatrix.
      */
-    float operator()(int i, int j) const;
+    T operator()(int i, int j) const;
 
     /**
-     * For i,j indices, Matrix m:
+     * For i,j indices, BasicMatrix m:
      * m(i,j) will return the i,j element.
      *
      * @param i The row index.
      * @param j The column index.
-     * @return The i,j element in this Matrix.
+     * @return The i,j element in this BasicMatrix.
      */
-    float &operator()(int i, int j);
+    T &operator()(int i, int j);
 
     /**
-     * For i index, Matrix m:
+     * For i index, BasicMatrix m:
      * m[i] will return the i'th element.
      *
-     * @param i The index in the Matrix.
-     * @return The i'th element in this Matrix.
+     * @param i The index in the BasicMatrix.
+     * @return The i'th element in this BasicMatrix.
      */
-    float operator[](int i) const;
+    T operator[](int i) const;
 
     /**
-     * For i index, Matrix m:
+     * For i index, BasicMatrix m:
      * m[i] will return the i'th element.
      *
-     * @param i The index in the Matrix.
-     * @return The i'th element in this Matrix.
+     * @param i The index in the BasicMatrix.
+     * @return The i'th element in this BasicMatrix.
      */
-    float &operator[](int i);
+    T &operator[](int i);
 
     /**
-     * Fills matrix elements.
-     * Has to read input stream fully, otherwise, that's an error.
-     * istream is; Matrix m(rows, cols); ... is >> m;
+     * Returns the i,j element without bounds checks.
      *
-     * @param is The input stream.
-     * @param matrix The Matrix.
-     * @return A reference to the input stream.
+     * @param i The row index.
+     * @param j The column index.
+     * @return The i,j element in this BasicMatrix.
+     */
+    T at(int i, int j) const
+    {
+        return _data[(size_t) i * _cols + j];
+    }
+
+protected:
+    int _rows, _cols;
+    T *_data;
+    float _scale;
+
+    void _copyMatrix(const BasicMatrix &other); // Copies another matrix into this one.
+    void _reshape(int rows, int cols); // Reinterprets the elements, exits if their amount differs.
+    T &_accessCell(int i, int j) const; // Double index access.
+    T &_accessCell(int i) const; // Single index access.
+    // Returns the elements of a row.
+    T *_row(int i) const
+    {
+        return _data + (size_t) i * _cols;
+    }
+
+    // Returns the amount of elements.
+    size_t _size() const
+    {
+        return (size_t) _rows * _cols;
+    }
+};
+
+/**
+ * Fills matrix elements, from a stream written by write() or of raw float32 elements (see read()).
+ * Has to read input stream fully, otherwise, that's an error (exits, code == 1).
+ * istream is; BasicMatrix<T> m(rows, cols); ... is >> m;
+ *
+ * @param is The input stream.
+ * @param matrix The BasicMatrix.
+ * @return A reference to the input stream.
+ */
+template<typename T>
+std::istream &operator>>(std::istream &is, BasicMatrix<T> &matrix);
+
+/**
+ * Multiplies matrices of (possibly) different element types, accumulating in the accumulator of
+ * the pair (see ProductTraits): int8 x uint8 -> int32, int8 x int8 -> int32, uint8 x uint8 -> int32,
+ * bf16 x fp32 -> fp32, fp32 x fp32 -> fp32, and any type x fp64 -> fp64 (the double precision
+ * reference of BasicDense).
+ * The scale of the result is the product of the scales, so it dequantizes to the real product.
+ * Exits (code == 1) if a's columns aren't b's rows.
+ *
+ * @param a The left matrix (n * k).
+ * @param b The right matrix (k * m).
+ * @return The n * m product.
+ */
+template<typename A, typename B>
+BasicMatrix<typename ProductTraits<A, B>::Accumulator> multiply(const BasicMatrix<A> &a, const BasicMatrix<B> &b);
+
+/**
+ * The Matrix class- represents a 2D matrix or 1D vector of floats, a BasicMatrix<float>.
+ * Elements are stored contiguously row after row, so reshaping and slicing into
+ * MatrixViews never copies them. Storage comes from the MatrixAllocator (see MatrixAllocator.h).
+ * Arithmetic operators build lazy expressions (see MatrixExpression.h)
+ * which are evaluated when assigned to a Matrix.
+ */
+class Matrix : public BasicMatrix<float>, public MatrixExpression<Matrix>
+{
+public:
+    using BasicMatrix<float>::getRows;
+    using BasicMatrix<float>::getCols;
+    using BasicMatrix<float>::at;
+
+    // Constructors.
+    /**
+     * Constructs Matrix rows * cols.
+     * Inits all elements to 0.
+     *
+     * @param rows Number of rows the matrix will have.
+     * @param colsNumber of columns the matrix will have.
+     */
+    Matrix(int rows, int cols);
+
+    /**
+     * Constructs 1*1 Matrix.
+     * Inits the single element to 0.
+     */
+    Matrix();
+
+    /**
+     * Constructs Matrix from another Matrix m.
+     *
+     * @param m The Matrix to copy.
+     */
+    Matrix(const Matrix &m);
+
+    /**
+     * Constructs Matrix by taking over the memory of another Matrix m,
+     * which is left as a 1*1 Matrix.
+     *
+     * @param m The Matrix to move.
+     */
+    Matrix(Matrix &&m) noexcept;
+
+    /**
+     * Constructs Matrix by taking over the memory of a BasicMatrix<float> m (i.e. a dequantized matrix),
+     * which is left as a 1*1 BasicMatrix.
+     *
+     * @param m The BasicMatrix to move.
+     */
+    Matrix(BasicMatrix<float> &&m) noexcept;
+
+    /**
+     * Constructs Matrix by evaluating an expression in a single pass.
+     * Matrix m = a * x + b;
+     *
+     * @param expression The expression to evaluate.
+     */
+    template<typename E>
+    Matrix(const MatrixExpression<E> &expression);
+
+    /**
+     * Constructs Matrix from a plain product of two Matrices (a * b),
+     * which is computed by the blocked product instead of element by element.
+     *
+     * @param product The product to evaluate.
+     */
+    Matrix(const MatrixProduct<Matrix, Matrix> &product);
+
+    // Methods.
+    /**
+     * Transforms a matrix into a column vector.
+     * Supports function calling concatenation.
+     * i.e.(1) Matrix m(5,4);... m.vectorize()
+     * m.getCols() == 1
+     * m.getRows() == 20
+     * i.e.(2) Matrix m(5,4), b(20, 1); then
+     * m.vectorize() + b should be a valid expression.
+     * Elements are stored row after row, so nothing is copied.
+     *
+     * @return A reference to this Matrix after vectorizing it.
+     */
+    Matrix &vectorize();
+
+    /**
+     * Reinterprets the elements (row after row) as a rows * cols Matrix, without copying them.
+     * Exits (code == 1) if the amount of elements differs.
+     *
+     * @param rows The new amount of rows.
+     * @param cols The new amount of columns.
+     * @return A reference to this Matrix after reshaping it.
+     */
+    Matrix &reshape(int rows, int cols);
+
+    /**
+     * Returns a view of the whole Matrix.
+     * The view is valid until the Matrix is destroyed, reassigned or moved.
+     *
+     * @return A view of this Matrix.
+     */
+    MatrixView view() const;
+
+    /**
+     * Returns a view of count rows starting at row first (a single image of a batch: rowRange(i, 1)).
+     *
+     * @param first The first row of the view.
+     * @param count The amount of rows in the view.
+     * @return A view of the rows.
+     */
+    MatrixView rowRange(int first, int count) const;
+
+    /**
+     * Returns a view of count columns starting at column first.
+     *
+     * @param first The first column of the view.
+     * @param count The amount of columns in the view.
+     * @return A view of the columns.
+     */
+    MatrixView colRange(int first, int count) const;
+
+    /**
+     * Returns a view of the rows * cols block whose top left element is row, col.
+     *
+     * @param row The first row of the block.
+     * @param col The first column of the block.
+     * @param rows The amount of rows in the block.
+     * @param cols The amount of columns in the block.
+     * @return A view of the block.
+     */
+    MatrixView block(int row, int col, int rows, int cols) const;
+
+    /**
+     * Multiplies this Matrix by the transpose of another one.
+     * Matrix a(n, k), b(m, k); -> a.multiplyTransposed(b) is the n * m Matrix a * b^T.
+     * Used for batches which hold a sample in every row.
+     *
+     * @param other The Matrix whose transpose to multiply by.
+     * @return The result as a new Matrix.
+     */
+    Matrix multiplyTransposed(const Matrix &other) const;
+
+    /**
+     * Returns the transpose of this Matrix.
+     * Matrix m(n, k); -> m.transpose() is a k * n Matrix.
+     *
+     * @return The transpose as a new Matrix.
+     */
+    Matrix transpose() const;
+
+    /**
+     * Adds a column vector (with as many rows as this Matrix has columns) to every row.
+     * Matrix m(n, k), b(k, 1); -> m.addToEachRow(b)
+     *
+     * @param vector The vector to add.
+     * @return A reference to this Matrix after addition.
      */
-    friend std::istream &operator>>(std::istream &is, Matrix &matrix);
+    Matrix &addToEachRow(const Matrix &vector);
+
+    // Operators.
+    /**
+     * Matrix copy constructor (Matrix a,b; ... a = b;)
+     *
+     * @param other The matrix to copy.
+     * @return A reference to this Matrix after copying the other Matrix.
+     */
+    Matrix &operator=(const Matrix &other);
+
+    /**
+     * Matrix move assignment (Matrix a; ... a = Matrix(3, 4);)
+     *
+     * @param other The matrix to move, left as a 1*1 Matrix.
+     * @return A reference to this Matrix after taking over the other Matrix.
+     */
+    Matrix &operator=(Matrix &&other) noexcept;
 
     /**
-     * Pretty export of the matrix.
+     * Evaluates an expression into this Matrix (Matrix m; ... m = a * x + b;)
+     * Evaluates in place unless the expression reads across this Matrix (m = m * a).
+     *
+     * @param expression The expression to evaluate.
+     * @return A reference to this Matrix after the evaluation.
+     */
+    template<typename E>
+    Matrix &operator=(const MatrixExpression<E> &expression);
+
+    /**
+     * Evaluates a plain product of two Matrices (a * b) into this Matrix
+     * by the blocked product.
+     *
+     * @param product The product to evaluate.
+     * @return A reference to this Matrix after the evaluation.
+     */
+    Matrix &operator=(const MatrixProduct<Matrix, Matrix> &product);
+
+    /**
+     * Matrix a,b; -> a += b
+     *
+     * @param other The other matrix.
+     * @return A reference to this Matrix after addition.
+     */
+    Matrix &operator+=(const Matrix &other);
+
+    /**
+     * Pretty export of the matrix (an image, an element per pixel).
+     * Matrices are serialized by write() and read by operator>> (see BasicMatrix).
      *
      * @param os The output stream.
      * @param matrix The matrix.
@@ -197,12 +491,76 @@ public:
      */
     friend std::ostream &operator<<(std::ostream &os, const Matrix &matrix);
 
-private:
-    int _rows, _cols;
-    float **_matrix, *_vector;
+    // Expression leaf interface (see MatrixExpression.h), at() is BasicMatrix's.
+    /**
+     * A plain Matrix only ever reads its own elements.
+     *
+     * @return false.
+     */
+    bool readsAcross(const Matrix &) const
+    {
+        return false;
+    }
+
+    /**
+     * Returns whether this is the given Matrix.
+     *
+     * @param m The Matrix to compare with.
+     * @return true if this is m.
+     */
+    bool overlaps(const Matrix &m) const
+    {
+        return this == &m;
+    }
 
-    void _copyMatrix(const Matrix &other); // Copies another matrix into this one.
-    void _freeArrays(); // Frees the memory occupied by the arrays.
+private:
+    template<typename E>
+    void _assign(const MatrixExpression<E> &expression); // Evaluates into same sized storage.
+    Matrix _multiply(const Matrix &other) const; // Computes this * other (blocked).
 };
 
+/**
+ * Constructs Matrix by evaluating an expression in a single pass.
+ * Matrix m = a * x + b;
+ *
+ * @param expression The expression to evaluate.
+ */
+template<typename E>
+Matrix::Matrix(const MatrixExpression<E> &expression) : Matrix(expression.getRows(), expression.getCols())
+{
+    _assign(expression);
+}
+
+/**
+ * Evaluates an expression into this Matrix (Matrix m; ... m = a * x + b;)
+ * Evaluates in place unless the expression reads across this Matrix (m = m * a).
+ *
+ * @param expression The expression to evaluate.
+ * @return A reference to this Matrix after the evaluation.
+ */
+template<typename E>
+Matrix &Matrix::operator=(const MatrixExpression<E> &expression)
+{
+    if (expression.readsAcross(*this) || expression.getRows() != _rows || expression.getCols() != _cols)
+    {
+        return (*this = Matrix(expression));
+    }
+    _assign(expression);
+    return *this;
+}
+
+// Evaluates an expression into this Matrix, which already has its dimensions.
+template<typename E>
+void Matrix::_assign(const MatrixExpression<E> &expression)
+{
+    for (int i = 0; i < _rows; i++)
+    {
+        float *row = _row(i);
+        for (int j = 0; j < _cols; j++)
+        {
+            row[j] = expression.at(i, j);
+        }
+    }
+}
+
 #endif //MATRIX_H
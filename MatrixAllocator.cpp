@@ -0,0 +1,412 @@
+/**
+ * @file MatrixAllocator.cpp
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Implementation file for the allocator of Matrix storage: thread-local size-class free lists
+ * backed by aligned slabs, and arenas which release all their allocations at once.
+ */
+
+#define ERROR_OUT_OF_MEMORY "Error: Out of memory for Matrix storage."
+
+#define ALIGNMENT 64
+#define MIN_BLOCK_BYTES 128 // Header + 16 floats.
+#define CLASS_COUNT 14 // Blocks of 128 bytes .. 1 MB.
+#define SLAB_BYTES (1 << 18)
+#define HUGE_SLAB_BYTES (1 << 21) // A huge page.
+#define THREAD_CACHE_BYTES (1 << 20)
+
+#define SYSTEM_BLOCK 0
+#define POOL_BLOCK 1
+#define ARENA_BLOCK 2
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include "MatrixAllocator.h"
+#include "MemoryPlacement.h"
+
+// Precedes every block, padded to ALIGNMENT so the floats after it stay aligned.
+struct BlockHeader
+{
+    uint32_t origin;
+    uint32_t sizeClass;
+};
+
+// A released pool block, linked through its own (unused) memory.
+struct FreeBlock
+{
+    FreeBlock *next;
+};
+
+// Per thread state. Plain data, so it is usable at any point of the thread's life.
+struct ThreadCache
+{
+    FreeBlock *lists[CLASS_COUNT];
+    size_t counts[CLASS_COUNT];
+    MatrixArena *arena;
+    bool registered, exited;
+};
+
+// Blocks shared between threads, and the lock guarding them.
+struct Depot
+{
+    std::mutex lock;
+    FreeBlock *lists[CLASS_COUNT];
+};
+
+static thread_local ThreadCache threadCache;
+static std::atomic<int> allocationMode(PoolAllocation);
+
+// Returns the depot. Never destroyed, since Matrices may be released during static destruction.
+static Depot &_depot()
+{
+    static Depot *depot = new Depot();
+    return *depot;
+}
+
+// Returns size bytes aligned to ALIGNMENT, exits when out of memory.
+static void *_systemAllocate(size_t size)
+{
+    void *memory = aligned_alloc(ALIGNMENT, (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT);
+    if (memory == nullptr)
+    {
+        std::cerr << ERROR_OUT_OF_MEMORY << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    return memory;
+}
+
+// Returns the size of the blocks of a class.
+static size_t _blockBytes(int sizeClass)
+{
+    return (size_t) MIN_BLOCK_BYTES << sizeClass;
+}
+
+// Returns the smallest class holding size bytes (header included), or CLASS_COUNT if none does.
+static int _sizeClass(size_t size)
+{
+    int sizeClass = 0;
+    while (sizeClass < CLASS_COUNT && _blockBytes(sizeClass) < size)
+    {
+        sizeClass++;
+    }
+    return sizeClass;
+}
+
+// Returns how many blocks of a class a thread keeps before spilling into the depot.
+static size_t _cacheLimit(int sizeClass)
+{
+    return std::max((size_t) 2, THREAD_CACHE_BYTES / _blockBytes(sizeClass));
+}
+
+// Moves the blocks a thread keeps into the depot when the thread exits.
+struct CacheFlusher
+{
+    ~CacheFlusher()
+    {
+        Depot &depot = _depot();
+        std::lock_guard<std::mutex> guard(depot.lock);
+        for (int c = 0; c < CLASS_COUNT; c++)
+        {
+            while (threadCache.lists[c] != nullptr)
+            {
+                FreeBlock *block = threadCache.lists[c];
+                threadCache.lists[c] = block->next;
+                block->next = depot.lists[c];
+                depot.lists[c] = block;
+            }
+            threadCache.counts[c] = 0;
+        }
+        threadCache.exited = true;
+    }
+};
+
+// Refills a thread's list of a class from the depot, carving a new slab if the depot is empty.
+static void _refill(int sizeClass)
+{
+    if (!threadCache.registered)
+    {
+        threadCache.registered = true;
+        static thread_local CacheFlusher flusher;
+        (void) flusher;
+    }
+
+    Depot &depot = _depot();
+    std::lock_guard<std::mutex> guard(depot.lock);
+    size_t blockBytes = _blockBytes(sizeClass);
+    if (depot.lists[sizeClass] == nullptr)
+    {
+        // Huge page slabs are placed memory, which is never released (as slabs aren't).
+        bool hugePages = MemoryPlacement::getOptions().hugePages;
+        size_t slabBytes = std::max((size_t) (hugePages ? HUGE_SLAB_BYTES : SLAB_BYTES), blockBytes);
+        char *slab = (char *) (hugePages ? MemoryPlacement::allocate(slabBytes, ANY_NODE)
+                                         : _systemAllocate(slabBytes));
+        for (size_t offset = 0; offset + blockBytes <= slabBytes; offset += blockBytes)
+        {
+            auto *block = (FreeBlock *) (slab + offset);
+            block->next = depot.lists[sizeClass];
+            depot.lists[sizeClass] = block;
+        }
+    }
+
+    size_t batch = std::max((size_t) 1, _cacheLimit(sizeClass) / 2);
+    while (batch-- > 0 && depot.lists[sizeClass] != nullptr)
+    {
+        FreeBlock *block = depot.lists[sizeClass];
+        depot.lists[sizeClass] = block->next;
+        block->next = threadCache.lists[sizeClass];
+        threadCache.lists[sizeClass] = block;
+        threadCache.counts[sizeClass]++;
+    }
+}
+
+// Returns a block of a class from the thread's list.
+static void *_poolAllocate(int sizeClass)
+{
+    if (threadCache.lists[sizeClass] == nullptr)
+    {
+        _refill(sizeClass);
+    }
+    FreeBlock *block = threadCache.lists[sizeClass];
+    threadCache.lists[sizeClass] = block->next;
+    threadCache.counts[sizeClass]--;
+    return block;
+}
+
+// Puts a block back on the thread's list, spilling half of a full list into the depot.
+static void _poolRelease(void *memory, int sizeClass)
+{
+    auto *block = (FreeBlock *) memory;
+    if (threadCache.exited)
+    {
+        Depot &depot = _depot();
+        std::lock_guard<std::mutex> guard(depot.lock);
+        block->next = depot.lists[sizeClass];
+        depot.lists[sizeClass] = block;
+        return;
+    }
+
+    block->next = threadCache.lists[sizeClass];
+    threadCache.lists[sizeClass] = block;
+    if (++threadCache.counts[sizeClass] < _cacheLimit(sizeClass))
+    {
+        return;
+    }
+
+    size_t spill = threadCache.counts[sizeClass] / 2;
+    FreeBlock *first = threadCache.lists[sizeClass], *last = first;
+    for (size_t i = 1; i < spill; i++)
+    {
+        last = last->next;
+    }
+    threadCache.lists[sizeClass] = last->next;
+    threadCache.counts[sizeClass] -= spill;
+
+    Depot &depot = _depot();
+    std::lock_guard<std::mutex> guard(depot.lock);
+    last->next = depot.lists[sizeClass];
+    depot.lists[sizeClass] = first;
+}
+
+/**
+ * Returns storage for count floats, aligned to 64 bytes and not initialized.
+ * Exits (code == 1) if the system is out of memory.
+ *
+ * @param count The amount of floats (positive).
+ * @return The storage.
+ */
+float *MatrixAllocator::allocate(size_t count)
+{
+    size_t size = ALIGNMENT + count * sizeof(float);
+    BlockHeader *header;
+    if (threadCache.arena != nullptr)
+    {
+        header = (BlockHeader *) threadCache.arena->_allocate(size);
+        header->origin = ARENA_BLOCK;
+    }
+    else
+    {
+        int sizeClass = _sizeClass(size);
+        if (sizeClass == CLASS_COUNT || allocationMode.load(std::memory_order_relaxed) == SystemAllocation)
+        {
+            header = (BlockHeader *) _systemAllocate(size);
+            header->origin = SYSTEM_BLOCK;
+        }
+        else
+        {
+            header = (BlockHeader *) _poolAllocate(sizeClass);
+            header->origin = POOL_BLOCK;
+            header->sizeClass = (uint32_t) sizeClass;
+        }
+    }
+    return (float *) ((char *) header + ALIGNMENT);
+}
+
+/**
+ * Releases storage returned by allocate (nullptr is ignored).
+ * Storage from an arena is only reclaimed when the arena resets.
+ *
+ * @param data The storage to release.
+ */
+void MatrixAllocator::release(float *data)
+{
+    if (data == nullptr)
+    {
+        return;
+    }
+
+    auto *header = (BlockHeader *) ((char *) data - ALIGNMENT);
+    if (header->origin == POOL_BLOCK)
+    {
+        _poolRelease(header, (int) header->sizeClass);
+    }
+    else if (header->origin == SYSTEM_BLOCK)
+    {
+        free(header);
+    }
+}
+
+/**
+ * Chooses where following allocations come from (process wide).
+ *
+ * @param mode The new allocation mode.
+ */
+void MatrixAllocator::setMode(AllocationMode mode)
+{
+    allocationMode.store(mode);
+}
+
+/**
+ * Returns the current allocation mode.
+ *
+ * @return The current allocation mode.
+ */
+AllocationMode MatrixAllocator::getMode()
+{
+    return (AllocationMode) allocationMode.load();
+}
+
+/**
+ * Constructs an empty arena.
+ *
+ * @param chunkBytes The size of every chunk (larger requests get a chunk of their own).
+ */
+MatrixArena::MatrixArena(size_t chunkBytes) : _chunkBytes(chunkBytes), _placed(false), _node(ANY_NODE),
+                                               _current(0), _offset(0), _used(0)
+{}
+
+/**
+ * Constructs an empty arena for a NUMA node. While placement is configured (see MemoryPlacement)
+ * its chunks are placed memory: bound to the node, and huge page backed if the options ask for it.
+ * Otherwise it is a plain arena.
+ *
+ * @param chunkBytes The size of every chunk (larger requests get a chunk of their own).
+ * @param node The node of the chunks, ANY_NODE for the default policy.
+ */
+MatrixArena::MatrixArena(size_t chunkBytes, int node) : _chunkBytes(chunkBytes), _placed(MemoryPlacement::active()),
+                                                         _node(node), _current(0), _offset(0), _used(0)
+{}
+
+/**
+ * Destroys the arena and frees its chunks.
+ */
+MatrixArena::~MatrixArena()
+{
+    for (Chunk &chunk : _chunks)
+    {
+        if (_placed)
+        {
+            MemoryPlacement::release(chunk.memory);
+        }
+        else
+        {
+            free(chunk.memory);
+        }
+    }
+}
+
+/**
+ * Releases every allocation at once, keeping the chunks.
+ */
+void MatrixArena::reset()
+{
+    _current = 0;
+    _offset = 0;
+    _used = 0;
+}
+
+/**
+ * Returns the amount of bytes allocated since the last reset.
+ *
+ * @return The bytes in use.
+ */
+size_t MatrixArena::used() const
+{
+    return _used;
+}
+
+/**
+ * Returns the amount of bytes held in chunks.
+ *
+ * @return The bytes reserved.
+ */
+size_t MatrixArena::reserved() const
+{
+    size_t total = 0;
+    for (const Chunk &chunk : _chunks)
+    {
+        total += chunk.size;
+    }
+    return total;
+}
+
+// Bump allocates, moving on to the next chunk (or adding one) when the current one is full.
+void *MatrixArena::_allocate(size_t bytes)
+{
+    bytes = (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    while (_current < _chunks.size() && _chunks[_current].size - _offset < bytes)
+    {
+        _current++;
+        _offset = 0;
+    }
+    if (_current == _chunks.size())
+    {
+        size_t size = std::max(_chunkBytes, bytes);
+        void *chunk = _placed ? MemoryPlacement::allocate(size, _node) : _systemAllocate(size);
+        _chunks.push_back({(char *) chunk, size});
+    }
+
+    void *memory = _chunks[_current].memory + _offset;
+    _offset += bytes;
+    _used += bytes;
+    return memory;
+}
+
+/**
+ * Activates the arena on the current thread.
+ *
+ * @param arena The arena to allocate from.
+ * @param reset Whether to reset the arena when the scope ends.
+ */
+ArenaScope::ArenaScope(MatrixArena &arena, bool reset) : _arena(arena), _previous(threadCache.arena),
+                                                          _reset(reset)
+{
+    threadCache.arena = &arena;
+}
+
+/**
+ * Restores the previously active arena (if any) and resets this one (unless asked not to).
+ */
+ArenaScope::~ArenaScope()
+{
+    threadCache.arena = _previous;
+    if (_reset)
+    {
+        _arena.reset();
+    }
+}
@@ -0,0 +1,183 @@
+/**
+ * @file MatrixAllocator.h
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Header file for the allocator of Matrix storage: thread-local size-class free lists
+ * backed by aligned slabs, and arenas which release all their allocations at once.
+ */
+
+#ifndef MATRIXALLOCATOR_H
+#define MATRIXALLOCATOR_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @enum AllocationMode
+ * @brief Indicator of where new Matrix storage comes from.
+ */
+enum AllocationMode
+{
+    SystemAllocation,
+    PoolAllocation
+};
+
+/**
+ * The MatrixAllocator class- allocates the elements of every Matrix.
+ * In PoolAllocation mode (the default) sizes are rounded up to power of two size classes,
+ * and released blocks are kept on free lists of the releasing thread for the next allocation
+ * of their class. Lists that grow too long spill into a shared depot, which threads refill from
+ * before carving new blocks out of 64 byte aligned slabs. Slabs are never returned to the system.
+ * Blocks larger than the largest class, and every block in SystemAllocation mode,
+ * come straight from the system. Slabs are huge page backed when the PlacementOptions ask for it
+ * (see MemoryPlacement).
+ * While a MatrixArena is active on a thread (see ArenaScope) its allocations come from the arena.
+ * Every block remembers where it came from, so it may be released by any thread, in any mode.
+ */
+class MatrixAllocator
+{
+public:
+    /**
+     * Returns storage for count floats, aligned to 64 bytes and not initialized.
+     * Exits (code == 1) if the system is out of memory.
+     *
+     * @param count The amount of floats (positive).
+     * @return The storage.
+     */
+    static float *allocate(size_t count);
+
+    /**
+     * Releases storage returned by allocate (nullptr is ignored).
+     * Storage from an arena is only reclaimed when the arena resets.
+     *
+     * @param data The storage to release.
+     */
+    static void release(float *data);
+
+    /**
+     * Chooses where following allocations come from (process wide).
+     *
+     * @param mode The new allocation mode.
+     */
+    static void setMode(AllocationMode mode);
+
+    /**
+     * Returns the current allocation mode.
+     *
+     * @return The current allocation mode.
+     */
+    static AllocationMode getMode();
+};
+
+/**
+ * The MatrixArena class- bump allocates out of a few large chunks and releases everything at once
+ * when reset. Chunks are kept for the next round, so a steady workload stops allocating entirely.
+ * Made for the temporaries of a single request: every Matrix allocated from an arena
+ * must be destroyed before it resets. An arena is used by a single thread at a time.
+ */
+class MatrixArena
+{
+public:
+    // Constructors.
+    /**
+     * Constructs an empty arena.
+     *
+     * @param chunkBytes The size of every chunk (larger requests get a chunk of their own).
+     */
+    explicit MatrixArena(size_t chunkBytes = DEFAULT_CHUNK_BYTES);
+
+    /**
+     * Constructs an empty arena for a NUMA node. While placement is configured (see MemoryPlacement)
+     * its chunks are placed memory: bound to the node, and huge page backed if the options ask for it.
+     * Otherwise it is a plain arena.
+     *
+     * @param chunkBytes The size of every chunk (larger requests get a chunk of their own).
+     * @param node The node of the chunks, ANY_NODE for the default policy.
+     */
+    MatrixArena(size_t chunkBytes, int node);
+
+    MatrixArena(const MatrixArena &) = delete;
+
+    MatrixArena &operator=(const MatrixArena &) = delete;
+
+    /**
+     * Destroys the arena and frees its chunks.
+     */
+    ~MatrixArena();
+
+    // Methods.
+    /**
+     * Releases every allocation at once, keeping the chunks.
+     */
+    void reset();
+
+    /**
+     * Returns the amount of bytes allocated since the last reset.
+     *
+     * @return The bytes in use.
+     */
+    size_t used() const;
+
+    /**
+     * Returns the amount of bytes held in chunks.
+     *
+     * @return The bytes reserved.
+     */
+    size_t reserved() const;
+
+    static const size_t DEFAULT_CHUNK_BYTES = 1 << 20;
+
+private:
+    struct Chunk
+    {
+        char *memory;
+        size_t size;
+    };
+
+    const size_t _chunkBytes;
+    const bool _placed;
+    const int _node;
+    std::vector<Chunk> _chunks;
+    size_t _current, _offset, _used;
+
+    friend class MatrixAllocator;
+
+    void *_allocate(size_t bytes); // Bump allocates, adding a chunk when needed.
+};
+
+/**
+ * The ArenaScope class- makes an arena serve every Matrix allocation of the current thread
+ * while it is alive, and resets the arena when it ends. Scopes nest.
+ * {ArenaScope scope(arena); ... Digit d = mlp(img); } // All temporaries released here.
+ * A scope which doesn't reset builds long lived objects in the arena (such as a model replica
+ * in memory of its node), which then live until the arena is destroyed.
+ */
+class ArenaScope
+{
+public:
+    /**
+     * Activates the arena on the current thread.
+     *
+     * @param arena The arena to allocate from.
+     * @param reset Whether to reset the arena when the scope ends.
+     */
+    explicit ArenaScope(MatrixArena &arena, bool reset = true);
+
+    ArenaScope(const ArenaScope &) = delete;
+
+    ArenaScope &operator=(const ArenaScope &) = delete;
+
+    /**
+     * Restores the previously active arena (if any) and resets this one (unless asked not to).
+     */
+    ~ArenaScope();
+
+private:
+    MatrixArena &_arena;
+    MatrixArena *_previous;
+    const bool _reset;
+};
+
+#endif //MATRIXALLOCATOR_H
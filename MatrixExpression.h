@@ -0,0 +1,326 @@
+/**
+ * @file MatrixExpression.h
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Header file for the lazily evaluated Matrix arithmetic (expression templates).
+ *
+ * Matrix a, b, c; float s; ... a * b + c, s * a - b etc. build small expression objects
+ * instead of Matrices. They are evaluated element by element only when assigned to
+ * (or used to construct) a Matrix, so a whole chain runs as a single loop without
+ * temporary Matrices. The operands of a product are evaluated once beforehand
+ * if they are expressions themselves.
+ * Expressions reference their Matrix operands, so they must not outlive the statement.
+ * MatrixViews take part as leaves as well, so slices are multiplied without copying them.
+ */
+
+#ifndef MATRIXEXPRESSION_H
+#define MATRIXEXPRESSION_H
+
+class Matrix;
+class MatrixView;
+
+/**
+ * Prints the incompatible dimensions error and exits (code == 1).
+ */
+void matrixDimsError();
+
+/**
+ * The MatrixExpression class- the base of everything that evaluates to a Matrix (CRTP).
+ * E has to provide getRows(), getCols(), at(i, j) and readsAcross(m).
+ */
+template<typename E>
+class MatrixExpression
+{
+public:
+    /**
+     * Returns this expression as its actual type.
+     *
+     * @return This expression as its actual type.
+     */
+    const E &self() const
+    {
+        return static_cast<const E &>(*this);
+    }
+
+    /**
+     * Returns the amount of rows of the result.
+     *
+     * @return The amount of rows of the result.
+     */
+    int getRows() const
+    {
+        return self().getRows();
+    }
+
+    /**
+     * Returns the amount of columns of the result.
+     *
+     * @return The amount of columns of the result.
+     */
+    int getCols() const
+    {
+        return self().getCols();
+    }
+
+    /**
+     * Evaluates a single element of the result (no bounds checks).
+     *
+     * @param i The row index.
+     * @param j The column index.
+     * @return The i,j element of the result.
+     */
+    float at(int i, int j) const
+    {
+        return self().at(i, j);
+    }
+
+    /**
+     * Returns whether evaluating element i,j reads elements of m other than its own i,j,
+     * in which case the result can't be written into m while it is evaluated.
+     *
+     * @param m The Matrix the result is about to be written into.
+     * @return true if the result has to be evaluated elsewhere first.
+     */
+    bool readsAcross(const Matrix &m) const
+    {
+        return self().readsAcross(m);
+    }
+};
+
+// Leaf Matrices are held by reference, intermediate expressions by value.
+template<typename E>
+struct ExpressionOperand
+{
+    typedef const E Type;
+};
+
+template<>
+struct ExpressionOperand<Matrix>
+{
+    typedef const Matrix &Type;
+};
+
+// Product operands are read many times, so expressions are evaluated into a Matrix first.
+// Leaves (Matrix, MatrixView) provide overlaps(m) as well.
+template<typename E>
+struct ProductOperand
+{
+    typedef const Matrix Type;
+};
+
+template<>
+struct ProductOperand<Matrix>
+{
+    typedef const Matrix &Type;
+};
+
+template<>
+struct ProductOperand<MatrixView>
+{
+    typedef const MatrixView Type;
+};
+
+/**
+ * @struct AddOp
+ * @brief Element-wise addition.
+ */
+struct AddOp
+{
+    static float apply(float a, float b)
+    {
+        return a + b;
+    }
+};
+
+/**
+ * @struct SubtractOp
+ * @brief Element-wise subtraction.
+ */
+struct SubtractOp
+{
+    static float apply(float a, float b)
+    {
+        return a - b;
+    }
+};
+
+/**
+ * The MatrixElementwise class- an element-wise operation of two same sized expressions.
+ */
+template<typename L, typename R, typename Op>
+class MatrixElementwise : public MatrixExpression<MatrixElementwise<L, R, Op>>
+{
+public:
+    MatrixElementwise(const L &left, const R &right) : _left(left), _right(right)
+    {
+        if (left.getRows() != right.getRows() || left.getCols() != right.getCols())
+        {
+            matrixDimsError();
+        }
+    }
+
+    int getRows() const
+    {
+        return _left.getRows();
+    }
+
+    int getCols() const
+    {
+        return _left.getCols();
+    }
+
+    float at(int i, int j) const
+    {
+        return Op::apply(_left.at(i, j), _right.at(i, j));
+    }
+
+    bool readsAcross(const Matrix &m) const
+    {
+        return _left.readsAcross(m) || _right.readsAcross(m);
+    }
+
+private:
+    typename ExpressionOperand<L>::Type _left;
+    typename ExpressionOperand<R>::Type _right;
+};
+
+/**
+ * The MatrixScale class- an expression multiplied by a scalar.
+ */
+template<typename E>
+class MatrixScale : public MatrixExpression<MatrixScale<E>>
+{
+public:
+    MatrixScale(const E &expression, float scalar) : _expression(expression), _scalar(scalar)
+    {}
+
+    int getRows() const
+    {
+        return _expression.getRows();
+    }
+
+    int getCols() const
+    {
+        return _expression.getCols();
+    }
+
+    float at(int i, int j) const
+    {
+        return _expression.at(i, j) * _scalar;
+    }
+
+    bool readsAcross(const Matrix &m) const
+    {
+        return _expression.readsAcross(m);
+    }
+
+private:
+    typename ExpressionOperand<E>::Type _expression;
+    const float _scalar;
+};
+
+/**
+ * The MatrixProduct class- the Matrix product of two expressions.
+ * Every element is a dot product of a row of left and a column of right.
+ */
+template<typename L, typename R>
+class MatrixProduct : public MatrixExpression<MatrixProduct<L, R>>
+{
+public:
+    MatrixProduct(const L &left, const R &right) : _left(left), _right(right)
+    {
+        if (left.getCols() != right.getRows())
+        {
+            matrixDimsError();
+        }
+    }
+
+    int getRows() const
+    {
+        return _left.getRows();
+    }
+
+    int getCols() const
+    {
+        return _right.getCols();
+    }
+
+    float at(int i, int j) const
+    {
+        float sum = 0.0f;
+        for (int k = 0; k < _left.getCols(); k++)
+        {
+            sum += _left.at(i, k) * _right.at(k, j);
+        }
+        return sum;
+    }
+
+    bool readsAcross(const Matrix &m) const
+    {
+        return _left.overlaps(m) || _right.overlaps(m);
+    }
+
+    const Matrix &left() const
+    {
+        return _left;
+    }
+
+    const Matrix &right() const
+    {
+        return _right;
+    }
+
+private:
+    typename ProductOperand<L>::Type _left;
+    typename ProductOperand<R>::Type _right;
+};
+
+/**
+ * Expression a + b
+ */
+template<typename L, typename R>
+MatrixElementwise<L, R, AddOp> operator+(const MatrixExpression<L> &left, const MatrixExpression<R> &right)
+{
+    return MatrixElementwise<L, R, AddOp>(left.self(), right.self());
+}
+
+/**
+ * Expression a - b
+ */
+template<typename L, typename R>
+MatrixElementwise<L, R, SubtractOp> operator-(const MatrixExpression<L> &left,
+                                              const MatrixExpression<R> &right)
+{
+    return MatrixElementwise<L, R, SubtractOp>(left.self(), right.self());
+}
+
+/**
+ * Expression a * b (Matrix product)
+ */
+template<typename L, typename R>
+MatrixProduct<L, R> operator*(const MatrixExpression<L> &left, const MatrixExpression<R> &right)
+{
+    return MatrixProduct<L, R>(left.self(), right.self());
+}
+
+/**
+ * Expression m * c
+ */
+template<typename E>
+MatrixScale<E> operator*(const MatrixExpression<E> &expression, float scalar)
+{
+    return MatrixScale<E>(expression.self(), scalar);
+}
+
+/**
+ * Expression c * m
+ */
+template<typename E>
+MatrixScale<E> operator*(float scalar, const MatrixExpression<E> &expression)
+{
+    return MatrixScale<E>(expression.self(), scalar);
+}
+
+#endif //MATRIXEXPRESSION_H
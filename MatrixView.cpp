@@ -0,0 +1,127 @@
+/**
+ * @file MatrixView.cpp
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Implementation file for the MatrixView class, a non-owning read-only window into
+ * elements stored row after row.
+ */
+
+#define ERROR_BAD_VIEW "Error: Invalid Matrix view."
+#define ERROR_BAD_VIEW_INDEX "Error: Invalid index to access matrix view."
+
+#include <functional>
+#include <iostream>
+#include "Matrix.h"
+
+/**
+ * Constructs a view of rows * cols elements whose rows start stride elements apart.
+ * Exits (code == 1) if the dimensions are not positive or the stride is shorter than a row.
+ *
+ * @param data The first element.
+ * @param rows The amount of rows.
+ * @param cols The amount of columns.
+ * @param stride The distance between the starts of two following rows.
+ */
+MatrixView::MatrixView(const float *data, int rows, int cols, int stride) : _data(data), _rows(rows),
+                                                                            _cols(cols), _stride(stride)
+{
+    if (data == nullptr || rows <= 0 || cols <= 0 || stride < cols)
+    {
+        std::cerr << ERROR_BAD_VIEW << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * Reinterprets a contiguous view as rows * cols (MatrixView img; ... img.reshape(784, 1)).
+ * Exits (code == 1) if the view is not contiguous or the amount of elements differs.
+ *
+ * @param rows The new amount of rows.
+ * @param cols The new amount of columns.
+ * @return The reshaped view.
+ */
+MatrixView MatrixView::reshape(int rows, int cols) const
+{
+    if (!isContiguous() || rows <= 0 || cols <= 0 || (size_t) rows * cols != (size_t) _rows * _cols)
+    {
+        matrixDimsError();
+    }
+    return MatrixView(_data, rows, cols, cols);
+}
+
+/**
+ * Returns a view of count rows starting at row first.
+ *
+ * @param first The first row of the view.
+ * @param count The amount of rows in the view.
+ * @return A view of the rows.
+ */
+MatrixView MatrixView::rowRange(int first, int count) const
+{
+    return block(first, 0, count, _cols);
+}
+
+/**
+ * Returns a view of count columns starting at column first.
+ *
+ * @param first The first column of the view.
+ * @param count The amount of columns in the view.
+ * @return A view of the columns.
+ */
+MatrixView MatrixView::colRange(int first, int count) const
+{
+    return block(0, first, _rows, count);
+}
+
+/**
+ * Returns a view of the rows * cols block whose top left element is row, col.
+ *
+ * @param row The first row of the block.
+ * @param col The first column of the block.
+ * @param rows The amount of rows in the block.
+ * @param cols The amount of columns in the block.
+ * @return A view of the block.
+ */
+MatrixView MatrixView::block(int row, int col, int rows, int cols) const
+{
+    if (row < 0 || col < 0 || rows <= 0 || cols <= 0 || row + rows > _rows || col + cols > _cols)
+    {
+        std::cerr << ERROR_BAD_VIEW_INDEX << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    return MatrixView(_data + (size_t) row * _stride + col, rows, cols, _stride);
+}
+
+/**
+ * For i,j indices, MatrixView v:
+ * v(i,j) will return the i,j element.
+ *
+ * @param i The row index.
+ * @param j The column index.
+ * @return The i,j element in this view.
+ */
+float MatrixView::operator()(int i, int j) const
+{
+    if (i < 0 || j < 0 || i >= _rows || j >= _cols)
+    {
+        std::cerr << ERROR_BAD_VIEW_INDEX << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    return at(i, j);
+}
+
+/**
+ * Returns whether the view reads elements of the given Matrix.
+ *
+ * @param m The Matrix to compare with.
+ * @return true if the view reads elements of m.
+ */
+bool MatrixView::overlaps(const Matrix &m) const
+{
+    const float *first = m.data(), *end = first + (size_t) m.getRows() * m.getCols();
+    const float *last = _data + (size_t) (_rows - 1) * _stride + _cols;
+    // Unrelated arrays are only ordered by std::less.
+    return std::less<const float *>()(_data, end) && std::less<const float *>()(first, last);
+}
@@ -0,0 +1,176 @@
+/**
+ * @file MatrixView.h
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Header file for the MatrixView class, a non-owning read-only window into
+ * elements stored row after row (a whole Matrix, some of its rows / columns or a block).
+ */
+
+#ifndef MATRIXVIEW_H
+#define MATRIXVIEW_H
+
+#include <cstddef>
+#include "MatrixExpression.h"
+
+/**
+ * The MatrixView class- a rows * cols window whose rows start stride elements apart.
+ * Reshaping and slicing a view only changes these numbers, elements are never copied.
+ * A view does not own its elements, so it must not outlive the Matrix it was taken from.
+ * Usable anywhere an expression is (Matrix m = w * view + b;).
+ */
+class MatrixView : public MatrixExpression<MatrixView>
+{
+public:
+    // Constructors.
+    /**
+     * Constructs a view of rows * cols elements whose rows start stride elements apart.
+     * Exits (code == 1) if the dimensions are not positive or the stride is shorter than a row.
+     *
+     * @param data The first element.
+     * @param rows The amount of rows.
+     * @param cols The amount of columns.
+     * @param stride The distance between the starts of two following rows.
+     */
+    MatrixView(const float *data, int rows, int cols, int stride);
+
+    // Methods.
+    /**
+     * Returns the amount of rows as int.
+     *
+     * @return The amount of rows as int.
+     */
+    int getRows() const
+    {
+        return _rows;
+    }
+
+    /**
+     * Returns the amount of columns as int.
+     *
+     * @return The amount of columns as int.
+     */
+    int getCols() const
+    {
+        return _cols;
+    }
+
+    /**
+     * Returns the distance between the starts of two following rows.
+     *
+     * @return The stride of the view.
+     */
+    int getStride() const
+    {
+        return _stride;
+    }
+
+    /**
+     * Returns the first element.
+     *
+     * @return The first element of the view.
+     */
+    const float *data() const
+    {
+        return _data;
+    }
+
+    /**
+     * Returns whether the rows follow each other without gaps.
+     *
+     * @return true if the view is a single contiguous range.
+     */
+    bool isContiguous() const
+    {
+        return _stride == _cols || _rows == 1;
+    }
+
+    /**
+     * Reinterprets a contiguous view as rows * cols (MatrixView img; ... img.reshape(784, 1)).
+     * Exits (code == 1) if the view is not contiguous or the amount of elements differs.
+     *
+     * @param rows The new amount of rows.
+     * @param cols The new amount of columns.
+     * @return The reshaped view.
+     */
+    MatrixView reshape(int rows, int cols) const;
+
+    /**
+     * Returns a view of count rows starting at row first.
+     *
+     * @param first The first row of the view.
+     * @param count The amount of rows in the view.
+     * @return A view of the rows.
+     */
+    MatrixView rowRange(int first, int count) const;
+
+    /**
+     * Returns a view of count columns starting at column first.
+     *
+     * @param first The first column of the view.
+     * @param count The amount of columns in the view.
+     * @return A view of the columns.
+     */
+    MatrixView colRange(int first, int count) const;
+
+    /**
+     * Returns a view of the rows * cols block whose top left element is row, col.
+     *
+     * @param row The first row of the block.
+     * @param col The first column of the block.
+     * @param rows The amount of rows in the block.
+     * @param cols The amount of columns in the block.
+     * @return A view of the block.
+     */
+    MatrixView block(int row, int col, int rows, int cols) const;
+
+    // Operators.
+    /**
+     * For i,j indices, MatrixView v:
+     * v(i,j) will return the i,j element.
+     *
+     * @param i The row index.
+     * @param j The column index.
+     * @return The i,j element in this view.
+     */
+    float operator()(int i, int j) const;
+
+    // Expression leaf interface (see MatrixExpression.h).
+    /**
+     * Returns the i,j element without bounds checks.
+     *
+     * @param i The row index.
+     * @param j The column index.
+     * @return The i,j element in this view.
+     */
+    float at(int i, int j) const
+    {
+        return _data[(size_t) i * _stride + j];
+    }
+
+    /**
+     * A view may be shifted against m, so any overlap reads across it.
+     *
+     * @param m The Matrix the result is about to be written into.
+     * @return true if the view reads elements of m.
+     */
+    bool readsAcross(const Matrix &m) const
+    {
+        return overlaps(m);
+    }
+
+    /**
+     * Returns whether the view reads elements of the given Matrix.
+     *
+     * @param m The Matrix to compare with.
+     * @return true if the view reads elements of m.
+     */
+    bool overlaps(const Matrix &m) const;
+
+private:
+    const float *_data;
+    int _rows, _cols, _stride;
+};
+
+#endif //MATRIXVIEW_H
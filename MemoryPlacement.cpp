@@ -0,0 +1,434 @@
+/**
+ * @file MemoryPlacement.cpp
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Implementation file for the MemoryPlacement class which places model and workspace memory:
+ * huge pages, NUMA nodes and the cores workers are pinned to.
+ */
+
+#define ERROR_OUT_OF_MEMORY "Error: Out of memory for placed memory."
+#define NODES_PATH "/sys/devices/system/node/"
+#define NODE_PREFIX "node"
+#define CPU_LIST "/cpulist"
+#define SMAPS_ROLLUP "/proc/self/smaps_rollup"
+#define ANON_HUGE_PAGES "AnonHugePages:"
+
+#define HUGE_PAGE_BYTES (2 << 20)
+#define KB 1024
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <dirent.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#ifdef HAVE_LIBNUMA
+#include <numa.h>
+#endif
+#include "MemoryPlacement.h"
+
+/**
+ * A mapping of allocate(), remembered for release() and getStats().
+ */
+struct Region
+{
+    void *mapping; // Includes the alignment padding.
+    size_t mappingBytes;
+    size_t bytes;
+    int node;
+};
+
+/**
+ * The NUMA topology of the machine, read once.
+ */
+struct Topology
+{
+    std::vector<std::vector<int>> nodeCpus;
+    std::vector<int> cpuNodes; // By CPU, -1 for CPUs of no node.
+};
+
+static PlacementOptions placementOptions;
+static std::mutex regionsMutex;
+static std::map<void *, Region> regions; // By the memory returned.
+static PlacementStats placed; // Guarded by regionsMutex (the page counters are left 0).
+
+// Parses a sysfs CPU list ("0-3,8,10-11").
+static std::vector<int> _parseCpuList(const std::string &list)
+{
+    std::vector<int> cpus;
+    std::istringstream stream(list);
+    std::string range;
+    while (std::getline(stream, range, ','))
+    {
+        if (range.empty() || range[0] < '0' || range[0] > '9')
+        {
+            continue;
+        }
+        size_t dash = range.find('-');
+        int first = std::atoi(range.c_str());
+        int last = (dash == std::string::npos) ? first : std::atoi(range.c_str() + dash + 1);
+        for (int cpu = first; cpu <= last; cpu++)
+        {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+// Reads the topology: from libnuma if built in and usable, otherwise from sysfs, otherwise a single node.
+static Topology _readTopology()
+{
+    Topology topology;
+#ifdef HAVE_LIBNUMA
+    if (numa_available() >= 0)
+    {
+        struct bitmask *mask = numa_allocate_cpumask();
+        for (int node = 0; node <= numa_max_node(); node++)
+        {
+            std::vector<int> cpus;
+            if (numa_node_to_cpus(node, mask) == 0)
+            {
+                for (unsigned int cpu = 0; cpu < mask->size; cpu++)
+                {
+                    if (numa_bitmask_isbitset(mask, cpu))
+                    {
+                        cpus.push_back((int) cpu);
+                    }
+                }
+            }
+            topology.nodeCpus.push_back(cpus);
+        }
+        numa_free_cpumask(mask);
+    }
+#endif
+    if (topology.nodeCpus.empty())
+    {
+        std::vector<int> ids;
+        DIR *directory = opendir(NODES_PATH);
+        for (struct dirent *entry = directory ? readdir(directory) : nullptr; entry != nullptr;
+             entry = readdir(directory))
+        {
+            if (std::strncmp(entry->d_name, NODE_PREFIX, std::strlen(NODE_PREFIX)) == 0 &&
+                entry->d_name[std::strlen(NODE_PREFIX)] >= '0' && entry->d_name[std::strlen(NODE_PREFIX)] <= '9')
+            {
+                ids.push_back(std::atoi(entry->d_name + std::strlen(NODE_PREFIX)));
+            }
+        }
+        if (directory != nullptr)
+        {
+            closedir(directory);
+        }
+        std::sort(ids.begin(), ids.end());
+        for (int node = 0; !ids.empty() && node <= ids.back(); node++)
+        {
+            std::ifstream file(NODES_PATH NODE_PREFIX + std::to_string(node) + CPU_LIST);
+            std::string list;
+            std::getline(file, list);
+            topology.nodeCpus.push_back(_parseCpuList(list));
+        }
+    }
+    if (topology.nodeCpus.empty())
+    {
+        std::vector<int> cpus;
+        for (int cpu = 0; cpu < sysconf(_SC_NPROCESSORS_CONF); cpu++)
+        {
+            cpus.push_back(cpu);
+        }
+        topology.nodeCpus.push_back(cpus);
+    }
+
+    for (size_t node = 0; node < topology.nodeCpus.size(); node++)
+    {
+        for (int cpu : topology.nodeCpus[node])
+        {
+            if (cpu >= (int) topology.cpuNodes.size())
+            {
+                topology.cpuNodes.resize(cpu + 1, -1);
+            }
+            topology.cpuNodes[cpu] = (int) node;
+        }
+    }
+    return topology;
+}
+
+// Returns the topology. Never destroyed, since memory may be placed during static destruction.
+static const Topology &_topology()
+{
+    static const Topology *topology = new Topology(_readTopology());
+    return *topology;
+}
+
+// Pins the calling thread to the given CPUs.
+static bool _pin(const std::vector<int> &cpus)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus)
+    {
+        if (cpu < CPU_SETSIZE)
+        {
+            CPU_SET(cpu, &set);
+        }
+    }
+    return !cpus.empty() && sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+// Looks up the nodes the pages of a range reside on, counting those on node (and elsewhere).
+static void _countPages(void *memory, size_t bytes, int node, PlacementStats &stats)
+{
+    size_t pageBytes = (size_t) sysconf(_SC_PAGESIZE);
+    std::vector<void *> pages;
+    for (size_t offset = 0; offset < bytes; offset += pageBytes)
+    {
+        pages.push_back((char *) memory + offset);
+    }
+    std::vector<int> status(pages.size(), -1);
+#ifdef HAVE_LIBNUMA
+    long queried = numa_move_pages(0, pages.size(), pages.data(), nullptr, status.data(), 0);
+#else
+    long queried = syscall(SYS_move_pages, 0, pages.size(), pages.data(), nullptr, status.data(), 0);
+#endif
+    if (queried != 0)
+    {
+        return;
+    }
+    for (int pageNode : status)
+    {
+        if (pageNode == node)
+        {
+            stats.localPages++;
+        }
+        else if (pageNode >= 0)
+        {
+            stats.remotePages++;
+        }
+    }
+}
+
+/**
+ * Sets the options of the process, before any placed memory is allocated.
+ *
+ * @param options The options.
+ */
+void MemoryPlacement::configure(const PlacementOptions &options)
+{
+    placementOptions = options;
+}
+
+/**
+ * Returns the options of the process.
+ *
+ * @return The options.
+ */
+const PlacementOptions &MemoryPlacement::getOptions()
+{
+    return placementOptions;
+}
+
+/**
+ * Returns whether any placement option is set.
+ *
+ * @return true if memory is placed.
+ */
+bool MemoryPlacement::active()
+{
+    return placementOptions.hugePages || placementOptions.replicate || placementOptions.pin;
+}
+
+/**
+ * Returns the amount of NUMA nodes.
+ *
+ * @return The amount of nodes, 1 without NUMA.
+ */
+int MemoryPlacement::nodes()
+{
+    return (int) _topology().nodeCpus.size();
+}
+
+/**
+ * Returns the NUMA node of the CPU the calling thread runs on.
+ *
+ * @return The node, 0 if unknown.
+ */
+int MemoryPlacement::currentNode()
+{
+    const Topology &topology = _topology();
+    int cpu = sched_getcpu();
+    return (cpu >= 0 && cpu < (int) topology.cpuNodes.size()) ? std::max(topology.cpuNodes[cpu], 0) : 0;
+}
+
+/**
+ * Returns the CPUs of a NUMA node.
+ *
+ * @param node The node.
+ * @return Its CPUs.
+ */
+std::vector<int> MemoryPlacement::nodeCpus(int node)
+{
+    const Topology &topology = _topology();
+    return (node >= 0 && node < nodes()) ? topology.nodeCpus[node] : std::vector<int>();
+}
+
+/**
+ * Pins the calling thread (and the threads it starts later) to the CPUs of a NUMA node.
+ *
+ * @param node The node.
+ * @return false if the affinity couldn't be set.
+ */
+bool MemoryPlacement::pinToNode(int node)
+{
+    return _pin(nodeCpus(node));
+}
+
+/**
+ * Pins the calling thread (and the threads it starts later) to the core of the given worker:
+ * worker i runs on node i % nodes(), on the (i / nodes())'th CPU of the node (wrapping around).
+ *
+ * @param worker The index of the worker.
+ * @return false if the affinity couldn't be set.
+ */
+bool MemoryPlacement::pinWorker(int worker)
+{
+    std::vector<int> cpus = nodeCpus(worker % nodes());
+    return !cpus.empty() && _pin({cpus[(worker / nodes()) % cpus.size()]});
+}
+
+/**
+ * Maps bytes of memory (zero filled) as the options ask, bound to a node.
+ * Exits (code == 1) if the system is out of memory.
+ *
+ * @param bytes The amount of bytes.
+ * @param node The node, ANY_NODE for the default policy.
+ * @return The memory, aligned to a page.
+ */
+void *MemoryPlacement::allocate(size_t bytes, int node)
+{
+    const int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    size_t length = (bytes + HUGE_PAGE_BYTES - 1) / HUGE_PAGE_BYTES * HUGE_PAGE_BYTES;
+    Region region = {MAP_FAILED, 0, 0, node};
+    void *memory = MAP_FAILED;
+    bool hugeTlb = false;
+    if (placementOptions.hugePages)
+    {
+        memory = mmap(nullptr, length, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0);
+        hugeTlb = memory != MAP_FAILED;
+        region = {memory, length, length, node};
+    }
+    if (memory == MAP_FAILED && placementOptions.hugePages)
+    {
+        // Transparent huge pages only back whole aligned huge pages, so the range is aligned by hand.
+        void *mapping = mmap(nullptr, length + HUGE_PAGE_BYTES, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (mapping != MAP_FAILED)
+        {
+            memory = (void *) (((uintptr_t) mapping + HUGE_PAGE_BYTES - 1) / HUGE_PAGE_BYTES * HUGE_PAGE_BYTES);
+            madvise(memory, length, MADV_HUGEPAGE);
+            region = {mapping, length + HUGE_PAGE_BYTES, length, node};
+        }
+    }
+    else if (memory == MAP_FAILED)
+    {
+        length = (bytes + sysconf(_SC_PAGESIZE) - 1) / sysconf(_SC_PAGESIZE) * sysconf(_SC_PAGESIZE);
+        memory = mmap(nullptr, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+        region = {memory, length, length, node};
+    }
+    if (memory == MAP_FAILED)
+    {
+        std::cerr << ERROR_OUT_OF_MEMORY << std::endl;
+        exit(EXIT_FAILURE);
+    }
+#ifdef HAVE_LIBNUMA
+    if (node != ANY_NODE && nodes() > 1 && numa_available() >= 0)
+    {
+        numa_tonode_memory(memory, length, node);
+    }
+#endif
+
+    std::lock_guard<std::mutex> lock(regionsMutex);
+    regions[memory] = region;
+    size_t &counter = hugeTlb ? placed.hugeTlbBytes
+                              : (placementOptions.hugePages ? placed.transparentBytes : placed.smallPageBytes);
+    counter += length;
+    return memory;
+}
+
+/**
+ * Unmaps memory returned by allocate().
+ *
+ * @param memory The memory (nullptr is ignored).
+ */
+void MemoryPlacement::release(void *memory)
+{
+    if (memory == nullptr)
+    {
+        return;
+    }
+    Region region;
+    {
+        std::lock_guard<std::mutex> lock(regionsMutex);
+        std::map<void *, Region>::iterator found = regions.find(memory);
+        if (found == regions.end())
+        {
+            return;
+        }
+        region = found->second;
+        regions.erase(found);
+    }
+    munmap(region.mapping, region.mappingBytes);
+}
+
+/**
+ * Returns the counters of the memory placed so far. The pages of node bound memory are looked up
+ * now, so memory migrated since it was placed is counted where it resides.
+ *
+ * @return The counters.
+ */
+PlacementStats MemoryPlacement::getStats()
+{
+    std::lock_guard<std::mutex> lock(regionsMutex);
+    PlacementStats stats = placed;
+    for (std::pair<void *const, Region> &entry : regions)
+    {
+        if (entry.second.node != ANY_NODE)
+        {
+            _countPages(entry.first, entry.second.bytes, entry.second.node, stats);
+        }
+    }
+    return stats;
+}
+
+/**
+ * Prints the topology and the counters (and how much memory transparent huge pages back).
+ *
+ * @param os The output stream.
+ */
+void MemoryPlacement::printStats(std::ostream &os)
+{
+    PlacementStats stats = getStats();
+    os << "Placement: " << nodes() << " NUMA node(s)";
+#ifndef HAVE_LIBNUMA
+    os << " (without libnuma, first touch)";
+#endif
+    os << ", hugetlb: " << stats.hugeTlbBytes / KB << "KB, transparent huge page advised: "
+       << stats.transparentBytes / KB << "KB, small pages: " << stats.smallPageBytes / KB << "KB";
+
+    std::ifstream smaps(SMAPS_ROLLUP);
+    std::string line;
+    while (std::getline(smaps, line))
+    {
+        if (line.rfind(ANON_HUGE_PAGES, 0) == 0)
+        {
+            os << ", backed by transparent huge pages:" << line.substr(std::strlen(ANON_HUGE_PAGES));
+        }
+    }
+    os << ", node bound pages local: " << stats.localPages << ", remote: " << stats.remotePages << std::endl;
+}
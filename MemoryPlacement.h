@@ -0,0 +1,158 @@
+/**
+ * @file MemoryPlacement.h
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Header file for the MemoryPlacement class which places model and workspace memory:
+ * huge pages, NUMA nodes and the cores workers are pinned to.
+ */
+
+#ifndef MEMORYPLACEMENT_H
+#define MEMORYPLACEMENT_H
+
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+#define ANY_NODE (-1) // Memory placed by the kernel's default policy (first touch).
+
+/**
+ * @struct PlacementOptions
+ * @brief Where memory and workers go (process wide, see MemoryPlacement::configure()).
+ * @var hugePages - Back models, pool slabs and arena chunks with huge pages
+ * @var replicate - Keep a replica of every model on every NUMA node, inferences use their node's
+ * @var pin - Pin every prefork worker to a core, round robin over the NUMA nodes
+ */
+typedef struct PlacementOptions
+{
+    bool hugePages = false;
+    bool replicate = false;
+    bool pin = false;
+} PlacementOptions;
+
+/**
+ * @struct PlacementStats
+ * @brief Counters of the memory placed so far.
+ * @var hugeTlbBytes - Bytes mapped from the huge page pool (MAP_HUGETLB)
+ * @var transparentBytes - Bytes advised to be backed by transparent huge pages (no huge page pool)
+ * @var smallPageBytes - Bytes mapped with normal pages
+ * @var localPages - Pages of node bound memory which reside on their node
+ * @var remotePages - Pages of node bound memory which reside on another node
+ */
+typedef struct PlacementStats
+{
+    size_t hugeTlbBytes = 0;
+    size_t transparentBytes = 0;
+    size_t smallPageBytes = 0;
+    long localPages = 0;
+    long remotePages = 0;
+} PlacementStats;
+
+/**
+ * The MemoryPlacement class- maps memory and pins threads according to the PlacementOptions.
+ * Memory comes straight from mmap: from the huge page pool when asked for huge pages (falling back
+ * to transparent huge pages, advised over 2 MB aligned ranges, when the pool is empty), and bound
+ * to a NUMA node when one is given. The topology and the binding come from libnuma when it is built
+ * in (HAVE_LIBNUMA); without it the topology is read from sysfs and memory relies on first touch,
+ * which places it right as long as it is filled by a thread pinned to its node (as replicas are).
+ * A machine without NUMA is a single node 0 holding every CPU, so everything degrades to plain
+ * (huge page) mappings.
+ */
+class MemoryPlacement
+{
+public:
+    /**
+     * Sets the options of the process, before any placed memory is allocated.
+     *
+     * @param options The options.
+     */
+    static void configure(const PlacementOptions &options);
+
+    /**
+     * Returns the options of the process.
+     *
+     * @return The options.
+     */
+    static const PlacementOptions &getOptions();
+
+    /**
+     * Returns whether any placement option is set.
+     *
+     * @return true if memory is placed.
+     */
+    static bool active();
+
+    /**
+     * Returns the amount of NUMA nodes.
+     *
+     * @return The amount of nodes, 1 without NUMA.
+     */
+    static int nodes();
+
+    /**
+     * Returns the NUMA node of the CPU the calling thread runs on.
+     *
+     * @return The node, 0 if unknown.
+     */
+    static int currentNode();
+
+    /**
+     * Returns the CPUs of a NUMA node.
+     *
+     * @param node The node.
+     * @return Its CPUs.
+     */
+    static std::vector<int> nodeCpus(int node);
+
+    /**
+     * Pins the calling thread (and the threads it starts later) to the CPUs of a NUMA node.
+     *
+     * @param node The node.
+     * @return false if the affinity couldn't be set.
+     */
+    static bool pinToNode(int node);
+
+    /**
+     * Pins the calling thread (and the threads it starts later) to the core of the given worker:
+     * worker i runs on node i % nodes(), on the (i / nodes())'th CPU of the node (wrapping around).
+     *
+     * @param worker The index of the worker.
+     * @return false if the affinity couldn't be set.
+     */
+    static bool pinWorker(int worker);
+
+    /**
+     * Maps bytes of memory (zero filled) as the options ask, bound to a node.
+     * Exits (code == 1) if the system is out of memory.
+     *
+     * @param bytes The amount of bytes.
+     * @param node The node, ANY_NODE for the default policy.
+     * @return The memory, aligned to a page.
+     */
+    static void *allocate(size_t bytes, int node);
+
+    /**
+     * Unmaps memory returned by allocate().
+     *
+     * @param memory The memory (nullptr is ignored).
+     */
+    static void release(void *memory);
+
+    /**
+     * Returns the counters of the memory placed so far. The pages of node bound memory are looked up
+     * now, so memory migrated since it was placed is counted where it resides.
+     *
+     * @return The counters.
+     */
+    static PlacementStats getStats();
+
+    /**
+     * Prints the topology and the counters (and how much memory transparent huge pages back).
+     *
+     * @param os The output stream.
+     */
+    static void printStats(std::ostream &os);
+};
+
+#endif //MEMORYPLACEMENT_H
@@ -0,0 +1,177 @@
+/**
+ * @file MlpApi.cpp
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Implementation of the C interface of libmlp.so, which embeds the network in other programs:
+ * a model is loaded once into an opaque handle, and every thread predicts through a context of its own.
+ */
+
+#include <algorithm>
+#include <new>
+#include <string>
+#include <vector>
+#include "MlpApi.h"
+#include "ModelRegistry.h"
+#include "Protocol.h"
+
+static_assert(MLP_LAYERS == MLP_SIZE, "The C interface must have the network's amount of layers");
+static_assert(MLP_IMAGE_LENGTH == IMAGE_LENGTH, "The C interface must have the network's image length");
+
+/**
+ * A loaded model (without a cascade or a pack cache).
+ */
+struct mlp_model
+{
+    Model model;
+
+    explicit mlp_model(ModelParameters &&parameters) : model(std::move(parameters), ModelOptions(), 1)
+    {}
+};
+
+/**
+ * A model, and a workspace and results of maxBatch images.
+ */
+struct mlp_context
+{
+    const MlpNetwork &network;
+    const int maxBatch;
+    Matrix workspace;
+    std::vector<Digit> digits;
+
+    mlp_context(const MlpNetwork &mlp, int batch)
+            : network(mlp), maxBatch(batch), workspace(1, (int) mlp.workspaceLength(batch)), digits(batch)
+    {}
+};
+
+/**
+ * Returns the version of the interface the library implements (see MLP_API_VERSION).
+ *
+ * @return The interface version.
+ */
+int mlp_api_version(void)
+{
+    return MLP_API_VERSION;
+}
+
+/**
+ * Loads a model from the parameters files mlpnetwork takes.
+ *
+ * @param weights The weights file of every layer (raw weights or low rank factors).
+ * @param biases The biases file of every layer.
+ * @param model Output, the model (untouched upon failure).
+ * @return MLP_OK, MLP_ERROR_PARAMETERS, MLP_ERROR_ARGUMENT or MLP_ERROR_MEMORY.
+ */
+int mlp_model_load(const char *const weights[MLP_LAYERS], const char *const biases[MLP_LAYERS], mlp_model **model)
+{
+    if (weights == nullptr || biases == nullptr || model == nullptr ||
+        std::count(weights, weights + MLP_LAYERS, nullptr) + std::count(biases, biases + MLP_LAYERS, nullptr) > 0)
+    {
+        return MLP_ERROR_ARGUMENT;
+    }
+    try
+    {
+        std::vector<std::string> paths(weights, weights + MLP_LAYERS);
+        paths.insert(paths.end(), biases, biases + MLP_LAYERS);
+        ModelParameters parameters;
+        if (ModelRegistry::loadParameters(paths, parameters) != 0)
+        {
+            return MLP_ERROR_PARAMETERS;
+        }
+        *model = new mlp_model(std::move(parameters));
+        return MLP_OK;
+    }
+    catch (const std::bad_alloc &)
+    {
+        return MLP_ERROR_MEMORY;
+    }
+}
+
+/**
+ * Frees a model, after every context of it was freed. Does nothing given null.
+ *
+ * @param model The model.
+ */
+void mlp_model_free(mlp_model *model)
+{
+    delete model;
+}
+
+/**
+ * Creates a context which predicts with a model, up to max_batch images per run
+ * (larger batches are run max_batch images at a time).
+ *
+ * @param model The model, which must outlive the context.
+ * @param max_batch The amount of images the workspace of the context fits (at least 1).
+ * @param context Output, the context (untouched upon failure).
+ * @return MLP_OK, MLP_ERROR_ARGUMENT or MLP_ERROR_MEMORY.
+ */
+int mlp_context_create(const mlp_model *model, int max_batch, mlp_context **context)
+{
+    if (model == nullptr || max_batch < 1 || context == nullptr)
+    {
+        return MLP_ERROR_ARGUMENT;
+    }
+    try
+    {
+        *context = new mlp_context(model->model.getNetwork(), max_batch);
+        return MLP_OK;
+    }
+    catch (const std::bad_alloc &)
+    {
+        return MLP_ERROR_MEMORY;
+    }
+}
+
+/**
+ * Frees a context. Does nothing given null.
+ *
+ * @param context The context.
+ */
+void mlp_context_free(mlp_context *context)
+{
+    delete context;
+}
+
+/**
+ * Predicts the digit in an image.
+ *
+ * @param context The context of the calling thread.
+ * @param image MLP_IMAGE_LENGTH floats.
+ * @param result Output, the result.
+ * @return MLP_OK or MLP_ERROR_ARGUMENT.
+ */
+int mlp_predict(mlp_context *context, const float *image, mlp_result *result)
+{
+    return mlp_predict_batch(context, image, 1, result);
+}
+
+/**
+ * Predicts the digits in count images.
+ *
+ * @param context The context of the calling thread.
+ * @param images count images of MLP_IMAGE_LENGTH floats, one after the other.
+ * @param count The amount of images (0 or more).
+ * @param results Output, count results.
+ * @return MLP_OK or MLP_ERROR_ARGUMENT.
+ */
+int mlp_predict_batch(mlp_context *context, const float *images, int count, mlp_result *results)
+{
+    if (context == nullptr || count < 0 || (count > 0 && (images == nullptr || results == nullptr)))
+    {
+        return MLP_ERROR_ARGUMENT;
+    }
+    // Straight from the caller's images, through the context's workspace.
+    for (int first = 0; first < count; first += context->maxBatch)
+    {
+        int run = std::min(count - first, context->maxBatch);
+        context->network.predictBatch(images + (size_t) first * MLP_IMAGE_LENGTH, run, context->workspace.data(),
+                                      context->digits.data());
+        for (int i = 0; i < run; i++)
+        {
+            results[first + i] = {context->digits[i].value, context->digits[i].probability};
+        }
+    }
+    return MLP_OK;
+}
@@ -0,0 +1,124 @@
+/**
+ * @file MlpApi.h
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief The C interface of libmlp.so, which embeds the network in other programs: a model is loaded
+ * once into an opaque handle, and every thread predicts through a context of its own.
+ */
+
+#ifndef MLPAPI_H
+#define MLPAPI_H
+
+#if defined(__GNUC__)
+#define MLP_API __attribute__((visibility("default")))
+#else
+#define MLP_API
+#endif
+
+#define MLP_API_VERSION 1 // Changes only with incompatible changes of this interface.
+#define MLP_LAYERS 4
+#define MLP_IMAGE_LENGTH 784 // Floats of an image: 28 * 28 pixels, row after row, in [0, 1].
+
+// Status codes.
+#define MLP_OK 0
+#define MLP_ERROR_ARGUMENT (-1) // A null handle or buffer, or a count out of range.
+#define MLP_ERROR_PARAMETERS (-2) // A parameters file is unreadable or has improper dimensions.
+#define MLP_ERROR_MEMORY (-3)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A loaded model. Immutable: shared by any amount of contexts (and threads).
+ */
+typedef struct mlp_model mlp_model;
+
+/**
+ * A prediction context: a model and a workspace of its own. Used by a single thread at a time,
+ * predicting through it neither locks nor allocates.
+ */
+typedef struct mlp_context mlp_context;
+
+/**
+ * The result of a prediction.
+ * @var digit - The most likely digit
+ * @var probability - Its probability
+ */
+typedef struct mlp_result
+{
+    unsigned int digit;
+    float probability;
+} mlp_result;
+
+/**
+ * Returns the version of the interface the library implements (see MLP_API_VERSION).
+ *
+ * @return The interface version.
+ */
+MLP_API int mlp_api_version(void);
+
+/**
+ * Loads a model from the parameters files mlpnetwork takes.
+ *
+ * @param weights The weights file of every layer (raw weights or low rank factors).
+ * @param biases The biases file of every layer.
+ * @param model Output, the model (untouched upon failure).
+ * @return MLP_OK, MLP_ERROR_PARAMETERS, MLP_ERROR_ARGUMENT or MLP_ERROR_MEMORY.
+ */
+MLP_API int mlp_model_load(const char *const weights[MLP_LAYERS], const char *const biases[MLP_LAYERS],
+                           mlp_model **model);
+
+/**
+ * Frees a model, after every context of it was freed. Does nothing given null.
+ *
+ * @param model The model.
+ */
+MLP_API void mlp_model_free(mlp_model *model);
+
+/**
+ * Creates a context which predicts with a model, up to max_batch images per run
+ * (larger batches are run max_batch images at a time).
+ *
+ * @param model The model, which must outlive the context.
+ * @param max_batch The amount of images the workspace of the context fits (at least 1).
+ * @param context Output, the context (untouched upon failure).
+ * @return MLP_OK, MLP_ERROR_ARGUMENT or MLP_ERROR_MEMORY.
+ */
+MLP_API int mlp_context_create(const mlp_model *model, int max_batch, mlp_context **context);
+
+/**
+ * Frees a context. Does nothing given null.
+ *
+ * @param context The context.
+ */
+MLP_API void mlp_context_free(mlp_context *context);
+
+/**
+ * Predicts the digit in an image.
+ *
+ * @param context The context of the calling thread.
+ * @param image MLP_IMAGE_LENGTH floats.
+ * @param result Output, the result.
+ * @return MLP_OK or MLP_ERROR_ARGUMENT.
+ */
+MLP_API int mlp_predict(mlp_context *context, const float *image, mlp_result *result);
+
+/**
+ * Predicts the digits in count images.
+ *
+ * @param context The context of the calling thread.
+ * @param images count images of MLP_IMAGE_LENGTH floats, one after the other.
+ * @param count The amount of images (0 or more).
+ * @param results Output, count results.
+ * @return MLP_OK or MLP_ERROR_ARGUMENT.
+ */
+MLP_API int mlp_predict_batch(mlp_context *context, const float *images, int count, mlp_result *results);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //MLPAPI_H
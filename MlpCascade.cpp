@@ -0,0 +1,306 @@
+/**
+ * @file MlpCascade.cpp
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Implementation file for the MlpCascade class which runs a cheap first stage network on every
+ * image and escalates only the images it is unsure of to the full MlpNetwork.
+ */
+
+#define ERROR_BAD_CASCADE_DIMS "Error: You have given MlpCascade matrices with improper dimensions"
+
+#define POOL 2 // Pixels folded together along each axis by the first stage.
+#define FIRST_STAGE_STEP "first stage dense" // Trace name of a layer of the first stage (and its number).
+#define IS_MLP_VECTOR 1
+#define RESULT_LENGTH 10
+#define NS_PER_US 1000.0
+
+#include <chrono>
+#include <cstring>
+#include <vector>
+#include "MlpCascade.h"
+
+typedef std::chrono::steady_clock Clock;
+
+// Returns the nanoseconds passed since start.
+static long _nsSince(Clock::time_point start)
+{
+    return (long) std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+}
+
+// Folds the weights of the first layer over POOL * POOL pixel blocks (summed per block).
+static Matrix _foldWeights(const Matrix &weights)
+{
+    int pooledRows = imgDims.rows / POOL, pooledCols = imgDims.cols / POOL;
+    Matrix folded(weights.getRows(), pooledRows * pooledCols);
+    for (int row = 0; row < weights.getRows(); row++)
+    {
+        for (int pixel = 0; pixel < imgDims.rows * imgDims.cols; pixel++)
+        {
+            int block = (pixel / imgDims.cols / POOL) * pooledCols + (pixel % imgDims.cols / POOL);
+            folded(row, block) += weights.at(row, pixel);
+        }
+    }
+    return folded;
+}
+
+// Average pools an image over POOL * POOL pixel blocks.
+static void _poolImage(const float image[], float pooled[])
+{
+    int pooledCols = imgDims.cols / POOL;
+    for (int i = 0; i < (imgDims.rows / POOL) * pooledCols; i++)
+    {
+        pooled[i] = 0.0f;
+    }
+    for (int row = 0; row < imgDims.rows; row++)
+    {
+        float *pooledRow = pooled + (row / POOL) * pooledCols;
+        for (int col = 0; col < imgDims.cols; col++)
+        {
+            pooledRow[col / POOL] += image[row * imgDims.cols + col] * (1.0f / (POOL * POOL));
+        }
+    }
+}
+
+// Finds the most likely digit in the results (probabilities) of a sample, and its margin
+// over the second most likely one.
+static Digit _topTwo(const float result[], float &margin)
+{
+    Digit digit = {0, result[0]};
+    float second = 0.0f;
+    for (int i = 1; i < RESULT_LENGTH; i++)
+    {
+        if (result[i] > digit.probability)
+        {
+            second = digit.probability;
+            digit.value = i;
+            digit.probability = result[i];
+        }
+        else if (result[i] > second)
+        {
+            second = result[i];
+        }
+    }
+    margin = digit.probability - second;
+    return digit;
+}
+
+/**
+ * Constructs a cascade in front of the given network, which must outlive it.
+ *
+ * @param full The full network, run on escalated images.
+ * @param options When the first stage is trusted.
+ */
+MlpCascade::MlpCascade(const MlpNetwork &full, const CascadeOptions &options) : _full(full), _options(options),
+                                                                              _images(0), _escalated(0),
+                                                                              _firstNs(0), _fullNs(0)
+{
+    if (imgDims.rows % POOL != 0 || imgDims.cols % POOL != 0)
+    {
+        std::cerr << ERROR_BAD_CASCADE_DIMS << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    std::vector<PackedWeights> layers;
+    layers.emplace_back(_foldWeights(full.getWeights(0)), full.getBias(0));
+    for (int i = 1; i < MLP_SIZE; i++)
+    {
+        layers.emplace_back(full.getWeights(i), full.getBias(i));
+    }
+    std::vector<ActivationType> activations(MLP_SIZE, Relu);
+    activations.back() = Softmax;
+    std::vector<std::string> names;
+    for (int i = 0; i < MLP_SIZE; i++)
+    {
+        names.push_back(FIRST_STAGE_STEP + std::to_string(i + 1));
+    }
+    _plan = ExecutionPlan(layers, activations, names);
+}
+
+/**
+ * Applies the cascade on a view of the input.
+ *
+ * @param input The input view (784 * 1).
+ * @return Digit struct that represents the most likely digit in the image.
+ */
+Digit MlpCascade::operator()(const MatrixView &input) const
+{
+    if (input.getRows() != (imgDims.rows * imgDims.cols) || input.getCols() != IS_MLP_VECTOR)
+    {
+        std::cerr << ERROR_BAD_CASCADE_DIMS << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    Clock::time_point start = Clock::now();
+    Digit result;
+    float margin;
+    if (input.isContiguous())
+    {
+        _runFirst(input.data(), 1, &result, &margin);
+    }
+    else
+    {
+        _runFirst(Matrix(input).data(), 1, &result, &margin);
+    }
+    _firstNs += _nsSince(start);
+    _images++;
+
+    if (!isConfident(result, margin, _options))
+    {
+        start = Clock::now();
+        result = _full(input);
+        _fullNs += _nsSince(start);
+        _escalated++;
+    }
+    return result;
+}
+
+/**
+ * Applies the cascade on a batch of images. The first stage runs on the whole batch,
+ * the escalated images run through the full network together.
+ *
+ * @param batch The input batch, a vectorized image in every row.
+ * @param results Output array with a Digit per row of the batch.
+ */
+void MlpCascade::predictBatch(const Matrix &batch, Digit results[]) const
+{
+    predictBatch(batch.view(), results);
+}
+
+/**
+ * Applies the cascade on a view of a batch of images, in place when the view is contiguous.
+ *
+ * @param batch The view of the input batch, a vectorized image in every row.
+ * @param results Output array with a Digit per row of the batch.
+ */
+void MlpCascade::predictBatch(const MatrixView &batch, Digit results[]) const
+{
+    if (batch.getCols() != (imgDims.rows * imgDims.cols))
+    {
+        std::cerr << ERROR_BAD_CASCADE_DIMS << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (!batch.isContiguous())
+    {
+        predictBatch(Matrix(batch), results);
+        return;
+    }
+
+    Clock::time_point start = Clock::now();
+    int count = batch.getRows();
+    std::vector<float> margins(count);
+    _runFirst(batch.data(), count, results, margins.data());
+    std::vector<int> doubtful;
+    for (int i = 0; i < count; i++)
+    {
+        if (!isConfident(results[i], margins[i], _options))
+        {
+            doubtful.push_back(i);
+        }
+    }
+    _firstNs += _nsSince(start);
+    _images += count;
+    if (doubtful.empty())
+    {
+        return;
+    }
+
+    start = Clock::now();
+    Matrix hard((int) doubtful.size(), batch.getCols());
+    for (size_t i = 0; i < doubtful.size(); i++)
+    {
+        memcpy(hard.data() + i * batch.getCols(), batch.data() + (size_t) doubtful[i] * batch.getCols(),
+               batch.getCols() * sizeof(float));
+    }
+    std::vector<Digit> hardResults(doubtful.size());
+    _full.predictBatch(hard, hardResults.data());
+    for (size_t i = 0; i < doubtful.size(); i++)
+    {
+        results[doubtful[i]] = hardResults[i];
+    }
+    _fullNs += _nsSince(start);
+    _escalated += (long) doubtful.size();
+}
+
+/**
+ * Applies only the first stage on a batch of images (no statistics are kept).
+ *
+ * @param batch The input batch, a vectorized image in every row.
+ * @param results Output array with the first stage's Digit per row of the batch.
+ * @param margins Output array with the difference between the first stage's 2 most likely
+ *        probabilities per row of the batch.
+ */
+void MlpCascade::firstStage(const Matrix &batch, Digit results[], float margins[]) const
+{
+    if (batch.getCols() != (imgDims.rows * imgDims.cols))
+    {
+        std::cerr << ERROR_BAD_CASCADE_DIMS << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    _runFirst(batch.data(), batch.getRows(), results, margins);
+}
+
+/**
+ * Tells whether a first stage result is trusted, or escalated.
+ *
+ * @param digit The first stage's most likely digit.
+ * @param margin The difference between the first stage's 2 most likely probabilities.
+ * @param options When the first stage is trusted.
+ * @return true if the result is trusted.
+ */
+bool MlpCascade::isConfident(const Digit &digit, float margin, const CascadeOptions &options)
+{
+    return digit.probability >= options.threshold && margin >= options.margin;
+}
+
+/**
+ * Returns when the first stage is trusted.
+ *
+ * @return The options of the cascade.
+ */
+const CascadeOptions &MlpCascade::getOptions() const
+{
+    return _options;
+}
+
+/**
+ * Prints the amount of images, the fraction escalated and the mean time spent per image
+ * in every stage.
+ *
+ * @param os The output stream.
+ */
+void MlpCascade::printStats(std::ostream &os) const
+{
+    long images = _images, escalated = _escalated;
+    os << "Cascade images: " << images << ", escalated: " << escalated;
+    if (images > 0)
+    {
+        os << " (" << (100.0 * escalated / images) << "%)"
+           << ", mean first stage: " << _firstNs / NS_PER_US / images << "us";
+        if (escalated > 0)
+        {
+            os << ", mean full network (escalated only): " << _fullNs / NS_PER_US / escalated << "us";
+        }
+        os << ", mean total: " << (_firstNs + _fullNs) / NS_PER_US / images << "us";
+    }
+    os << std::endl;
+}
+
+// Pools count contiguous images and runs the first stage on them.
+void MlpCascade::_runFirst(const float images[], int count, Digit results[], float margins[]) const
+{
+    int imageLength = imgDims.rows * imgDims.cols;
+    Matrix pooled(count, _plan.getInputLength());
+    for (int i = 0; i < count; i++)
+    {
+        _poolImage(images + (size_t) i * imageLength, pooled.data() + (size_t) i * pooled.getCols());
+    }
+
+    Matrix workspace(1, (int) _plan.workspaceLength(count));
+    const float *result = _plan.run(pooled.data(), count, workspace.data());
+    for (int i = 0; i < count; i++)
+    {
+        results[i] = _topTwo(result + (size_t) i * RESULT_LENGTH, margins[i]);
+    }
+}
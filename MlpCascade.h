@@ -0,0 +1,126 @@
+/**
+ * @file MlpCascade.h
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Header file for the MlpCascade class which runs a cheap first stage network on every image
+ * and escalates only the images it is unsure of to the full MlpNetwork.
+ */
+
+#ifndef MLPCASCADE_H
+#define MLPCASCADE_H
+
+#include <atomic>
+#include <iostream>
+#include "Digit.h"
+#include "ExecutionPlan.h"
+#include "MlpNetwork.h"
+
+/**
+ * @struct CascadeOptions
+ * @brief When the first stage of a cascade is trusted.
+ * @var threshold - minimal probability of the first stage's most likely digit
+ * @var margin - minimal difference between the first stage's 2 most likely probabilities
+ */
+typedef struct CascadeOptions
+{
+    float threshold = 0.9f;
+    float margin = 0.0f;
+} CascadeOptions;
+
+/**
+ * The MlpCascade class- a two stage digit recognizer.
+ * The first stage is the full network with its first (by far the widest) layer folded over
+ * 2 * 2 pixel blocks: it sees the image average pooled into 14 * 14 pixels, through weights that
+ * are the sums of the original weights of every block. It costs about a third of the full network
+ * and needs no training. Images whose first stage result isn't confident enough (see CascadeOptions)
+ * are escalated to the full network, whose result replaces it.
+ * The cascade never changes after construction besides its statistics (atomic),
+ * so it is shared by any amount of threads.
+ */
+class MlpCascade
+{
+public:
+    // Constructors.
+    /**
+     * Constructs a cascade in front of the given network, which must outlive it.
+     *
+     * @param full The full network, run on escalated images.
+     * @param options When the first stage is trusted.
+     */
+    MlpCascade(const MlpNetwork &full, const CascadeOptions &options);
+
+    // Operators.
+    /**
+     * Applies the cascade on a view of the input.
+     *
+     * @param input The input view (784 * 1).
+     * @return Digit struct that represents the most likely digit in the image.
+     */
+    Digit operator()(const MatrixView &input) const;
+
+    // Methods.
+    /**
+     * Applies the cascade on a batch of images. The first stage runs on the whole batch,
+     * the escalated images run through the full network together.
+     *
+     * @param batch The input batch, a vectorized image in every row.
+     * @param results Output array with a Digit per row of the batch.
+     */
+    void predictBatch(const Matrix &batch, Digit results[]) const;
+
+    /**
+     * Applies the cascade on a view of a batch of images, in place when the view is contiguous.
+     *
+     * @param batch The view of the input batch, a vectorized image in every row.
+     * @param results Output array with a Digit per row of the batch.
+     */
+    void predictBatch(const MatrixView &batch, Digit results[]) const;
+
+    /**
+     * Applies only the first stage on a batch of images (no statistics are kept).
+     *
+     * @param batch The input batch, a vectorized image in every row.
+     * @param results Output array with the first stage's Digit per row of the batch.
+     * @param margins Output array with the difference between the first stage's 2 most likely
+     *        probabilities per row of the batch.
+     */
+    void firstStage(const Matrix &batch, Digit results[], float margins[]) const;
+
+    /**
+     * Tells whether a first stage result is trusted, or escalated.
+     *
+     * @param digit The first stage's most likely digit.
+     * @param margin The difference between the first stage's 2 most likely probabilities.
+     * @param options When the first stage is trusted.
+     * @return true if the result is trusted.
+     */
+    static bool isConfident(const Digit &digit, float margin, const CascadeOptions &options);
+
+    /**
+     * Returns when the first stage is trusted.
+     *
+     * @return The options of the cascade.
+     */
+    const CascadeOptions &getOptions() const;
+
+    /**
+     * Prints the amount of images, the fraction escalated and the mean time spent per image
+     * in every stage.
+     *
+     * @param os The output stream.
+     */
+    void printStats(std::ostream &os) const;
+
+private:
+    const MlpNetwork &_full;
+    CascadeOptions _options;
+    ExecutionPlan _plan; // The first stage.
+    mutable std::atomic<long> _images, _escalated, _firstNs, _fullNs;
+
+    // Runs the first stage on count contiguous images.
+    void _runFirst(const float images[], int count, Digit results[], float margins[]) const;
+};
+
+#endif //MLPCASCADE_H
@@ -9,22 +9,38 @@
  */
 
 #define ERROR_BAD_MLP_DIMS "Error: You have given MlpNetwork matrices with improper dimensions"
+#define WARNING_PACK_CACHE "Warning: Failed to write pack cache: "
+
+#define PACK_CACHE_MAGIC "MLPPACK2"
+#define PACK_CACHE_MAGIC_LENGTH 8
+#define PACK_CACHE_TEMPORARY ".tmp"
+#define MAX_STEP_NAME 256
 
 #define IS_MLP_VECTOR 1
 #define RESULT_LENGTH 10
+#define LAYER_SECTION "dense"
+#define INNER_FACTOR_SECTION ".v"
+#define OUTER_FACTOR_SECTION ".u"
 
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include "MlpNetwork.h"
 
 /**
  * Accepts 2 arrays, size 4 each.
  * One for weights and one for biases.
  * Constructs the network.
+ * Given factors, the factorized layers run as their factors (weights still holds the
+ * product of every layer's factors).
  *
  * @param weights
  * @param biases
+ * @param factors The factorized layers (nullptr for none).
  */
-MlpNetwork::MlpNetwork(const Matrix weights[MLP_SIZE], const Matrix biases[MLP_SIZE]) : _weights(
-        weights), _biases(biases)
+MlpNetwork::MlpNetwork(const Matrix weights[MLP_SIZE], const Matrix biases[MLP_SIZE],
+                       const LowRankFactors *factors)
+        : _weights(weights), _biases(biases), _profiler(nullptr)
 {
     for (int i = 0; i < MLP_SIZE; i++)
     {
@@ -37,8 +53,53 @@ MlpNetwork::MlpNetwork(const Matrix weights[MLP_SIZE], const Matrix biases[MLP_S
             exit(EXIT_FAILURE);
         }
     }
+
+    // The weights, bias and activation of every step, a factorized layer is 2 steps.
+    std::vector<const Matrix *> stepWeights, stepBiases;
+    std::vector<ActivationType> activations;
+    std::vector<Matrix> zeroBiases(MLP_SIZE);
+    for (int i = 0; i < MLP_SIZE; i++)
+    {
+        ActivationType activation = (i + 1 == MLP_SIZE) ? Softmax : Relu;
+        std::string name = LAYER_SECTION + std::to_string(i + 1);
+        if (factors == nullptr || factors->ranks[i] == 0)
+        {
+            stepWeights.push_back(&weights[i]);
+            stepBiases.push_back(&biases[i]);
+            activations.push_back(activation);
+            _stepNames.push_back(name);
+            continue;
+        }
+
+        LowRankDense layer(factors->u[i], factors->v[i], biases[i], activation);
+        if (layer.getRank() != factors->ranks[i] || layer.getU().getRows() != weights[i].getRows() ||
+            layer.getV().getCols() != weights[i].getCols())
+        {
+            std::cerr << ERROR_BAD_MLP_DIMS << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        zeroBiases[i] = Matrix(layer.getRank(), 1);
+        stepWeights.insert(stepWeights.end(), {&layer.getV(), &layer.getU()});
+        stepBiases.insert(stepBiases.end(), {&zeroBiases[i], &layer.getBias()});
+        activations.insert(activations.end(), {Identity, activation});
+        _stepNames.insert(_stepNames.end(), {name + INNER_FACTOR_SECTION, name + OUTER_FACTOR_SECTION});
+    }
+
+    std::vector<PackedWeights> layers(stepWeights.size());
+    for (size_t i = 0; i < layers.size(); i++)
+    {
+        layers[i] = PackedWeights(*stepWeights[i], *stepBiases[i]);
+    }
+    _plan = ExecutionPlan(layers, activations, _stepNames);
 }
 
+// Constructs the network of already packed steps (without weights and biases Matrices).
+MlpNetwork::MlpNetwork(const std::vector<PackedWeights> &layers, const std::vector<ActivationType> &activations,
+                       const std::vector<std::string> &names)
+        : _weights(nullptr), _biases(nullptr), _plan(layers, activations, names), _profiler(nullptr),
+          _stepNames(names)
+{}
+
 /**
  * Applies the entire network on the input.
  * Returns Digit struct.
@@ -48,6 +109,18 @@ MlpNetwork::MlpNetwork(const Matrix weights[MLP_SIZE], const Matrix biases[MLP_S
  * @return Digit struct that represents the most likely digit in the image.
  */
 Digit MlpNetwork::operator()(const Matrix &input) const
+{
+    return (*this)(input.view());
+}
+
+/**
+ * Applies the entire network on a view of the input, which is not copied.
+ * MlpNetwork m(...); Matrix img(28, 28); ... Digit output = m(img.view().reshape(784, 1));
+ *
+ * @param input The input view (784 * 1).
+ * @return Digit struct that represents the most likely digit in the image.
+ */
+Digit MlpNetwork::operator()(const MatrixView &input) const
 {
     if (input.getRows() != (imgDims.rows * imgDims.cols) || input.getCols() != IS_MLP_VECTOR)
     {
@@ -55,26 +128,265 @@ Digit MlpNetwork::operator()(const Matrix &input) const
         exit(EXIT_FAILURE);
     }
 
-    // Apply the layers.
-    Matrix result(Dense(_weights[0], _biases[0], Relu)(input));
-    for (int i = 1; i < (MLP_SIZE - 1); i++)
+    // Run the plan, on a copy of the input only if its rows aren't contiguous.
+    Matrix workspace(1, (int) _plan.workspaceLength(1));
+    const float *result;
+    if (input.isContiguous())
+    {
+        result = _plan.run(input.data(), 1, workspace.data(), _profiler, _stepSections.data());
+    }
+    else
+    {
+        result = _plan.run(Matrix(input).data(), 1, workspace.data(), _profiler, _stepSections.data());
+    }
+    if (_profiler != nullptr)
+    {
+        _profiler->addImages(1);
+    }
+
+    return mostLikely(result);
+}
+
+/**
+ * Returns the weights of a layer.
+ * Forbids modification.
+ *
+ * @param layer The index of the layer.
+ * @return The weights of the layer.
+ */
+const Matrix &MlpNetwork::getWeights(int layer) const
+{
+    return _weights[layer];
+}
+
+/**
+ * Returns the bias of a layer.
+ * Forbids modification.
+ *
+ * @param layer The index of the layer.
+ * @return The bias of the layer.
+ */
+const Matrix &MlpNetwork::getBias(int layer) const
+{
+    return _biases[layer];
+}
+
+/**
+ * Returns whether the network was constructed from its weights and biases (which getWeights() and
+ * getBias() return), rather than read from a pack cache.
+ *
+ * @return true if the network has its weights and biases.
+ */
+bool MlpNetwork::hasParameters() const
+{
+    return _weights != nullptr;
+}
+
+/**
+ * Applies the entire network on a batch of images.
+ * MlpNetwork m(...); Matrix batch(n, 784); Digit out[n]; ... m.predictBatch(batch, out);
+ *
+ * @param batch The input batch, a vectorized image in every row.
+ * @param results Output array with a Digit per row of the batch.
+ */
+void MlpNetwork::predictBatch(const Matrix &batch, Digit results[]) const
+{
+    predictBatch(batch.view(), results);
+}
+
+/**
+ * Applies the entire network on a view of a batch of images, in place when the view is contiguous
+ * (as images lying back to back in memory that isn't a Matrix, such as a shared ring).
+ *
+ * @param batch The view of the input batch, a vectorized image in every row.
+ * @param results Output array with a Digit per row of the batch.
+ */
+void MlpNetwork::predictBatch(const MatrixView &batch, Digit results[]) const
+{
+    if (batch.getCols() != (imgDims.rows * imgDims.cols))
+    {
+        std::cerr << ERROR_BAD_MLP_DIMS << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (!batch.isContiguous())
+    {
+        predictBatch(Matrix(batch), results);
+        return;
+    }
+
+    Matrix workspace(1, (int) _plan.workspaceLength(batch.getRows()));
+    predictBatch(batch.data(), batch.getRows(), workspace.data(), results);
+}
+
+/**
+ * Returns the amount of workspace floats a prediction over count images needs
+ * (see predictBatch(images, count, workspace, results)).
+ *
+ * @param count The amount of images.
+ * @return The workspace length.
+ */
+size_t MlpNetwork::workspaceLength(int count) const
+{
+    return _plan.workspaceLength(count);
+}
+
+/**
+ * Applies the entire network on count images in a caller-owned workspace, without allocating.
+ * Any amount of threads predict with the same network at once, each with a workspace of its own
+ * (unless it has a profiler, see setProfiler()).
+ *
+ * @param images count vectorized images, one after the other.
+ * @param count The amount of images.
+ * @param workspace At least workspaceLength(count) floats.
+ * @param results Output array with a Digit per image.
+ */
+void MlpNetwork::predictBatch(const float images[], int count, float workspace[], Digit results[]) const
+{
+    const float *result = _plan.run(images, count, workspace, _profiler, _stepSections.data());
+    if (_profiler != nullptr)
     {
-        Dense currentLayer(_weights[i], _biases[i], Relu);
-        result = currentLayer(result);
+        _profiler->addImages(count);
     }
-    result = Dense(_weights[3], _biases[3], Softmax)(result);
+    for (int i = 0; i < count; i++)
+    {
+        results[i] = mostLikely(result + (size_t) i * RESULT_LENGTH);
+    }
+}
+
+/**
+ * Attributes hardware counters of every following inference to a section per step
+ * (layer, or factor of a factorized layer) of the given profiler. nullptr turns profiling off.
+ * The profiler must outlive the network, which may be built on any thread, but must infer
+ * on the thread that created the profiler.
+ *
+ * @param profiler The profiler to report to (or nullptr).
+ */
+void MlpNetwork::setProfiler(PerfProfiler *profiler)
+{
+    _profiler = profiler;
+    if (profiler != nullptr)
+    {
+        _stepSections.clear();
+        for (const std::string &name : _stepNames)
+        {
+            _stepSections.push_back(profiler->addSection(name));
+        }
+    }
+}
+
+/**
+ * Returns the execution plan the network compiled itself into.
+ *
+ * @return The plan.
+ */
+const ExecutionPlan &MlpNetwork::getPlan() const
+{
+    return _plan;
+}
+
+/**
+ * Runs every following inference with another kernel configuration (see KernelTuner.h).
+ * Not thread safe, called before the network is shared.
+ * Exits (code == 1) if the configuration doesn't fit the plan.
+ *
+ * @param tuning The configuration.
+ */
+void MlpNetwork::setTuning(const PlanTuning &tuning)
+{
+    _plan = _plan.withTuning(tuning);
+}
 
-    // Find Most likely digit.
+/**
+ * Finds the most likely digit in the results (probabilities) of a sample.
+ *
+ * @param result The probability of every digit.
+ * @return The most likely digit and its probability.
+ */
+Digit MlpNetwork::mostLikely(const float result[])
+{
     Digit digit = {0, result[0]};
     for (int i = 1; i < RESULT_LENGTH; i++)
     {
-        float newProbability = result[i];
-        if (newProbability > digit.probability)
+        if (result[i] > digit.probability)
         {
             digit.value = i;
-            digit.probability = newProbability;
+            digit.probability = result[i];
         }
     }
     return digit;
 }
 
+/**
+ * Reads a network from a pack cache file (see writePackCache()): the packed steps are used
+ * as stored, so no parameters file is read and nothing is packed.
+ *
+ * @param path Path of the pack cache file.
+ * @param source The key of the parameters files the cache has to be written for.
+ * @return The network, nullptr if the file is missing, truncated or written for other files.
+ */
+std::unique_ptr<MlpNetwork> MlpNetwork::readPackCache(const std::string &path, uint64_t source)
+{
+    std::ifstream is(path, std::ios::in | std::ios::binary);
+    char magic[PACK_CACHE_MAGIC_LENGTH];
+    uint64_t storedSource;
+    int32_t steps;
+    if (!is.read(magic, PACK_CACHE_MAGIC_LENGTH) || memcmp(magic, PACK_CACHE_MAGIC, PACK_CACHE_MAGIC_LENGTH) != 0 ||
+        !is.read((char *) &storedSource, sizeof(storedSource)) || storedSource != source ||
+        !is.read((char *) &steps, sizeof(steps)) || steps < MLP_SIZE || steps > 2 * MLP_SIZE)
+    {
+        return nullptr;
+    }
+
+    std::vector<PackedWeights> layers(steps);
+    std::vector<ActivationType> activations(steps);
+    std::vector<std::string> names(steps);
+    for (int i = 0; i < steps; i++)
+    {
+        int32_t header[2]; // The activation and the length of the name.
+        char name[MAX_STEP_NAME];
+        if (!is.read((char *) header, sizeof(header)) || header[0] < Relu || header[0] > Identity ||
+            header[1] <= 0 || header[1] > MAX_STEP_NAME || !is.read(name, header[1]) || !layers[i].read(is) ||
+            (i > 0 && layers[i].getCols() != layers[i - 1].getRows()))
+        {
+            return nullptr;
+        }
+        activations[i] = (ActivationType) header[0];
+        names[i].assign(name, header[1]);
+    }
+    if (layers.front().getCols() != imgDims.rows * imgDims.cols || layers.back().getRows() != RESULT_LENGTH ||
+        activations.back() != Softmax)
+    {
+        return nullptr;
+    }
+    return std::unique_ptr<MlpNetwork>(new MlpNetwork(layers, activations, names));
+}
+
+/**
+ * Writes the packed steps of the network into a pack cache file, along with the key of the
+ * parameters files it was constructed from. Warns upon failure.
+ *
+ * @param path Path of the pack cache file (replaced at once, never left partially written).
+ * @param source The key of the parameters files.
+ */
+void MlpNetwork::writePackCache(const std::string &path, uint64_t source) const
+{
+    std::string temporary = path + PACK_CACHE_TEMPORARY;
+    std::ofstream os(temporary, std::ios::out | std::ios::binary | std::ios::trunc);
+    int32_t steps = _plan.getSteps();
+    os.write(PACK_CACHE_MAGIC, PACK_CACHE_MAGIC_LENGTH);
+    os.write((const char *) &source, sizeof(source));
+    os.write((const char *) &steps, sizeof(steps));
+    for (int i = 0; i < steps; i++)
+    {
+        int32_t header[] = {_plan.getActivation(i), (int32_t) _stepNames[i].size()};
+        os.write((const char *) header, sizeof(header));
+        os.write(_stepNames[i].data(), header[1]);
+        _plan.getLayer(i).write(os);
+    }
+    os.close();
+    if (!os || std::rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        std::cerr << WARNING_PACK_CACHE << path << std::endl;
+        std::remove(temporary.c_str());
+    }
+}
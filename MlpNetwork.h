@@ -11,9 +11,15 @@
 #ifndef MLPNETWORK_H
 #define MLPNETWORK_H
 
+#include <memory>
+#include <string>
+#include <vector>
 #include "Matrix.h"
 #include "Digit.h"
 #include "Dense.h"
+#include "ExecutionPlan.h"
+#include "LowRankDense.h"
+#include "PerfCounters.h"
 
 #define MLP_SIZE 4
 
@@ -27,8 +33,27 @@ const MatrixDims biasDims[] = {{128, 1},
                                {20,  1},
                                {10,  1}};
 
+/**
+ * @struct LowRankFactors
+ * @brief The layers of a network which are stored as low rank factors (see LowRankDense.h).
+ * @var u - The outer factor (rows * rank) of every factorized layer
+ * @var v - The inner factor (rank * cols) of every factorized layer
+ * @var ranks - The rank of every layer, 0 for a layer which isn't factorized
+ */
+typedef struct LowRankFactors
+{
+    Matrix u[MLP_SIZE];
+    Matrix v[MLP_SIZE];
+    int ranks[MLP_SIZE] = {};
+} LowRankFactors;
+
 /**
  * The MlpNetwork class- represents a multi-layered neural network for digit recognition in images.
+ * The network compiles itself once, at construction, into an immutable ExecutionPlan
+ * (weights repacked into the panel layout of the kernels, see PackedWeights.h),
+ * so inferences from any amount of threads only run the plan. A factorized layer is compiled
+ * into two steps, its inner factor V (Identity) and then its outer factor U with the layer's bias
+ * and activation.
  */
 class MlpNetwork
 {
@@ -38,11 +63,15 @@ public:
      * Accepts 2 arrays, size 4 each.
      * One for weights and one for biases.
      * Constructs the network.
+     * Given factors, the factorized layers run as their factors (weights still holds the
+     * product of every layer's factors).
      *
      * @param weights
      * @param biases
+     * @param factors The factorized layers (nullptr for none).
      */
-    MlpNetwork(const Matrix weights[MLP_SIZE], const Matrix biases[MLP_SIZE]);
+    MlpNetwork(const Matrix weights[MLP_SIZE], const Matrix biases[MLP_SIZE],
+               const LowRankFactors *factors = nullptr);
 
     // Operators.
     /**
@@ -55,8 +84,144 @@ public:
      */
     Digit operator()(const Matrix &input) const;
 
+    /**
+     * Applies the entire network on a view of the input, which is not copied.
+     * MlpNetwork m(...); Matrix img(28, 28); ... Digit output = m(img.view().reshape(784, 1));
+     *
+     * @param input The input view (784 * 1).
+     * @return Digit struct that represents the most likely digit in the image.
+     */
+    Digit operator()(const MatrixView &input) const;
+
+    // Methods.
+    /**
+     * Returns the weights of a layer.
+     * Forbids modification. A network read from a pack cache has none (see hasParameters()).
+     *
+     * @param layer The index of the layer.
+     * @return The weights of the layer.
+     */
+    const Matrix &getWeights(int layer) const;
+
+    /**
+     * Returns the bias of a layer.
+     * Forbids modification. A network read from a pack cache has none (see hasParameters()).
+     *
+     * @param layer The index of the layer.
+     * @return The bias of the layer.
+     */
+    const Matrix &getBias(int layer) const;
+
+    /**
+     * Returns whether the network was constructed from its weights and biases (which getWeights() and
+     * getBias() return), rather than read from a pack cache.
+     *
+     * @return true if the network has its weights and biases.
+     */
+    bool hasParameters() const;
+
+    /**
+     * Applies the entire network on a batch of images.
+     * MlpNetwork m(...); Matrix batch(n, 784); Digit out[n]; ... m.predictBatch(batch, out);
+     *
+     * @param batch The input batch, a vectorized image in every row.
+     * @param results Output array with a Digit per row of the batch.
+     */
+    void predictBatch(const Matrix &batch, Digit results[]) const;
+
+    /**
+     * Applies the entire network on a view of a batch of images, in place when the view is contiguous
+     * (as images lying back to back in memory that isn't a Matrix, such as a shared ring).
+     *
+     * @param batch The view of the input batch, a vectorized image in every row.
+     * @param results Output array with a Digit per row of the batch.
+     */
+    void predictBatch(const MatrixView &batch, Digit results[]) const;
+
+    /**
+     * Returns the amount of workspace floats a prediction over count images needs
+     * (see predictBatch(images, count, workspace, results)).
+     *
+     * @param count The amount of images.
+     * @return The workspace length.
+     */
+    size_t workspaceLength(int count) const;
+
+    /**
+     * Applies the entire network on count images in a caller-owned workspace, without allocating.
+     * Any amount of threads predict with the same network at once, each with a workspace of its own
+     * (unless it has a profiler, see setProfiler()).
+     *
+     * @param images count vectorized images, one after the other.
+     * @param count The amount of images.
+     * @param workspace At least workspaceLength(count) floats.
+     * @param results Output array with a Digit per image.
+     */
+    void predictBatch(const float images[], int count, float workspace[], Digit results[]) const;
+
+    /**
+     * Attributes hardware counters of every following inference to a section per step
+     * (layer, or factor of a factorized layer) of the given profiler. nullptr turns profiling off.
+     * The profiler must outlive the network, which may be built on any thread, but must infer
+     * on the thread that created the profiler.
+     *
+     * @param profiler The profiler to report to (or nullptr).
+     */
+    void setProfiler(PerfProfiler *profiler);
+
+    /**
+     * Returns the execution plan the network compiled itself into.
+     *
+     * @return The plan.
+     */
+    const ExecutionPlan &getPlan() const;
+
+    /**
+     * Runs every following inference with another kernel configuration (see KernelTuner.h).
+     * Not thread safe, called before the network is shared.
+     * Exits (code == 1) if the configuration doesn't fit the plan.
+     *
+     * @param tuning The configuration.
+     */
+    void setTuning(const PlanTuning &tuning);
+
+    /**
+     * Finds the most likely digit in the results (probabilities) of a sample.
+     *
+     * @param result The probability of every digit.
+     * @return The most likely digit and its probability.
+     */
+    static Digit mostLikely(const float result[]);
+
+    /**
+     * Reads a network from a pack cache file (see writePackCache()): the packed steps are used
+     * as stored, so no parameters file is read and nothing is packed.
+     *
+     * @param path Path of the pack cache file.
+     * @param source The key of the parameters files the cache has to be written for.
+     * @return The network, nullptr if the file is missing, truncated or written for other files.
+     */
+    static std::unique_ptr<MlpNetwork> readPackCache(const std::string &path, uint64_t source);
+
+    /**
+     * Writes the packed steps of the network into a pack cache file, along with the key of the
+     * parameters files it was constructed from. Warns upon failure.
+     *
+     * @param path Path of the pack cache file (replaced at once, never left partially written).
+     * @param source The key of the parameters files.
+     */
+    void writePackCache(const std::string &path, uint64_t source) const;
+
 private:
     const Matrix *_weights, *_biases;
+    ExecutionPlan _plan;
+    PerfProfiler *_profiler;
+    std::vector<std::string> _stepNames; // The profiler section name of every step of the plan.
+    std::vector<int> _stepSections;
+
+    // Constructs the network of already packed steps (without weights and biases Matrices).
+    MlpNetwork(const std::vector<PackedWeights> &layers, const std::vector<ActivationType> &activations,
+               const std::vector<std::string> &names);
 };
 
 #endif // MLPNETWORK_H
@@ -0,0 +1,549 @@
+/**
+ * @file ModelRegistry.cpp
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Implementation file for the Model and ModelRegistry classes which load networks and publish
+ * the current one, so it is replaced (hot swapped) without stopping inference.
+ */
+
+#define ERROR_INAVLID_PARAMETER "Error: invalid Parameters file for layer: "
+#define ERROR_BAD_PATHS "Error: A model needs a weights and a biases file for every layer."
+#define RELOADED "Reloaded model version: "
+#define RELOAD_FAILED "Reload failed, still serving model version: "
+
+#define RELOAD_POLL_MS 100
+#define REPLICA_CHUNK_BYTES (1 << 21) // A huge page.
+#define FNV_OFFSET 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <fstream>
+#include <sys/stat.h>
+#include "KernelTuner.h"
+#include "MemoryPlacement.h"
+#include "ModelRegistry.h"
+
+static volatile sig_atomic_t reloadRequested = 0;
+
+// Signal handler which requests a reload.
+static void _requestReload(int)
+{
+    reloadRequested = 1;
+}
+
+/**
+ * Given a binary file path and a matrix,
+ * reads the content of the file into the matrix.
+ * file must match matrix in size in order to read successfully, either raw float32 elements
+ * or a matrix written by BasicMatrix::write() of any element type (bf16, int8.. layers are
+ * dequantized, the network computes in float).
+ * @param filePath - path of the binary file to read
+ * @param mat -  matrix to read the file into.
+ * @return boolean status
+ *          true - success
+ *          false - failure
+ */
+static bool _readFileToMatrix(const std::string &filePath, Matrix &mat)
+{
+    std::ifstream is;
+    is.open(filePath, std::ios::in | std::ios::binary);
+    if (!is.is_open())
+    {
+        return false;
+    }
+
+    bool read = mat.read(is);
+    is.close();
+    return read;
+}
+
+// Mixes the given bytes into an FNV-1a hash.
+static uint64_t _mix(uint64_t hash, const void *bytes, size_t length)
+{
+    const unsigned char *data = (const unsigned char *) bytes;
+    for (size_t i = 0; i < length; i++)
+    {
+        hash = (hash ^ data[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+/**
+ * Returns a key of the parameters files which changes whenever one of them is replaced or modified
+ * (hashes their paths, devices, inodes, sizes and modification times), without reading them.
+ *
+ * @param paths The parameters files.
+ * @return The key, 0 if a file is missing.
+ */
+static uint64_t _sourceKey(const std::vector<std::string> &paths)
+{
+    uint64_t key = FNV_OFFSET;
+    for (const std::string &path : paths)
+    {
+        struct stat status = {};
+        if (stat(path.c_str(), &status) != 0)
+        {
+            return 0;
+        }
+        uint64_t fields[] = {(uint64_t) status.st_dev, (uint64_t) status.st_ino, (uint64_t) status.st_size,
+                             (uint64_t) status.st_mtim.tv_sec, (uint64_t) status.st_mtim.tv_nsec};
+        key = _mix(key, path.c_str(), path.size() + 1);
+        key = _mix(key, fields, sizeof(fields));
+    }
+    return key == 0 ? 1 : key;
+}
+
+/**
+ * Builds a model out of the given parameters (which it takes over).
+ *
+ * @param parameters The weights and biases of every layer.
+ * @param options How the model is built.
+ * @param version The version of the model.
+ */
+Model::Model(ModelParameters &&parameters, const ModelOptions &options, long version)
+        : _parameters(std::move(parameters)),
+          _network(_parameters.weights, _parameters.biases, &_parameters.factors),
+          _version(version), _tuned(false)
+{
+    _configure(options);
+}
+
+/**
+ * Builds a model out of a network read from a pack cache (which it takes over), it has no parameters.
+ * A cascade needs the parameters, so options.cascade has to be off.
+ *
+ * @param network The network.
+ * @param options How the model is built.
+ * @param version The version of the model.
+ */
+Model::Model(MlpNetwork &&network, const ModelOptions &options, long version)
+        : _network(std::move(network)), _version(version), _tuned(false)
+{
+    _configure(options);
+}
+
+// Tunes and profiles the network, builds the cascade.
+void Model::_configure(const ModelOptions &options)
+{
+    PlanTuning tuning;
+    if (!options.tuningFile.empty() && KernelTuner::load(options.tuningFile, _network.getPlan(), tuning))
+    {
+        _network.setTuning(tuning);
+        _tuned = true;
+    }
+    _network.setProfiler(options.profiler);
+    if (options.cascade)
+    {
+        _cascade.reset(new MlpCascade(_network, options.cascadeOptions));
+    }
+}
+
+/**
+ * Applies the model (through its cascade if it has one) on a view of the input.
+ *
+ * @param input The input view (784 * 1).
+ * @return Digit struct that represents the most likely digit in the image.
+ */
+Digit Model::operator()(const MatrixView &input) const
+{
+    return _cascade ? (*_cascade)(input) : _network(input);
+}
+
+/**
+ * Applies the model (through its cascade if it has one) on a batch of images.
+ *
+ * @param batch The input batch, a vectorized image in every row.
+ * @param results Output array with a Digit per row of the batch.
+ */
+void Model::predictBatch(const Matrix &batch, Digit results[]) const
+{
+    predictBatch(batch.view(), results);
+}
+
+/**
+ * Applies the model (through its cascade if it has one) on a view of a batch of images,
+ * in place when the view is contiguous.
+ *
+ * @param batch The view of the input batch, a vectorized image in every row.
+ * @param results Output array with a Digit per row of the batch.
+ */
+void Model::predictBatch(const MatrixView &batch, Digit results[]) const
+{
+    if (_cascade)
+    {
+        _cascade->predictBatch(batch, results);
+    }
+    else
+    {
+        _network.predictBatch(batch, results);
+    }
+}
+
+/**
+ * Attributes hardware counters of every following inference of the network to the given profiler
+ * (see MlpNetwork::setProfiler()), overriding options.profiler.
+ *
+ * @param profiler The profiler to report to (or nullptr).
+ */
+void Model::setProfiler(PerfProfiler *profiler)
+{
+    _network.setProfiler(profiler);
+}
+
+/**
+ * Returns the network of the model.
+ *
+ * @return The network.
+ */
+const MlpNetwork &Model::getNetwork() const
+{
+    return _network;
+}
+
+/**
+ * Returns the cascade in front of the network.
+ *
+ * @return The cascade, nullptr if the model has none.
+ */
+const MlpCascade *Model::getCascade() const
+{
+    return _cascade.get();
+}
+
+/**
+ * Returns the version of the model, the first loaded model is version 1.
+ *
+ * @return The version.
+ */
+long Model::getVersion() const
+{
+    return _version;
+}
+
+/**
+ * Returns whether the network runs the configuration of the tuning file (options.tuningFile),
+ * false if there is none or it holds no configuration for this CPU and model.
+ *
+ * @return true if the tuning was applied.
+ */
+bool Model::isTuned() const
+{
+    return _tuned;
+}
+
+/**
+ * Builds the replicas of a model out of the given parameters (which it takes over).
+ *
+ * @param parameters The weights and biases of every layer.
+ * @param options How every replica is built.
+ * @param version The version of the model.
+ */
+ModelReplicas::ModelReplicas(ModelParameters &&parameters, const ModelOptions &options, long version)
+{
+    if (!MemoryPlacement::active())
+    {
+        _models.emplace_back(new Model(std::move(parameters), options, version));
+        return;
+    }
+    _replicate([&parameters, version](const ModelOptions &unprofiled)
+               {
+                   ModelParameters copy(parameters);
+                   return new Model(std::move(copy), unprofiled, version);
+               }, options);
+}
+
+/**
+ * Builds the replicas of a model out of a network read from a pack cache (which it takes over).
+ *
+ * @param network The network.
+ * @param options How every replica is built.
+ * @param version The version of the model.
+ */
+ModelReplicas::ModelReplicas(MlpNetwork &&network, const ModelOptions &options, long version)
+{
+    if (!MemoryPlacement::active())
+    {
+        _models.emplace_back(new Model(std::move(network), options, version));
+        return;
+    }
+    _replicate([&network, version](const ModelOptions &unprofiled)
+               {
+                   return new Model(MlpNetwork(network), unprofiled, version);
+               }, options);
+}
+
+// Builds every replica in its arena, on its node, then attaches the profiler on the calling thread.
+void ModelReplicas::_replicate(const std::function<Model *(const ModelOptions &)> &build,
+                               const ModelOptions &options)
+{
+    // The builders run concurrently, so the profiler is attached (and its sections registered) once they are done.
+    ModelOptions unprofiled = options;
+    unprofiled.profiler = nullptr;
+
+    // Every replica is a deep copy made (and packed) in its own arena, by a thread on its node.
+    bool replicate = MemoryPlacement::getOptions().replicate;
+    int replicas = replicate ? MemoryPlacement::nodes() : 1;
+    _models.resize(replicas);
+    std::vector<std::thread> builders;
+    for (int i = 0; i < replicas; i++)
+    {
+        _arenas.emplace_back(new MatrixArena(REPLICA_CHUNK_BYTES, replicate ? i : ANY_NODE));
+        builders.emplace_back([this, i, replicate, &build, &unprofiled]
+                              {
+                                  if (replicate)
+                                  {
+                                      MemoryPlacement::pinToNode(i);
+                                  }
+                                  ArenaScope scope(*_arenas[i], false); // The replica lives with the arena.
+                                  _models[i].reset(build(unprofiled));
+                              });
+    }
+    for (std::thread &builder : builders)
+    {
+        builder.join();
+    }
+    for (std::unique_ptr<Model> &model : _models)
+    {
+        model->setProfiler(options.profiler);
+    }
+}
+
+/**
+ * Returns the replica of the NUMA node the calling thread runs on.
+ *
+ * @return The replica.
+ */
+const Model &ModelReplicas::local() const
+{
+    if (_models.size() == 1)
+    {
+        return *_models[0];
+    }
+    return *_models[std::min(MemoryPlacement::currentNode(), (int) _models.size() - 1)];
+}
+
+/**
+ * Returns the amount of replicas.
+ *
+ * @return The amount of replicas.
+ */
+int ModelReplicas::size() const
+{
+    return (int) _models.size();
+}
+
+/**
+ * Loads the first model.
+ * Exits (code == 1) if a parameters file is unreadable or has improper dimensions.
+ *
+ * @param paths The weights file of every layer, followed by the biases file of every layer.
+ *        A weights file holds either the raw weights or low rank factors (see LowRankDense::write).
+ * @param options How every model is built.
+ */
+ModelRegistry::ModelRegistry(const std::vector<std::string> &paths, const ModelOptions &options)
+        : _paths(paths), _options(options), _version(0), _stopWatching(false)
+{
+    if (paths.size() != 2 * MLP_SIZE)
+    {
+        std::cerr << ERROR_BAD_PATHS << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    int failedLayer;
+    ModelReplicas *replicas = _load(1, failedLayer);
+    if (replicas == nullptr)
+    {
+        std::cerr << ERROR_INAVLID_PARAMETER << failedLayer << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    std::atomic_store(&_current, std::shared_ptr<const ModelReplicas>(replicas));
+    _version = 1;
+}
+
+/**
+ * Stops watching for reloads (see watchReloads()).
+ */
+ModelRegistry::~ModelRegistry()
+{
+    _stopWatching = true;
+    if (_watcher.joinable())
+    {
+        _watcher.join();
+    }
+}
+
+/**
+ * Returns the current model (the replica of the calling thread's NUMA node), which stays alive
+ * for as long as it is held.
+ *
+ * @return The current model.
+ */
+std::shared_ptr<const Model> ModelRegistry::acquire() const
+{
+    std::shared_ptr<const ModelReplicas> replicas = std::atomic_load(&_current);
+    return std::shared_ptr<const Model>(replicas, &replicas->local()); // Keeps every replica alive.
+}
+
+/**
+ * Returns the version of the current model, without acquiring it.
+ *
+ * @return The current version.
+ */
+long ModelRegistry::getVersion() const
+{
+    return _version;
+}
+
+/**
+ * Reloads the parameters files into a new model and publishes it.
+ * Prints an error and keeps the current model if a file is unreadable or has improper dimensions.
+ *
+ * @return true if the new model was published.
+ */
+bool ModelRegistry::reload()
+{
+    std::lock_guard<std::mutex> lock(_reloadMutex);
+    long version = _version + 1;
+    int failedLayer;
+    ModelReplicas *replicas = _load(version, failedLayer);
+    if (replicas == nullptr)
+    {
+        std::cerr << ERROR_INAVLID_PARAMETER << failedLayer << std::endl
+                  << RELOAD_FAILED << _version << std::endl;
+        return false;
+    }
+
+    // Packed (the expensive part) before anyone can see it, the previous model is released by its last reader.
+    std::atomic_store(&_current, std::shared_ptr<const ModelReplicas>(replicas));
+    _version = version;
+    std::cerr << RELOADED << version << std::endl;
+    return true;
+}
+
+/**
+ * Reloads on SIGHUP from now on, in a background thread (until the registry is destroyed).
+ */
+void ModelRegistry::watchReloads()
+{
+    listenForReloads(false);
+    if (!_watcher.joinable())
+    {
+        _watcher = std::thread(&ModelRegistry::_watch, this);
+    }
+}
+
+/**
+ * Makes SIGHUP request a reload (see takeReloadRequest()).
+ *
+ * @param interrupt Whether SIGHUP interrupts blocking system calls (EINTR) instead of restarting them.
+ */
+void ModelRegistry::listenForReloads(bool interrupt)
+{
+    struct sigaction action = {};
+    action.sa_handler = _requestReload;
+    action.sa_flags = interrupt ? 0 : SA_RESTART;
+    sigaction(SIGHUP, &action, nullptr);
+}
+
+/**
+ * Returns whether a reload was requested since the last call, and clears the request.
+ *
+ * @return true if a reload was requested.
+ */
+bool ModelRegistry::takeReloadRequest()
+{
+    if (!reloadRequested)
+    {
+        return false;
+    }
+    reloadRequested = 0;
+    return true;
+}
+
+/**
+ * Reads the parameters files of a model, without exiting upon failure.
+ *
+ * @param paths The weights file of every layer, followed by the biases file of every layer.
+ * @param parameters Output, the parameters of every layer.
+ * @return The failing layer (1 based), 0 upon success.
+ */
+int ModelRegistry::loadParameters(const std::vector<std::string> &paths, ModelParameters &parameters)
+{
+    if (paths.size() != 2 * MLP_SIZE)
+    {
+        return 1;
+    }
+    for (int i = 0; i < MLP_SIZE; i++)
+    {
+        parameters.weights[i] = Matrix(weightsDims[i].rows, weightsDims[i].cols);
+        parameters.biases[i] = Matrix(biasDims[i].rows, biasDims[i].cols);
+        LowRankFactors &factors = parameters.factors;
+        if (LowRankDense::read(paths[i], weightsDims[i].rows, weightsDims[i].cols, factors.u[i], factors.v[i]))
+        {
+            factors.ranks[i] = factors.v[i].getRows();
+            parameters.weights[i] = factors.u[i] * factors.v[i];
+        }
+        else if (!_readFileToMatrix(paths[i], parameters.weights[i]))
+        {
+            return i + 1;
+        }
+        if (!_readFileToMatrix(paths[MLP_SIZE + i], parameters.biases[i]))
+        {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Loads a model: out of the pack cache when it was written for the current parameters files
+ * (without reading them), otherwise out of the parameters files, then rewrites the cache.
+ *
+ * @param version The version of the model.
+ * @param failedLayer Output, the failing layer (1 based) upon failure.
+ * @return The replicas of the model, nullptr upon failure.
+ */
+ModelReplicas *ModelRegistry::_load(long version, int &failedLayer) const
+{
+    failedLayer = 0;
+    // A cascade is built out of the raw weights, so it always reads the parameters files.
+    uint64_t source = _options.packCache.empty() || _options.cascade ? 0 : _sourceKey(_paths);
+    if (source != 0)
+    {
+        std::unique_ptr<MlpNetwork> network = MlpNetwork::readPackCache(_options.packCache, source);
+        if (network)
+        {
+            return new ModelReplicas(std::move(*network), _options, version);
+        }
+    }
+
+    ModelParameters parameters;
+    failedLayer = loadParameters(_paths, parameters);
+    if (failedLayer != 0)
+    {
+        return nullptr;
+    }
+    ModelReplicas *replicas = new ModelReplicas(std::move(parameters), _options, version);
+    if (source != 0)
+    {
+        replicas->local().getNetwork().writePackCache(_options.packCache, source);
+    }
+    return replicas;
+}
+
+// The watcher thread, reloads whenever SIGHUP arrived since it last looked.
+void ModelRegistry::_watch()
+{
+    while (!_stopWatching)
+    {
+        if (takeReloadRequest())
+        {
+            reload();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(RELOAD_POLL_MS));
+    }
+}
@@ -0,0 +1,333 @@
+/**
+ * @file ModelRegistry.h
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Header file for the Model and ModelRegistry classes which load networks and publish
+ * the current one, so it is replaced (hot swapped) without stopping inference.
+ */
+
+#ifndef MODELREGISTRY_H
+#define MODELREGISTRY_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Digit.h"
+#include "Matrix.h"
+#include "MatrixAllocator.h"
+#include "MlpCascade.h"
+#include "MlpNetwork.h"
+#include "PerfCounters.h"
+
+/**
+ * @struct ModelOptions
+ * @brief How every loaded model is built.
+ * @var packCache - Path of the pack cache file (empty for none, unused with a cascade)
+ * @var tuningFile - Path of the kernel tuning file (empty for none, see KernelTuner.h)
+ * @var cascade - Whether inferences run through a cascade in front of the network
+ * @var cascadeOptions - When the first stage of the cascade is trusted
+ * @var profiler - The profiler the network reports to (or nullptr)
+ */
+typedef struct ModelOptions
+{
+    std::string packCache;
+    std::string tuningFile;
+    bool cascade = false;
+    CascadeOptions cascadeOptions;
+    PerfProfiler *profiler = nullptr;
+} ModelOptions;
+
+/**
+ * @struct ModelParameters
+ * @brief The weights and biases of every layer of a network.
+ * @var weights - The weights of every layer (the product of the factors of a factorized layer)
+ * @var biases - The biases of every layer
+ * @var factors - The layers whose weights file held low rank factors
+ */
+typedef struct ModelParameters
+{
+    Matrix weights[MLP_SIZE];
+    Matrix biases[MLP_SIZE];
+    LowRankFactors factors;
+} ModelParameters;
+
+/**
+ * The Model class- a loaded network: its parameters, the network compiled from them and
+ * (optionally) a cascade in front of it. Never changes after construction.
+ */
+class Model
+{
+public:
+    // Constructors.
+    /**
+     * Builds a model out of the given parameters (which it takes over).
+     *
+     * @param parameters The weights and biases of every layer.
+     * @param options How the model is built.
+     * @param version The version of the model.
+     */
+    Model(ModelParameters &&parameters, const ModelOptions &options, long version);
+
+    /**
+     * Builds a model out of a network read from a pack cache (which it takes over), it has no parameters.
+     * A cascade needs the parameters, so options.cascade has to be off.
+     *
+     * @param network The network.
+     * @param options How the model is built.
+     * @param version The version of the model.
+     */
+    Model(MlpNetwork &&network, const ModelOptions &options, long version);
+
+    /**
+     * The network points into the model's parameters, so a model is never copied.
+     */
+    Model(const Model &other) = delete;
+
+    /**
+     * The network points into the model's parameters, so a model is never copied.
+     */
+    Model &operator=(const Model &other) = delete;
+
+    // Operators.
+    /**
+     * Applies the model (through its cascade if it has one) on a view of the input.
+     *
+     * @param input The input view (784 * 1).
+     * @return Digit struct that represents the most likely digit in the image.
+     */
+    Digit operator()(const MatrixView &input) const;
+
+    // Methods.
+    /**
+     * Applies the model (through its cascade if it has one) on a batch of images.
+     *
+     * @param batch The input batch, a vectorized image in every row.
+     * @param results Output array with a Digit per row of the batch.
+     */
+    void predictBatch(const Matrix &batch, Digit results[]) const;
+
+    /**
+     * Applies the model (through its cascade if it has one) on a view of a batch of images,
+     * in place when the view is contiguous.
+     *
+     * @param batch The view of the input batch, a vectorized image in every row.
+     * @param results Output array with a Digit per row of the batch.
+     */
+    void predictBatch(const MatrixView &batch, Digit results[]) const;
+
+    /**
+     * Attributes hardware counters of every following inference of the network to the given profiler
+     * (see MlpNetwork::setProfiler()), overriding options.profiler.
+     *
+     * @param profiler The profiler to report to (or nullptr).
+     */
+    void setProfiler(PerfProfiler *profiler);
+
+    /**
+     * Returns the network of the model.
+     *
+     * @return The network.
+     */
+    const MlpNetwork &getNetwork() const;
+
+    /**
+     * Returns the cascade in front of the network.
+     *
+     * @return The cascade, nullptr if the model has none.
+     */
+    const MlpCascade *getCascade() const;
+
+    /**
+     * Returns the version of the model, the first loaded model is version 1.
+     *
+     * @return The version.
+     */
+    long getVersion() const;
+
+    /**
+     * Returns whether the network runs the configuration of the tuning file (options.tuningFile),
+     * false if there is none or it holds no configuration for this CPU and model.
+     *
+     * @return true if the tuning was applied.
+     */
+    bool isTuned() const;
+
+private:
+    ModelParameters _parameters;
+    MlpNetwork _network;
+    std::unique_ptr<MlpCascade> _cascade;
+    long _version;
+    bool _tuned;
+
+    void _configure(const ModelOptions &options); // Tunes and profiles the network, builds the cascade.
+};
+
+/**
+ * The ModelReplicas class- the copies of a model inferences run on. Without placement (see
+ * MemoryPlacement) it is the model itself. Otherwise every copy is built in an arena of placed memory
+ * by a thread pinned to the copy's node, so its memory is local even where placement relies on first
+ * touch: a copy per NUMA node when replicating, or a single huge page backed copy.
+ */
+class ModelReplicas
+{
+public:
+    // Constructors.
+    /**
+     * Builds the replicas of a model out of the given parameters (which it takes over).
+     *
+     * @param parameters The weights and biases of every layer.
+     * @param options How every replica is built.
+     * @param version The version of the model.
+     */
+    ModelReplicas(ModelParameters &&parameters, const ModelOptions &options, long version);
+
+    /**
+     * Builds the replicas of a model out of a network read from a pack cache (which it takes over).
+     *
+     * @param network The network.
+     * @param options How every replica is built.
+     * @param version The version of the model.
+     */
+    ModelReplicas(MlpNetwork &&network, const ModelOptions &options, long version);
+
+    /**
+     * Replicas are shared by reference, never copied.
+     */
+    ModelReplicas(const ModelReplicas &other) = delete;
+
+    /**
+     * Replicas are shared by reference, never copied.
+     */
+    ModelReplicas &operator=(const ModelReplicas &other) = delete;
+
+    // Methods.
+    /**
+     * Returns the replica of the NUMA node the calling thread runs on.
+     *
+     * @return The replica.
+     */
+    const Model &local() const;
+
+    /**
+     * Returns the amount of replicas.
+     *
+     * @return The amount of replicas.
+     */
+    int size() const;
+
+private:
+    std::vector<std::unique_ptr<MatrixArena>> _arenas; // By replica, empty without placement.
+    std::vector<std::unique_ptr<Model>> _models; // Destroyed before the arenas holding them.
+
+    // Builds every replica in its arena, on its node, then attaches the profiler on the calling thread.
+    void _replicate(const std::function<Model *(const ModelOptions &)> &build, const ModelOptions &options);
+};
+
+/**
+ * The ModelRegistry class- loads models and publishes the current one, read-copy-update style.
+ * A reload reads and prepacks a whole new model off to the side, then publishes it with a single
+ * atomic store. Inferences acquire the current model once and keep it until they are done: those in
+ * flight finish on the old model while new ones see the new model, and a replaced model is freed
+ * when its last reader lets go of it. A reload which fails leaves the current model in place.
+ */
+class ModelRegistry
+{
+public:
+    // Constructors.
+    /**
+     * Loads the first model.
+     * Exits (code == 1) if a parameters file is unreadable or has improper dimensions.
+     *
+     * @param paths The weights file of every layer, followed by the biases file of every layer.
+     *        A weights file holds either the raw weights or low rank factors (see LowRankDense::write).
+     * @param options How every model is built.
+     */
+    ModelRegistry(const std::vector<std::string> &paths, const ModelOptions &options);
+
+    /**
+     * Stops watching for reloads (see watchReloads()).
+     */
+    ~ModelRegistry();
+
+    /**
+     * A registry is shared by reference, never copied.
+     */
+    ModelRegistry(const ModelRegistry &other) = delete;
+
+    /**
+     * A registry is shared by reference, never copied.
+     */
+    ModelRegistry &operator=(const ModelRegistry &other) = delete;
+
+    // Methods.
+    /**
+     * Returns the current model (the replica of the calling thread's NUMA node), which stays alive
+     * for as long as it is held.
+     *
+     * @return The current model.
+     */
+    std::shared_ptr<const Model> acquire() const;
+
+    /**
+     * Returns the version of the current model, without acquiring it.
+     *
+     * @return The current version.
+     */
+    long getVersion() const;
+
+    /**
+     * Reloads the parameters files into a new model and publishes it.
+     * Prints an error and keeps the current model if a file is unreadable or has improper dimensions.
+     *
+     * @return true if the new model was published.
+     */
+    bool reload();
+
+    /**
+     * Reloads on SIGHUP from now on, in a background thread (until the registry is destroyed).
+     */
+    void watchReloads();
+
+    /**
+     * Makes SIGHUP request a reload (see takeReloadRequest()).
+     *
+     * @param interrupt Whether SIGHUP interrupts blocking system calls (EINTR) instead of restarting them.
+     */
+    static void listenForReloads(bool interrupt);
+
+    /**
+     * Returns whether a reload was requested since the last call, and clears the request.
+     *
+     * @return true if a reload was requested.
+     */
+    static bool takeReloadRequest();
+
+    /**
+     * Reads the parameters files of a model, without exiting upon failure.
+     *
+     * @param paths The weights file of every layer, followed by the biases file of every layer.
+     * @param parameters Output, the parameters of every layer.
+     * @return The failing layer (1 based), 0 upon success.
+     */
+    static int loadParameters(const std::vector<std::string> &paths, ModelParameters &parameters);
+
+private:
+    const std::vector<std::string> _paths;
+    const ModelOptions _options;
+    std::shared_ptr<const ModelReplicas> _current; // Only accessed through std::atomic_load / std::atomic_store.
+    std::atomic<long> _version;
+    std::mutex _reloadMutex; // Serializes reloads.
+    std::thread _watcher;
+    std::atomic<bool> _stopWatching;
+
+    ModelReplicas *_load(long version, int &failedLayer) const; // Loads a model, nullptr upon failure.
+    void _watch(); // The watcher thread.
+};
+
+#endif //MODELREGISTRY_H
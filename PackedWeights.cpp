@@ -0,0 +1,281 @@
+/**
+ * @file PackedWeights.cpp
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Implementation file for the PackedWeights class which holds the weights and bias of a layer
+ * repacked into the panel layout of the inference kernels.
+ */
+
+#define ERROR_BAD_LAYER "Error: Bias doesn't match the weights of its layer."
+
+#define MAX_STORED_DIM (1 << 16) // Larger dimensions in a stored layer mean it is corrupt.
+
+#include <algorithm>
+#include <cstring>
+#include "PackedWeights.h"
+
+const int PackedWeights::PANEL_ROWS;
+const int PackedWeights::BATCH_TILE;
+const int PackedWeights::MAX_BATCH_TILE;
+
+/**
+ * Constructs an empty (0 * 0) layer.
+ */
+PackedWeights::PackedWeights() : _rows(0), _cols(0), _wrapped(nullptr)
+{}
+
+/**
+ * Packs the weights and bias of a layer.
+ * Exits (code == 1) if the bias is not a vector with a row per row of the weights.
+ *
+ * @param weights The weights Matrix of the layer.
+ * @param bias The bias Matrix (Vector) of the layer.
+ */
+PackedWeights::PackedWeights(const Matrix &weights, const Matrix &bias) : _rows(weights.getRows()),
+                                                                          _cols(weights.getCols()),
+                                                                          _panels((_rows + PANEL_ROWS - 1) /
+                                                                                  PANEL_ROWS, _panelLength()),
+                                                                          _wrapped(nullptr)
+{
+    if (bias.getRows() != _rows || bias.getCols() != 1)
+    {
+        std::cerr << ERROR_BAD_LAYER << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    for (int row = 0; row < _rows; row++)
+    {
+        float *panel = _panels.data() + (size_t) (row / PANEL_ROWS) * _panelLength();
+        int lane = row % PANEL_ROWS;
+        panel[lane] = bias.at(row, 0);
+        for (int k = 0; k < _cols; k++)
+        {
+            panel[PANEL_ROWS * (k + 1) + lane] = weights.at(row, k);
+        }
+    }
+}
+
+/**
+ * Wraps panels which are already in the packed layout, without copying them.
+ *
+ * @param panels The panels of the layer (see getPanels()), 64 byte aligned, which must outlive
+ *        the layer and all of its copies.
+ * @param rows The amount of outputs.
+ * @param cols The amount of inputs.
+ */
+PackedWeights::PackedWeights(const float panels[], int rows, int cols) : _rows(rows), _cols(cols), _wrapped(panels)
+{}
+
+/**
+ * Returns the amount of outputs (rows of the weights).
+ *
+ * @return The amount of outputs.
+ */
+int PackedWeights::getRows() const
+{
+    return _rows;
+}
+
+/**
+ * Returns the amount of inputs (columns of the weights).
+ *
+ * @return The amount of inputs.
+ */
+int PackedWeights::getCols() const
+{
+    return _cols;
+}
+
+/**
+ * Returns the amount of floats the packed layer occupies (padding included).
+ *
+ * @return The length of the packed layer.
+ */
+size_t PackedWeights::getPackedLength() const
+{
+    return (size_t) (_rows + PANEL_ROWS - 1) / PANEL_ROWS * _panelLength();
+}
+
+/**
+ * Returns the panels of the layer, one after the other (getPackedLength() floats).
+ *
+ * @return The panels.
+ */
+const float *PackedWeights::getPanels() const
+{
+    return (_wrapped != nullptr) ? _wrapped : _panels.data();
+}
+
+/**
+ * Computes output = W input + b for a single sample.
+ *
+ * @param input getCols() inputs.
+ * @param output Output, getRows() floats.
+ */
+void PackedWeights::apply(const float input[], float output[]) const
+{
+    applyBatch(input, 1, output);
+}
+
+/**
+ * Computes W x + b for every sample of a batch.
+ *
+ * @param input count samples of getCols() inputs, one after the other.
+ * @param count The amount of samples.
+ * @param output Output, count results of getRows() floats, one after the other.
+ */
+void PackedWeights::applyBatch(const float input[], int count, float output[]) const
+{
+    _applyPanels<false, BATCH_TILE>(input, count, output);
+}
+
+/**
+ * Computes max(W x + b, 0) for every sample of a batch, Relu fused into the stores.
+ *
+ * @param input count samples of getCols() inputs, one after the other.
+ * @param count The amount of samples.
+ * @param output Output, count results of getRows() floats, one after the other.
+ */
+void PackedWeights::applyBatchRelu(const float input[], int count, float output[]) const
+{
+    _applyPanels<true, BATCH_TILE>(input, count, output);
+}
+
+/**
+ * Returns the batch kernel of the given tile (applyBatch() or applyBatchRelu() with another tile).
+ *
+ * @param relu Whether Relu is fused into the stores.
+ * @param batchTile Samples sharing a pass over a panel: 1, 2, 4 or MAX_BATCH_TILE.
+ * @return The kernel, nullptr if there is none of that tile.
+ */
+PackedWeights::Kernel PackedWeights::batchKernel(bool relu, int batchTile)
+{
+    switch (batchTile)
+    {
+        case 1:
+            return relu ? &PackedWeights::_applyPanels<true, 1> : &PackedWeights::_applyPanels<false, 1>;
+        case 2:
+            return relu ? &PackedWeights::_applyPanels<true, 2> : &PackedWeights::_applyPanels<false, 2>;
+        case 4:
+            return relu ? &PackedWeights::_applyPanels<true, 4> : &PackedWeights::_applyPanels<false, 4>;
+        case MAX_BATCH_TILE:
+            return relu ? &PackedWeights::_applyPanels<true, MAX_BATCH_TILE>
+                        : &PackedWeights::_applyPanels<false, MAX_BATCH_TILE>;
+        default:
+            return nullptr;
+    }
+}
+
+// Stores the sums of a panel's rows plus their biases, through Relu if RELU.
+template<bool RELU>
+static void _storePanel(const float sums[], const float biases[], int lanes, float outputs[])
+{
+    for (int lane = 0; lane < lanes; lane++)
+    {
+        float value = sums[lane] + biases[lane];
+        outputs[lane] = (RELU && value < 0.0f) ? 0.0f : value;
+    }
+}
+
+// The batch kernel, Relu fused into the stores if RELU.
+template<bool RELU, int TILE>
+void PackedWeights::_applyPanels(const float input[], int count, float output[]) const
+{
+    const float *panels = getPanels();
+    for (int first = 0; first < _rows; first += PANEL_ROWS)
+    {
+        const float *panel = panels + (size_t) (first / PANEL_ROWS) * _panelLength();
+        int lanes = std::min(PANEL_ROWS, _rows - first);
+
+        // TILE samples at a time, so every column of the panel is loaded once per tile.
+        int sample = 0;
+        for (; TILE > 1 && sample + TILE <= count; sample += TILE)
+        {
+            float sums[TILE][PANEL_ROWS] = {};
+            const float *inputs = input + (size_t) sample * _cols;
+            for (int k = 0; k < _cols; k++)
+            {
+                // Constant trip counts, unrolled so the sums of the tile stay in registers.
+                const float *column = panel + PANEL_ROWS * (k + 1);
+                float values[TILE];
+#pragma GCC unroll 8
+                for (int s = 0; s < TILE; s++)
+                {
+                    values[s] = inputs[(size_t) s * _cols + k];
+                }
+                for (int lane = 0; lane < PANEL_ROWS; lane++)
+                {
+                    float weight = column[lane];
+#pragma GCC unroll 8
+                    for (int s = 0; s < TILE; s++)
+                    {
+                        sums[s][lane] += weight * values[s];
+                    }
+                }
+            }
+            for (int s = 0; s < TILE; s++)
+            {
+                _storePanel<RELU>(sums[s], panel, lanes, output + (size_t) (sample + s) * _rows + first);
+            }
+        }
+
+        for (; sample < count; sample++)
+        {
+            float sums[PANEL_ROWS] = {};
+            const float *inputs = input + (size_t) sample * _cols;
+            for (int k = 0; k < _cols; k++)
+            {
+                const float *column = panel + PANEL_ROWS * (k + 1);
+                float value = inputs[k];
+                for (int lane = 0; lane < PANEL_ROWS; lane++)
+                {
+                    sums[lane] += column[lane] * value;
+                }
+            }
+            _storePanel<RELU>(sums, panel, lanes, output + (size_t) sample * _rows + first);
+        }
+    }
+}
+
+/**
+ * Writes the packed layer in binary: its dimensions followed by its panels.
+ *
+ * @param os The output stream.
+ */
+void PackedWeights::write(std::ostream &os) const
+{
+    int32_t header[] = {_rows, _cols, PANEL_ROWS};
+    os.write((const char *) header, sizeof(header));
+    os.write((const char *) getPanels(), (std::streamsize) (getPackedLength() * sizeof(float)));
+}
+
+/**
+ * Reads a layer written by write(), no packing needed.
+ *
+ * @param is The input stream.
+ * @return false if the stream is truncated or doesn't hold a layer (this is left unchanged).
+ */
+bool PackedWeights::read(std::istream &is)
+{
+    int32_t header[3];
+    if (!is.read((char *) header, sizeof(header)) || header[0] <= 0 || header[0] > MAX_STORED_DIM ||
+        header[1] <= 0 || header[1] > MAX_STORED_DIM || header[2] != PANEL_ROWS)
+    {
+        return false;
+    }
+
+    Matrix panels((header[0] + PANEL_ROWS - 1) / PANEL_ROWS, PANEL_ROWS * (header[1] + 1));
+    if (!is.read((char *) panels.data(),
+                 (std::streamsize) ((size_t) panels.getRows() * panels.getCols() * sizeof(float))))
+    {
+        return false;
+    }
+
+    _rows = header[0];
+    _cols = header[1];
+    _panels = std::move(panels);
+    _wrapped = nullptr;
+    return true;
+}
@@ -0,0 +1,159 @@
+/**
+ * @file PackedWeights.h
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Header file for the PackedWeights class which holds the weights and bias of a layer
+ * repacked into the panel layout of the inference kernels.
+ */
+
+#ifndef PACKEDWEIGHTS_H
+#define PACKEDWEIGHTS_H
+
+#include <cstdint>
+#include <iostream>
+#include "Matrix.h"
+
+/**
+ * The PackedWeights class- the weights of a layer cut into panels of PANEL_ROWS rows.
+ * A panel holds the bias of its rows followed by its weights column after column
+ * (PANEL_ROWS consecutive floats per column), so the kernels read a single stream and
+ * update PANEL_ROWS sums with every input, a SIMD register's worth.
+ * The last panel is padded with zero rows. Computes W x + b exactly like the plain product
+ * (every sum is accumulated in the same order).
+ * A batch is run a tile of samples at a time, which share every load of a column. The best tile
+ * depends on the layer's shape and the CPU, so kernels of several tiles are compiled (see KernelTuner.h),
+ * all of them producing the very same results.
+ * A layer may also wrap panels it doesn't own, such as panels compiled into the binary (see EmbeddedNetwork.h),
+ * which are never copied: copies of such a layer share them.
+ */
+class PackedWeights
+{
+public:
+    static const int PANEL_ROWS = 8;
+    static const int BATCH_TILE = 4; // Samples sharing a pass over a panel in a batch (untuned).
+    static const int MAX_BATCH_TILE = 8;
+
+    typedef void (PackedWeights::*Kernel)(const float input[], int count, float output[]) const;
+
+    // Constructors.
+    /**
+     * Constructs an empty (0 * 0) layer.
+     */
+    PackedWeights();
+
+    /**
+     * Packs the weights and bias of a layer.
+     * Exits (code == 1) if the bias is not a vector with a row per row of the weights.
+     *
+     * @param weights The weights Matrix of the layer.
+     * @param bias The bias Matrix (Vector) of the layer.
+     */
+    PackedWeights(const Matrix &weights, const Matrix &bias);
+
+    /**
+     * Wraps panels which are already in the packed layout, without copying them.
+     *
+     * @param panels The panels of the layer (see getPanels()), 64 byte aligned, which must outlive
+     *        the layer and all of its copies.
+     * @param rows The amount of outputs.
+     * @param cols The amount of inputs.
+     */
+    PackedWeights(const float panels[], int rows, int cols);
+
+    // Methods.
+    /**
+     * Returns the amount of outputs (rows of the weights).
+     *
+     * @return The amount of outputs.
+     */
+    int getRows() const;
+
+    /**
+     * Returns the amount of inputs (columns of the weights).
+     *
+     * @return The amount of inputs.
+     */
+    int getCols() const;
+
+    /**
+     * Returns the amount of floats the packed layer occupies (padding included).
+     *
+     * @return The length of the packed layer.
+     */
+    size_t getPackedLength() const;
+
+    /**
+     * Returns the panels of the layer, one after the other (getPackedLength() floats).
+     *
+     * @return The panels.
+     */
+    const float *getPanels() const;
+
+    /**
+     * Computes output = W input + b for a single sample.
+     *
+     * @param input getCols() inputs.
+     * @param output Output, getRows() floats.
+     */
+    void apply(const float input[], float output[]) const;
+
+    /**
+     * Computes W x + b for every sample of a batch.
+     *
+     * @param input count samples of getCols() inputs, one after the other.
+     * @param count The amount of samples.
+     * @param output Output, count results of getRows() floats, one after the other.
+     */
+    void applyBatch(const float input[], int count, float output[]) const;
+
+    /**
+     * Computes max(W x + b, 0) for every sample of a batch, Relu fused into the stores.
+     *
+     * @param input count samples of getCols() inputs, one after the other.
+     * @param count The amount of samples.
+     * @param output Output, count results of getRows() floats, one after the other.
+     */
+    void applyBatchRelu(const float input[], int count, float output[]) const;
+
+    /**
+     * Returns the batch kernel of the given tile (applyBatch() or applyBatchRelu() with another tile).
+     *
+     * @param relu Whether Relu is fused into the stores.
+     * @param batchTile Samples sharing a pass over a panel: 1, 2, 4 or MAX_BATCH_TILE.
+     * @return The kernel, nullptr if there is none of that tile.
+     */
+    static Kernel batchKernel(bool relu, int batchTile);
+
+    /**
+     * Writes the packed layer in binary: its dimensions followed by its panels.
+     *
+     * @param os The output stream.
+     */
+    void write(std::ostream &os) const;
+
+    /**
+     * Reads a layer written by write(), no packing needed.
+     *
+     * @param is The input stream.
+     * @return false if the stream is truncated or doesn't hold a layer (this is left unchanged).
+     */
+    bool read(std::istream &is);
+
+private:
+    int _rows, _cols;
+    Matrix _panels; // A panel per row, 64 byte aligned (see MatrixAllocator.h).
+    const float *_wrapped; // Panels the layer doesn't own, nullptr if it owns _panels.
+
+    template<bool RELU, int TILE>
+    void _applyPanels(const float input[], int count, float output[]) const; // The batch kernel.
+
+    // Returns the floats of a panel: PANEL_ROWS biases followed by _cols columns.
+    int _panelLength() const
+    {
+        return PANEL_ROWS * (_cols + 1);
+    }
+};
+
+#endif //PACKEDWEIGHTS_H
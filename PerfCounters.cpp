@@ -0,0 +1,283 @@
+/**
+ * @file PerfCounters.cpp
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Implementation file for the PerfCounters and PerfProfiler classes which sample
+ * hardware performance counters (through perf_event_open) and attribute them to sections.
+ */
+
+#define PERF_UNAVAILABLE "Perf counters unavailable (perf_event_open failed for every event)."
+#define NOT_AVAILABLE "n/a"
+
+#define NO_FD (-1)
+#define THIS_THREAD 0
+#define ANY_CPU (-1)
+#define NO_GROUP (-1)
+#define NO_SLOT (-1)
+#define READ_HEADER 3 // nr, time_enabled and time_running, before the values of a group read.
+#define NAME_WIDTH 12
+#define COLUMN_WIDTH 14
+
+#include <cstring>
+#include <iomanip>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "PerfCounters.h"
+
+static const char *const eventNames[PERF_EVENT_COUNT] = {"cycles", "instructions", "L1d miss",
+                                                         "LLC miss", "branch miss"};
+
+// Returns the perf_event_attr type and config of the given event.
+static void _eventConfig(PerfEvent event, __u32 &type, __u64 &config)
+{
+    switch (event)
+    {
+        case PerfCycles:
+            type = PERF_TYPE_HARDWARE;
+            config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case PerfInstructions:
+            type = PERF_TYPE_HARDWARE;
+            config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case PerfL1Misses:
+            type = PERF_TYPE_HW_CACHE;
+            config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                     (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        case PerfLlcMisses:
+            type = PERF_TYPE_HARDWARE;
+            config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        default:
+            type = PERF_TYPE_HARDWARE;
+            config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+    }
+}
+
+// Opens a user-space counter for the calling thread in the group of leader (a new group if NO_GROUP),
+// returns NO_FD on failure. The whole group is read through its leader.
+static int _openCounter(PerfEvent event, int leader)
+{
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    _eventConfig(event, attr.type, attr.config);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    long fd = syscall(SYS_perf_event_open, &attr, THIS_THREAD, ANY_CPU, leader, 0);
+    return (fd < 0) ? NO_FD : (int) fd;
+}
+
+/**
+ * Opens and enables all counters for the calling thread (user space only).
+ */
+PerfCounters::PerfCounters() : _leader(NO_FD), _members(0)
+{
+    for (int i = 0; i < PERF_EVENT_COUNT; i++)
+    {
+        _fds[i] = _openCounter((PerfEvent) i, (_leader == NO_FD) ? NO_GROUP : _leader);
+        _slots[i] = (_fds[i] == NO_FD) ? NO_SLOT : _members++;
+        if (_leader == NO_FD)
+        {
+            _leader = _fds[i];
+        }
+    }
+}
+
+/**
+ * Closes all the opened counters.
+ */
+PerfCounters::~PerfCounters()
+{
+    for (int fd : _fds)
+    {
+        if (fd != NO_FD)
+        {
+            close(fd);
+        }
+    }
+}
+
+/**
+ * Returns whether the given event could be opened.
+ *
+ * @param event The event to check.
+ * @return true if the event is being counted.
+ */
+bool PerfCounters::isAvailable(PerfEvent event) const
+{
+    return _fds[event] != NO_FD;
+}
+
+/**
+ * Returns whether at least one event could be opened.
+ *
+ * @return true if any event is being counted.
+ */
+bool PerfCounters::anyAvailable() const
+{
+    for (int fd : _fds)
+    {
+        if (fd != NO_FD)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Reads the current (scaled) value of all counters at once (unavailable counters read as 0).
+ *
+ * @param values Output array, one value per PerfEvent.
+ */
+void PerfCounters::read(uint64_t values[PERF_EVENT_COUNT]) const
+{
+    memset(values, 0, PERF_EVENT_COUNT * sizeof(uint64_t));
+    uint64_t group[READ_HEADER + PERF_EVENT_COUNT];
+    ssize_t length = (ssize_t) ((READ_HEADER + _members) * sizeof(uint64_t));
+    if (_leader == NO_FD || ::read(_leader, group, (size_t) length) != length)
+    {
+        return;
+    }
+
+    // While multiplexed the group counted only part of the time it was enabled, estimate the rest.
+    uint64_t enabled = group[1], running = group[2];
+    double scale = (running > 0 && running < enabled) ? (double) enabled / (double) running : 1.0;
+    for (int i = 0; i < PERF_EVENT_COUNT; i++)
+    {
+        if (_slots[i] != NO_SLOT)
+        {
+            values[i] = (uint64_t) ((double) group[READ_HEADER + _slots[i]] * scale);
+        }
+    }
+}
+
+/**
+ * Registers a named section (or finds an existing one) and returns its id.
+ *
+ * @param name The name of the section.
+ * @return The id to pass to begin() and end().
+ */
+int PerfProfiler::addSection(const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (size_t i = 0; i < _sections.size(); i++)
+    {
+        if (_sections[i].name == name)
+        {
+            return (int) i;
+        }
+    }
+
+    Section section;
+    section.name = name;
+    section.calls = 0;
+    memset(section.start, 0, sizeof(section.start));
+    memset(section.total, 0, sizeof(section.total));
+    _sections.push_back(section);
+    return (int) _sections.size() - 1;
+}
+
+/**
+ * Starts counting for the given section.
+ *
+ * @param section A section id returned by addSection().
+ */
+void PerfProfiler::begin(int section)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _counters.read(_sections[section].start);
+}
+
+/**
+ * Stops counting for the given section and accumulates the counted events.
+ *
+ * @param section A section id returned by addSection().
+ */
+void PerfProfiler::end(int section)
+{
+    uint64_t now[PERF_EVENT_COUNT];
+    _counters.read(now);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    Section &current = _sections[section];
+    for (int i = 0; i < PERF_EVENT_COUNT; i++)
+    {
+        current.total[i] += now[i] - current.start[i];
+    }
+    current.calls++;
+}
+
+/**
+ * Adds to the amount of images the per-image figures are divided by.
+ *
+ * @param count The amount of images processed.
+ */
+void PerfProfiler::addImages(long count)
+{
+    _images += count;
+}
+
+/**
+ * Prints IPC and per-image event counts for every section.
+ *
+ * @param os The output stream.
+ */
+void PerfProfiler::report(std::ostream &os) const
+{
+    if (!_counters.anyAvailable())
+    {
+        os << PERF_UNAVAILABLE << std::endl;
+        return;
+    }
+
+    long images = (_images > 0) ? _images : 1;
+    os << "Perf profile (" << _images << " images, counts per image):" << std::endl;
+    os << std::left << std::setw(NAME_WIDTH) << "section" << std::right
+       << std::setw(COLUMN_WIDTH) << "calls" << std::setw(COLUMN_WIDTH) << "IPC";
+    for (const char *name : eventNames)
+    {
+        os << std::setw(COLUMN_WIDTH) << name;
+    }
+    os << std::endl;
+
+    bool hasIpc = _counters.isAvailable(PerfCycles) && _counters.isAvailable(PerfInstructions);
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (const Section &section : _sections)
+    {
+        os << std::left << std::setw(NAME_WIDTH) << section.name << std::right
+           << std::setw(COLUMN_WIDTH) << section.calls << std::setw(COLUMN_WIDTH);
+        if (hasIpc && section.total[PerfCycles] != 0)
+        {
+            os << std::fixed << std::setprecision(2)
+               << (double) section.total[PerfInstructions] / (double) section.total[PerfCycles];
+        }
+        else
+        {
+            os << NOT_AVAILABLE;
+        }
+
+        for (int i = 0; i < PERF_EVENT_COUNT; i++)
+        {
+            os << std::setw(COLUMN_WIDTH);
+            if (_counters.isAvailable((PerfEvent) i))
+            {
+                os << std::fixed << std::setprecision(1) << (double) section.total[i] / (double) images;
+            }
+            else
+            {
+                os << NOT_AVAILABLE;
+            }
+        }
+        os << std::endl;
+    }
+    os << std::defaultfloat;
+}
@@ -0,0 +1,149 @@
+/**
+ * @file PerfCounters.h
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Header file for the PerfCounters and PerfProfiler classes which sample
+ * hardware performance counters (through perf_event_open) and attribute them to sections.
+ */
+
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+
+/**
+ * @enum PerfEvent
+ * @brief Indicator of a sampled hardware event.
+ */
+enum PerfEvent
+{
+    PerfCycles,
+    PerfInstructions,
+    PerfL1Misses,
+    PerfLlcMisses,
+    PerfBranchMisses,
+    PERF_EVENT_COUNT
+};
+
+/**
+ * The PerfCounters class- a set of hardware counters opened for the calling thread.
+ * Events that the kernel or hardware does not support are simply marked unavailable.
+ * The counters form a single group, so they are scheduled onto the PMU together and always cover the
+ * same time; when the PMU multiplexes the group, counts are scaled up to the time it was enabled.
+ */
+class PerfCounters
+{
+public:
+    // Constructors.
+    /**
+     * Opens and enables all counters for the calling thread (user space only).
+     */
+    PerfCounters();
+
+    /**
+     * Closes all the opened counters.
+     */
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters &other) = delete;
+
+    PerfCounters &operator=(const PerfCounters &other) = delete;
+
+    // Methods.
+    /**
+     * Returns whether the given event could be opened.
+     *
+     * @param event The event to check.
+     * @return true if the event is being counted.
+     */
+    bool isAvailable(PerfEvent event) const;
+
+    /**
+     * Returns whether at least one event could be opened.
+     *
+     * @return true if any event is being counted.
+     */
+    bool anyAvailable() const;
+
+    /**
+     * Reads the current (scaled) value of all counters at once (unavailable counters read as 0).
+     *
+     * @param values Output array, one value per PerfEvent.
+     */
+    void read(uint64_t values[PERF_EVENT_COUNT]) const;
+
+private:
+    int _fds[PERF_EVENT_COUNT];
+    int _leader; // The fd of the group leader, the first event opened.
+    int _slots[PERF_EVENT_COUNT]; // The position of every event in a read of the group.
+    int _members;
+};
+
+/**
+ * The PerfProfiler class- accumulates counter deltas into named sections
+ * (e.g. each Dense layer and the load path) and reports per-image figures.
+ * The counters belong to the thread that created the profiler, so begin() and end() must be called from it;
+ * sections may be registered from any thread (e.g. by a model built on a reload thread).
+ */
+class PerfProfiler
+{
+public:
+    // Methods.
+    /**
+     * Registers a named section (or finds an existing one) and returns its id.
+     *
+     * @param name The name of the section.
+     * @return The id to pass to begin() and end().
+     */
+    int addSection(const std::string &name);
+
+    /**
+     * Starts counting for the given section.
+     *
+     * @param section A section id returned by addSection().
+     */
+    void begin(int section);
+
+    /**
+     * Stops counting for the given section and accumulates the counted events.
+     *
+     * @param section A section id returned by addSection().
+     */
+    void end(int section);
+
+    /**
+     * Adds to the amount of images the per-image figures are divided by.
+     *
+     * @param count The amount of images processed.
+     */
+    void addImages(long count);
+
+    /**
+     * Prints IPC and per-image event counts for every section.
+     *
+     * @param os The output stream.
+     */
+    void report(std::ostream &os) const;
+
+private:
+    struct Section
+    {
+        std::string name;
+        long calls;
+        uint64_t start[PERF_EVENT_COUNT];
+        uint64_t total[PERF_EVENT_COUNT];
+    };
+
+    PerfCounters _counters;
+    std::deque<Section> _sections; // A deque, so registering a section never moves the others.
+    mutable std::mutex _mutex; // Guards _sections against registration from other threads.
+    long _images = 0;
+};
+
+#endif //PERFCOUNTERS_H
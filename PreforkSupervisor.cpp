@@ -0,0 +1,145 @@
+/**
+ * @file PreforkSupervisor.cpp
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Implementation file for the PreforkSupervisor class which serves a MlpNetwork from
+ * several forked worker processes sharing the parent's weights.
+ */
+
+#define ERROR_BAD_WORKERS "Error: Amount of workers must be positive."
+#define ERROR_FORK "Error: Failed to fork a worker."
+#define WORKER_RESTART "Worker exited unexpectedly, restarting: "
+
+#define MIN_WORKER_LIFETIME_S 1
+#define RESTART_BACKOFF_US 1000000
+
+#include <cerrno>
+#include <csignal>
+#include <ctime>
+#include <iostream>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "MemoryPlacement.h"
+#include "PreforkSupervisor.h"
+
+static volatile sig_atomic_t supervisorStopRequested = 0;
+
+// Signal handler which asks run() to stop the workers.
+static void _requestSupervisorStop(int)
+{
+    supervisorStopRequested = 1;
+}
+
+/**
+ * Inits a supervisor for the models of the given registry.
+ *
+ * @param models The registry whose current model is served (already loaded).
+ * @param workers The amount of worker processes.
+ * @param options The options of every worker's server.
+ */
+PreforkSupervisor::PreforkSupervisor(ModelRegistry &models, int workers, const ServerOptions &options)
+        : _models(models), _options(options), _workers(workers > 0 ? workers : 0)
+{
+    if (workers <= 0)
+    {
+        std::cerr << ERROR_BAD_WORKERS << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * Forks the workers and supervises them until SIGINT or SIGTERM arrives,
+ * then stops all workers and waits for them. Reloads the model upon SIGHUP.
+ *
+ * @param listenFd A listening socket (see openListener()).
+ */
+void PreforkSupervisor::run(int listenFd)
+{
+    struct sigaction action = {};
+    action.sa_handler = _requestSupervisorStop;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    ModelRegistry::listenForReloads(true); // Interrupts waitpid.
+
+    std::vector<time_t> started(_workers.size());
+    for (size_t i = 0; i < _workers.size(); i++)
+    {
+        _workers[i] = _forkWorker(listenFd, (int) i);
+        started[i] = time(nullptr);
+    }
+
+    while (!supervisorStopRequested)
+    {
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (ModelRegistry::takeReloadRequest() && _models.reload())
+        {
+            // New workers share the new model, the old ones drain and exit (and are reaped but not replaced).
+            for (size_t i = 0; i < _workers.size(); i++)
+            {
+                pid_t old = _workers[i];
+                _workers[i] = _forkWorker(listenFd, (int) i);
+                started[i] = time(nullptr);
+                kill(old, SIGTERM);
+            }
+        }
+        if (pid < 0)
+        {
+            continue; // Interrupted by a signal.
+        }
+
+        for (size_t i = 0; i < _workers.size(); i++)
+        {
+            if (_workers[i] != pid || supervisorStopRequested)
+            {
+                continue;
+            }
+
+            std::cerr << WORKER_RESTART << pid << std::endl;
+            if (time(nullptr) - started[i] < MIN_WORKER_LIFETIME_S)
+            {
+                usleep(RESTART_BACKOFF_US); // Don't spin if a worker dies right away.
+            }
+            _workers[i] = _forkWorker(listenFd, (int) i);
+            started[i] = time(nullptr);
+        }
+    }
+
+    for (pid_t pid : _workers)
+    {
+        kill(pid, SIGTERM);
+    }
+    for (pid_t pid : _workers)
+    {
+        while (waitpid(pid, nullptr, 0) < 0 && errno == EINTR)
+        {}
+    }
+}
+
+// Forks a single worker process, which serves until it receives SIGTERM (pinned to its core if asked to).
+pid_t PreforkSupervisor::_forkWorker(int listenFd, int index) const
+{
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        std::cerr << ERROR_FORK << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (pid > 0)
+    {
+        return pid;
+    }
+
+    signal(SIGHUP, SIG_IGN); // Reloads are the supervisor's.
+    if (MemoryPlacement::getOptions().pin)
+    {
+        MemoryPlacement::pinWorker(index); // Before the server's threads start, so they inherit it.
+    }
+    InferenceServer server(_models, _options);
+    server.serve(listenFd);
+    std::cerr << "Worker " << getpid() << ": ";
+    server.printStats(std::cerr);
+    _exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,58 @@
+/**
+ * @file PreforkSupervisor.h
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Header file for the PreforkSupervisor class which serves a MlpNetwork from
+ * several forked worker processes sharing the parent's weights.
+ */
+
+#ifndef PREFORKSUPERVISOR_H
+#define PREFORKSUPERVISOR_H
+
+#include <sys/types.h>
+#include <vector>
+
+#include "InferenceServer.h"
+#include "ModelRegistry.h"
+
+/**
+ * The PreforkSupervisor class- forks worker processes that each run an InferenceServer
+ * on a shared listening socket (the kernel spreads connections between them).
+ * The network is loaded once in the supervisor, so workers share its weight pages
+ * copy-on-write, and a crashed worker is replaced by a new fork without touching the disk.
+ * Upon SIGHUP the supervisor reloads the model, then replaces every worker by a fork sharing the new one;
+ * the old workers finish the requests they already read and exit.
+ */
+class PreforkSupervisor
+{
+public:
+    // Constructors.
+    /**
+     * Inits a supervisor for the models of the given registry.
+     *
+     * @param models The registry whose current model is served (already loaded).
+     * @param workers The amount of worker processes.
+     * @param options The options of every worker's server.
+     */
+    PreforkSupervisor(ModelRegistry &models, int workers, const ServerOptions &options);
+
+    // Methods.
+    /**
+     * Forks the workers and supervises them until SIGINT or SIGTERM arrives,
+     * then stops all workers and waits for them. Reloads the model upon SIGHUP.
+     *
+     * @param listenFd A listening socket (see openListener()).
+     */
+    void run(int listenFd);
+
+private:
+    ModelRegistry &_models;
+    const ServerOptions _options;
+    std::vector<pid_t> _workers;
+
+    pid_t _forkWorker(int listenFd, int index) const; // Forks the index'th worker process.
+};
+
+#endif //PREFORKSUPERVISOR_H
@@ -0,0 +1,214 @@
+/**
+ * @file Protocol.cpp
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Implementation file for the socket helpers of the binary protocol spoken between
+ * the inference server and its clients.
+ */
+
+#define ERROR_LISTEN "Error: Failed to listen on: "
+#define ERROR_CONNECT "Error: Failed to connect to: "
+
+#define LOCALHOST "127.0.0.1"
+#define LISTEN_BACKLOG 128
+#define MIN_PORT 1
+#define MAX_PORT 65535
+#define DECIMAL 10
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include "Protocol.h"
+
+// Returns whether the address is a TCP port (only digits).
+static bool _isPort(const std::string &address)
+{
+    return !address.empty() && address.find_first_not_of("0123456789") == std::string::npos;
+}
+
+// Parses a TCP port address, returns false if it is out of range.
+static bool _parsePort(const std::string &address, uint16_t &port)
+{
+    errno = 0;
+    long value = std::strtol(address.c_str(), nullptr, DECIMAL);
+    if (errno == ERANGE || value < MIN_PORT || value > MAX_PORT)
+    {
+        return false;
+    }
+    port = (uint16_t) value;
+    return true;
+}
+
+// Opens a socket for the address and fills its sockaddr, returns -1 on failure.
+static int _openSocket(const std::string &address, sockaddr_storage &addr, socklen_t &length)
+{
+    memset(&addr, 0, sizeof(addr));
+    if (_isPort(address))
+    {
+        uint16_t port;
+        if (!_parsePort(address, port))
+        {
+            errno = EINVAL;
+            return -1;
+        }
+        auto *in = (sockaddr_in *) &addr;
+        in->sin_family = AF_INET;
+        in->sin_port = htons(port);
+        inet_pton(AF_INET, LOCALHOST, &in->sin_addr);
+        length = sizeof(sockaddr_in);
+        return socket(AF_INET, SOCK_STREAM, 0);
+    }
+
+    auto *un = (sockaddr_un *) &addr;
+    if (address.size() >= sizeof(un->sun_path))
+    {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    un->sun_family = AF_UNIX;
+    strcpy(un->sun_path, address.c_str());
+    length = sizeof(sockaddr_un);
+    return socket(AF_UNIX, SOCK_STREAM, 0);
+}
+
+// Disables Nagle's algorithm on TCP sockets (small frames must not wait).
+static void _setNoDelay(int fd, const std::string &address)
+{
+    if (_isPort(address))
+    {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+}
+
+/**
+ * Returns whether an address can be listened on or connected to: a TCP port between 1 and 65535,
+ * or a Unix domain socket path short enough for a sockaddr_un.
+ *
+ * @param address The port or path.
+ * @return true if the address is valid.
+ */
+bool isValidAddress(const std::string &address)
+{
+    uint16_t port;
+    return _isPort(address) ? _parsePort(address, port)
+                            : !address.empty() && address.size() < sizeof(sockaddr_un::sun_path);
+}
+
+/**
+ * Opens a listening socket.
+ * An address made only of digits is a TCP port on localhost, anything else is
+ * a Unix domain socket path (an existing socket file is replaced).
+ * Exits (code == 1) upon failure.
+ *
+ * @param address The port or path to listen on.
+ * @return The listening socket.
+ */
+int openListener(const std::string &address)
+{
+    sockaddr_storage addr;
+    socklen_t length;
+    int fd = _openSocket(address, addr, length);
+    if (fd >= 0)
+    {
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (!_isPort(address))
+        {
+            unlink(address.c_str());
+        }
+    }
+
+    if (fd < 0 || bind(fd, (sockaddr *) &addr, length) != 0 || listen(fd, LISTEN_BACKLOG) != 0)
+    {
+        std::cerr << ERROR_LISTEN << address << " (" << strerror(errno) << ")" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    return fd;
+}
+
+/**
+ * Connects to a listening server, see openListener() for the address format.
+ * Exits (code == 1) upon failure.
+ *
+ * @param address The port or path to connect to.
+ * @return The connected socket.
+ */
+int connectTo(const std::string &address)
+{
+    sockaddr_storage addr;
+    socklen_t length;
+    int fd = _openSocket(address, addr, length);
+    if (fd < 0 || connect(fd, (sockaddr *) &addr, length) != 0)
+    {
+        std::cerr << ERROR_CONNECT << address << " (" << strerror(errno) << ")" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    _setNoDelay(fd, address);
+    return fd;
+}
+
+/**
+ * Reads exactly length bytes (retrying short reads).
+ *
+ * @param fd The file descriptor to read from.
+ * @param buffer The buffer to fill.
+ * @param length Amount of bytes to read.
+ * @return true on success, false on error or end of file.
+ */
+bool readFully(int fd, void *buffer, size_t length)
+{
+    auto *bytes = (char *) buffer;
+    while (length > 0)
+    {
+        ssize_t count = read(fd, bytes, length);
+        if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (count <= 0)
+        {
+            return false;
+        }
+        bytes += count;
+        length -= count;
+    }
+    return true;
+}
+
+/**
+ * Writes exactly length bytes (retrying short writes), never raises SIGPIPE.
+ *
+ * @param fd The file descriptor to write to.
+ * @param buffer The bytes to write.
+ * @param length Amount of bytes to write.
+ * @return true on success, false on error.
+ */
+bool writeFully(int fd, const void *buffer, size_t length)
+{
+    auto *bytes = (const char *) buffer;
+    while (length > 0)
+    {
+        ssize_t count = send(fd, bytes, length, MSG_NOSIGNAL);
+        if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (count <= 0)
+        {
+            return false;
+        }
+        bytes += count;
+        length -= count;
+    }
+    return true;
+}
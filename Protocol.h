@@ -0,0 +1,97 @@
+/**
+ * @file Protocol.h
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Header file for the binary protocol (and socket helpers) spoken between
+ * the inference server and its clients.
+ *
+ * A request is a RequestHeader followed by IMAGE_LENGTH native-endian float32 pixels.
+ * Every request is answered by a single ResponseFrame carrying the same id.
+ * Responses of a connection may arrive in any order.
+ */
+
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#define IMAGE_LENGTH 784
+
+/**
+ * @struct RequestHeader
+ * @brief Precedes the pixels of every request.
+ * @var id - Chosen by the client, echoed in the response
+ */
+typedef struct RequestHeader
+{
+    uint32_t id;
+} RequestHeader;
+
+/**
+ * @struct ResponseFrame
+ * @brief The answer to a single request.
+ * @var id - The id of the answered request
+ * @var value - Identified digit value
+ * @var probability - identification probability
+ */
+typedef struct ResponseFrame
+{
+    uint32_t id;
+    uint32_t value;
+    float probability;
+} ResponseFrame;
+
+/**
+ * Returns whether an address can be listened on or connected to: a TCP port between 1 and 65535,
+ * or a Unix domain socket path short enough for a sockaddr_un.
+ *
+ * @param address The port or path.
+ * @return true if the address is valid.
+ */
+bool isValidAddress(const std::string &address);
+
+/**
+ * Opens a listening socket.
+ * An address made only of digits is a TCP port on localhost, anything else is
+ * a Unix domain socket path (an existing socket file is replaced).
+ * Exits (code == 1) upon failure.
+ *
+ * @param address The port or path to listen on.
+ * @return The listening socket.
+ */
+int openListener(const std::string &address);
+
+/**
+ * Connects to a listening server, see openListener() for the address format.
+ * Exits (code == 1) upon failure.
+ *
+ * @param address The port or path to connect to.
+ * @return The connected socket.
+ */
+int connectTo(const std::string &address);
+
+/**
+ * Reads exactly length bytes (retrying short reads).
+ *
+ * @param fd The file descriptor to read from.
+ * @param buffer The buffer to fill.
+ * @param length Amount of bytes to read.
+ * @return true on success, false on error or end of file.
+ */
+bool readFully(int fd, void *buffer, size_t length);
+
+/**
+ * Writes exactly length bytes (retrying short writes), never raises SIGPIPE.
+ *
+ * @param fd The file descriptor to write to.
+ * @param buffer The bytes to write.
+ * @param length Amount of bytes to write.
+ * @return true on success, false on error.
+ */
+bool writeFully(int fd, const void *buffer, size_t length);
+
+#endif //PROTOCOL_H
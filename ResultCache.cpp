@@ -0,0 +1,153 @@
+/**
+ * @file ResultCache.cpp
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Implementation file for the ResultCache class which remembers the Digit of recently seen images.
+ */
+
+#define ERROR_BAD_CACHE "Error: Cache capacity and shards must be positive."
+
+#define HASH_SEED 0x9E3779B97F4A7C15ULL
+#define HASH_MULTIPLIER_1 0x87C37B91114253D5ULL
+#define HASH_MULTIPLIER_2 0x4CF5AD432745937FULL
+#define FINAL_MULTIPLIER_1 0xFF51AFD7ED558CCDULL
+#define FINAL_MULTIPLIER_2 0xC4CEB9FE1A85EC53ULL
+#define ROTATION 31
+#define WORD_BITS 64
+#define HALF_WORD_BITS 32
+#define FINAL_SHIFT 33
+
+#include <cstring>
+#include "ResultCache.h"
+
+// Rotates a word left.
+static inline uint64_t _rotateLeft(uint64_t word, int bits)
+{
+    return (word << bits) | (word >> (WORD_BITS - bits));
+}
+
+/**
+ * Inits an empty cache.
+ *
+ * @param capacity The maximal amount of cached images (split evenly between the shards).
+ * @param shards The amount of shards.
+ */
+ResultCache::ResultCache(size_t capacity, int shards)
+        : _shards(shards > 0 ? shards : 0),
+          _shardCapacity((shards > 0 && capacity > (size_t) shards) ? capacity / shards : 1),
+          _hits(0), _misses(0)
+{
+    if (capacity == 0 || shards <= 0)
+    {
+        std::cerr << ERROR_BAD_CACHE << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * Returns the hash of an image, which is its key in the cache.
+ * (Murmur3 style mixing over 64 bit words of the raw pixel bytes)
+ *
+ * @param pixels The pixels of the image.
+ * @param length The amount of pixels.
+ * @return The hash of the image.
+ */
+uint64_t ResultCache::hash(const float pixels[], int length)
+{
+    auto *bytes = (const unsigned char *) pixels;
+    size_t byteLength = length * sizeof(float), i = 0;
+    uint64_t hash = HASH_SEED ^ byteLength;
+    for (; i + sizeof(uint64_t) <= byteLength; i += sizeof(uint64_t))
+    {
+        uint64_t word;
+        memcpy(&word, bytes + i, sizeof(word));
+        hash = _rotateLeft(hash ^ (word * HASH_MULTIPLIER_1), ROTATION) * HASH_MULTIPLIER_2;
+    }
+    if (i < byteLength)
+    {
+        uint64_t word = 0;
+        memcpy(&word, bytes + i, byteLength - i);
+        hash = _rotateLeft(hash ^ (word * HASH_MULTIPLIER_1), ROTATION) * HASH_MULTIPLIER_2;
+    }
+
+    hash ^= hash >> FINAL_SHIFT;
+    hash *= FINAL_MULTIPLIER_1;
+    hash ^= hash >> FINAL_SHIFT;
+    hash *= FINAL_MULTIPLIER_2;
+    return hash ^ (hash >> FINAL_SHIFT);
+}
+
+/**
+ * Looks a key up and marks it as recently used.
+ *
+ * @param key The hash of the image.
+ * @param digit Output, the cached Digit of the image.
+ * @return true on a hit.
+ */
+bool ResultCache::lookup(uint64_t key, Digit &digit)
+{
+    Shard &shard = _shardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto found = shard.index.find(key);
+    if (found == shard.index.end())
+    {
+        _misses++;
+        return false;
+    }
+
+    shard.entries.splice(shard.entries.begin(), shard.entries, found->second);
+    digit = found->second->second;
+    _hits++;
+    return true;
+}
+
+/**
+ * Caches the Digit of an image, evicting the least recently used image of its shard if full.
+ *
+ * @param key The hash of the image.
+ * @param digit The Digit of the image.
+ */
+void ResultCache::insert(uint64_t key, const Digit &digit)
+{
+    Shard &shard = _shardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto found = shard.index.find(key);
+    if (found != shard.index.end())
+    {
+        found->second->second = digit;
+        shard.entries.splice(shard.entries.begin(), shard.entries, found->second);
+        return;
+    }
+
+    if (shard.entries.size() >= _shardCapacity)
+    {
+        shard.index.erase(shard.entries.back().first);
+        shard.entries.pop_back();
+    }
+    shard.entries.emplace_front(key, digit);
+    shard.index[key] = shard.entries.begin();
+}
+
+/**
+ * Prints hit and miss counters.
+ *
+ * @param os The output stream.
+ */
+void ResultCache::printStats(std::ostream &os) const
+{
+    long hits = _hits, misses = _misses;
+    os << "Cache hits: " << hits << ", misses: " << misses;
+    if (hits + misses > 0)
+    {
+        os << ", hit rate: " << (100.0 * hits / (hits + misses)) << "%";
+    }
+    os << std::endl;
+}
+
+// Returns the shard responsible for a key (the upper bits, the maps use the lower ones).
+ResultCache::Shard &ResultCache::_shardOf(uint64_t key)
+{
+    return _shards[(key >> HALF_WORD_BITS) % _shards.size()];
+}
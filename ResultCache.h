@@ -0,0 +1,94 @@
+/**
+ * @file ResultCache.h
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Header file for the ResultCache class which remembers the Digit of recently seen images.
+ */
+
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Digit.h"
+
+/**
+ * The ResultCache class- a bounded LRU cache from an image hash to its Digit.
+ * Keys are split between independently locked shards so concurrent lookups rarely contend.
+ * Images are identified by a 64 bit hash of their pixels only (collisions are not checked).
+ */
+class ResultCache
+{
+public:
+    // Constructors.
+    /**
+     * Inits an empty cache.
+     *
+     * @param capacity The maximal amount of cached images (split evenly between the shards).
+     * @param shards The amount of shards.
+     */
+    explicit ResultCache(size_t capacity, int shards = DEFAULT_SHARDS);
+
+    // Methods.
+    /**
+     * Returns the hash of an image, which is its key in the cache.
+     *
+     * @param pixels The pixels of the image.
+     * @param length The amount of pixels.
+     * @return The hash of the image.
+     */
+    static uint64_t hash(const float pixels[], int length);
+
+    /**
+     * Looks a key up and marks it as recently used.
+     *
+     * @param key The hash of the image.
+     * @param digit Output, the cached Digit of the image.
+     * @return true on a hit.
+     */
+    bool lookup(uint64_t key, Digit &digit);
+
+    /**
+     * Caches the Digit of an image, evicting the least recently used image of its shard if full.
+     *
+     * @param key The hash of the image.
+     * @param digit The Digit of the image.
+     */
+    void insert(uint64_t key, const Digit &digit);
+
+    /**
+     * Prints hit and miss counters.
+     *
+     * @param os The output stream.
+     */
+    void printStats(std::ostream &os) const;
+
+    static const int DEFAULT_SHARDS = 16;
+
+private:
+    typedef std::list<std::pair<uint64_t, Digit>> LruList;
+
+    struct Shard
+    {
+        std::mutex mutex;
+        LruList entries; // Most recently used first.
+        std::unordered_map<uint64_t, LruList::iterator> index;
+    };
+
+    std::vector<Shard> _shards;
+    const size_t _shardCapacity;
+    std::atomic<long> _hits, _misses;
+
+    Shard &_shardOf(uint64_t key); // Returns the shard responsible for a key.
+};
+
+#endif //RESULTCACHE_H
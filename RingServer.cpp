@@ -0,0 +1,137 @@
+/**
+ * @file RingServer.cpp
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Implementation file for the RingServer class which serves the images of co-located producers
+ * from a shared memory ring, running the network directly on the ring's slots.
+ */
+
+#define ERROR_BAD_BATCH_SIZE "Error: Maximal batch size must be positive."
+#define SERVING "Serving the shared memory ring (Ctrl+C to stop).."
+
+#define IDLE_SPINS 1024 // Empty polls before the consumer yields its core (to producers sharing it).
+#define IDLE_YIELDS 1024 // Empty polls with yields before the consumer starts sleeping.
+#define IDLE_SLEEP_US 50
+
+// Trace names.
+#define RING_THREAD "ring server"
+#define BATCH_EVENT "run batch"
+#define ANSWER_EVENT "answer"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <thread>
+#include <vector>
+#include "RingServer.h"
+#include "Tracer.h"
+
+static volatile sig_atomic_t stopRequested = 0;
+
+// Signal handler which asks serve() to return.
+static void _requestStop(int)
+{
+    stopRequested = 1;
+}
+
+// Tells the core that this is a busy wait (lets its sibling hyperthread run, saves power).
+static inline void _spinPause()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+/**
+ * Inits a server for the models of the given registry.
+ * Exits (code == 1) if maxBatchSize isn't positive.
+ *
+ * @param models The registry whose current model is served (must outlive the server).
+ * @param maxBatchSize The maximal amount of slots in a single batch.
+ */
+RingServer::RingServer(const ModelRegistry &models, int maxBatchSize)
+        : _models(models), _maxBatchSize(maxBatchSize), _requests(0), _batches(0), _largestBatch(0),
+          _idleSleeps(0)
+{
+    if (maxBatchSize <= 0)
+    {
+        std::cerr << ERROR_BAD_BATCH_SIZE << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * Serves the producers of the given ring until SIGINT or SIGTERM arrives.
+ *
+ * @param ring The ring, created by this process (see ShmRing(name, slots)).
+ */
+void RingServer::serve(ShmRing &ring)
+{
+    struct sigaction action = {};
+    action.sa_handler = _requestStop;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    std::cerr << SERVING << std::endl;
+    Tracer::nameThread(RING_THREAD);
+
+    std::vector<Digit> results(_maxBatchSize);
+    int idle = 0;
+    while (!stopRequested)
+    {
+        const float *frames;
+        int count = ring.takeBatch(_maxBatchSize, frames);
+        if (count == 0)
+        {
+            if (++idle < IDLE_SPINS)
+            {
+                _spinPause();
+            }
+            else if (idle < IDLE_SPINS + IDLE_YIELDS)
+            {
+                std::this_thread::yield();
+            }
+            else
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(IDLE_SLEEP_US));
+                _idleSleeps++;
+            }
+            continue;
+        }
+
+        idle = 0;
+        TraceScope trace(BATCH_EVENT, TRACE_BATCH, count);
+        std::shared_ptr<const Model> model = _models.acquire(); // A reloaded model takes over from the next batch.
+        model->predictBatch(MatrixView(frames, count, IMAGE_LENGTH, IMAGE_LENGTH), results.data());
+        {
+            TraceScope answer(ANSWER_EVENT, TRACE_OUTPUT, count);
+            ring.answer(count, results.data());
+        }
+
+        _requests += count;
+        _batches++;
+        _largestBatch = std::max(_largestBatch, (long) count);
+    }
+}
+
+/**
+ * Prints the amount of served images and batches (and cascade counters).
+ *
+ * @param os The output stream.
+ */
+void RingServer::printStats(std::ostream &os) const
+{
+    os << "Requests: " << _requests << ", batches: " << _batches;
+    if (_batches > 0)
+    {
+        os << ", mean batch size: " << (double) _requests / _batches
+           << ", largest batch: " << _largestBatch;
+    }
+    os << ", idle sleeps: " << _idleSleeps << std::endl;
+    std::shared_ptr<const Model> model = _models.acquire();
+    if (model->getCascade() != nullptr)
+    {
+        model->getCascade()->printStats(os);
+    }
+}
@@ -0,0 +1,63 @@
+/**
+ * @file RingServer.h
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Header file for the RingServer class which serves the images of co-located producers
+ * from a shared memory ring, running the network directly on the ring's slots.
+ */
+
+#ifndef RINGSERVER_H
+#define RINGSERVER_H
+
+#include <iostream>
+#include "ModelRegistry.h"
+#include "ShmRing.h"
+
+/**
+ * The RingServer class- the consumer of a ShmRing. Takes every run of published slots (up to
+ * maxBatchSize) as a batch, runs the current model of a ModelRegistry on the frames where they lie
+ * and answers into the slots. There is no queue delay: a batch is whatever was published since the
+ * previous one, so batches grow with the load by themselves. While the ring has work no system call
+ * is made; an idle ring is polled with a short spin, then with yields, then with short sleeps.
+ */
+class RingServer
+{
+public:
+    // Constructors.
+    /**
+     * Inits a server for the models of the given registry.
+     * Exits (code == 1) if maxBatchSize isn't positive.
+     *
+     * @param models The registry whose current model is served (must outlive the server).
+     * @param maxBatchSize The maximal amount of slots in a single batch.
+     */
+    RingServer(const ModelRegistry &models, int maxBatchSize);
+
+    RingServer(const RingServer &other) = delete;
+
+    RingServer &operator=(const RingServer &other) = delete;
+
+    // Methods.
+    /**
+     * Serves the producers of the given ring until SIGINT or SIGTERM arrives.
+     *
+     * @param ring The ring, created by this process (see ShmRing(name, slots)).
+     */
+    void serve(ShmRing &ring);
+
+    /**
+     * Prints the amount of served images and batches (and cascade counters).
+     *
+     * @param os The output stream.
+     */
+    void printStats(std::ostream &os) const;
+
+private:
+    const ModelRegistry &_models;
+    const int _maxBatchSize;
+    long _requests, _batches, _largestBatch, _idleSleeps;
+};
+
+#endif //RINGSERVER_H
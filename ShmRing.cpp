@@ -0,0 +1,299 @@
+/**
+ * @file ShmRing.cpp
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Implementation file for the ShmRing class, a ring of image slots in POSIX shared memory through which
+ * co-located producers hand images to the network and get their results back without system calls.
+ */
+
+#define ERROR_BAD_SLOTS "Error: The amount of ring slots must be a power of 2, at least 4."
+#define ERROR_CREATE_RING "Error: Failed to create the shared memory ring: "
+#define ERROR_OPEN_RING "Error: No shared memory ring of the name: "
+#define ERROR_BAD_RING "Error: Not a shared memory ring of this network: "
+
+#define RING_MAGIC "MLPRING1"
+#define RING_MAGIC_LENGTH 8
+#define RING_MODE 0600
+#define MIN_SLOTS 4
+#define CACHE_LINE 64
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ImageLoader.h"
+#include "ShmRing.h"
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Ring positions must be lock free to be shared");
+
+/**
+ * The first cache lines of the segment. The head is shared by the producers,
+ * the tail is written by the consumer only; each has its own line.
+ */
+struct ShmRing::Header
+{
+    char magic[RING_MAGIC_LENGTH];
+    uint32_t slots;
+    uint32_t frameLength;
+    alignas(CACHE_LINE) std::atomic<uint64_t> head; // The position the next slot is claimed at.
+    alignas(CACHE_LINE) std::atomic<uint64_t> tail; // The position of the next slot the consumer takes.
+};
+
+/**
+ * The state and response of a slot (a cache line each, so neighbouring producers don't share one).
+ */
+struct alignas(CACHE_LINE) ShmRing::Slot
+{
+    std::atomic<uint64_t> sequence;
+    uint32_t id;
+    uint32_t format;
+    ResponseFrame response;
+};
+
+// Adds the leading '/' shm_open() expects.
+static std::string _segmentName(const std::string &name)
+{
+    return (!name.empty() && name[0] == '/') ? name : "/" + name;
+}
+
+// Where a producer writes the bytes of a byte frame: its last IMAGE_LENGTH bytes, so they are
+// normalized into the frame in place (see normalizePixels()).
+static unsigned char *_byteFrame(float frame[])
+{
+    return (unsigned char *) frame + IMAGE_LENGTH * (sizeof(float) - 1);
+}
+
+/**
+ * Creates the shared memory segment of a ring (replacing a stale one of the same name),
+ * as its consumer. The segment is removed when the consumer's ring is destroyed.
+ * Exits (code == 1) upon failure, or if slots isn't a power of 2 (at least 4).
+ *
+ * @param name The name of the segment (shm_open() style, a leading '/' is added if missing).
+ * @param slots The amount of slots.
+ */
+ShmRing::ShmRing(const std::string &name, int slots)
+        : _name(_segmentName(name)), _owner(true), _size(_sizeFor((uint64_t) slots))
+{
+    if (slots < MIN_SLOTS || (slots & (slots - 1)) != 0)
+    {
+        std::cerr << ERROR_BAD_SLOTS << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    shm_unlink(_name.c_str());
+    int fd = shm_open(_name.c_str(), O_CREAT | O_EXCL | O_RDWR, RING_MODE);
+    if (fd < 0 || ftruncate(fd, (off_t) _size) != 0)
+    {
+        std::cerr << ERROR_CREATE_RING << name << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    _map(fd, _size);
+
+    // A fresh segment is zeroed: every slot is free for the first lap once its sequence is its index.
+    new(_header) Header();
+    _header->slots = (uint32_t) slots;
+    _header->frameLength = IMAGE_LENGTH;
+    for (int i = 0; i < slots; i++)
+    {
+        new(_slots + i) Slot();
+        _slots[i].sequence.store((uint64_t) i, std::memory_order_relaxed);
+    }
+    _mask = (uint64_t) slots - 1;
+    _frames = (float *) (_slots + slots);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(_header->magic, RING_MAGIC, RING_MAGIC_LENGTH);
+}
+
+/**
+ * Maps the shared memory segment of an existing ring, as a producer.
+ * Exits (code == 1) if there is no such ring.
+ *
+ * @param name The name of the segment.
+ */
+ShmRing::ShmRing(const std::string &name) : _name(_segmentName(name)), _owner(false)
+{
+    int fd = shm_open(_name.c_str(), O_RDWR, 0);
+    struct stat status = {};
+    if (fd < 0 || fstat(fd, &status) != 0 || (size_t) status.st_size < sizeof(Header))
+    {
+        std::cerr << ERROR_OPEN_RING << name << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    _size = (size_t) status.st_size;
+    _map(fd, _size);
+
+    uint64_t slots = _header->slots;
+    if (memcmp(_header->magic, RING_MAGIC, RING_MAGIC_LENGTH) != 0 || _header->frameLength != IMAGE_LENGTH ||
+        slots < MIN_SLOTS || (slots & (slots - 1)) != 0 || _sizeFor(slots) != _size)
+    {
+        std::cerr << ERROR_BAD_RING << name << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    _mask = slots - 1;
+    _frames = (float *) (_slots + slots);
+}
+
+/**
+ * Unmaps the ring (and removes its segment if this is the consumer).
+ */
+ShmRing::~ShmRing()
+{
+    munmap(_mapping, _size);
+    if (_owner)
+    {
+        shm_unlink(_name.c_str());
+    }
+}
+
+/**
+ * Claims the next free slot for an image in the given format.
+ *
+ * @param format The format of the pixels the producer writes.
+ * @param ticket Output, the position of the claimed slot (see publish() and collect()).
+ * @return Where to write IMAGE_LENGTH pixels of the format, nullptr if the ring is full.
+ */
+void *ShmRing::claim(FrameFormat format, uint64_t &ticket)
+{
+    uint64_t position = _header->head.load(std::memory_order_relaxed);
+    while (true)
+    {
+        Slot &slot = _slots[position & _mask];
+        uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence == position)
+        {
+            // Free for this lap, ours if no other producer moved the head first (else position is reloaded).
+            if (_header->head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (sequence < position)
+        {
+            return nullptr; // Still in use from the previous lap.
+        }
+        else
+        {
+            position = _header->head.load(std::memory_order_relaxed);
+        }
+    }
+
+    ticket = position;
+    _slots[position & _mask].format = format;
+    float *frame = _frames + (position & _mask) * IMAGE_LENGTH;
+    return (format == ByteFrame) ? (void *) _byteFrame(frame) : (void *) frame;
+}
+
+/**
+ * Hands a claimed slot, whose pixels were written, to the consumer.
+ *
+ * @param ticket The position of the slot (see claim()).
+ * @param id The id the response carries.
+ */
+void ShmRing::publish(uint64_t ticket, uint32_t id)
+{
+    Slot &slot = _slots[ticket & _mask];
+    slot.id = id;
+    slot.sequence.store(ticket + 1, std::memory_order_release);
+}
+
+/**
+ * Takes the response of a published slot once it was answered, and frees the slot.
+ *
+ * @param ticket The position of the slot (see claim()).
+ * @param response Output, the response.
+ * @return false (response unchanged) if the slot wasn't answered yet.
+ */
+bool ShmRing::collect(uint64_t ticket, ResponseFrame &response)
+{
+    Slot &slot = _slots[ticket & _mask];
+    if (slot.sequence.load(std::memory_order_acquire) != ticket + 2)
+    {
+        return false;
+    }
+    response = slot.response;
+    slot.sequence.store(ticket + _mask + 1, std::memory_order_release);
+    return true;
+}
+
+/**
+ * Takes the run of published slots at the tail of the ring, in order and up to its end
+ * (a run never wraps around). Byte frames are normalized in place.
+ *
+ * @param maxCount The maximal amount of slots to take.
+ * @param frames Output, the first frame of the run, the others follow it (IMAGE_LENGTH floats each).
+ * @return The amount of slots taken (0 if the tail slot wasn't published yet).
+ */
+int ShmRing::takeBatch(int maxCount, const float *&frames)
+{
+    uint64_t tail = _header->tail.load(std::memory_order_relaxed);
+    uint64_t first = tail & _mask;
+    int limit = (int) std::min((uint64_t) maxCount, _mask + 1 - first);
+    int count = 0;
+    while (count < limit && _slots[first + count].sequence.load(std::memory_order_acquire) == tail + count + 1)
+    {
+        if (_slots[first + count].format == ByteFrame)
+        {
+            float *frame = _frames + (first + count) * IMAGE_LENGTH;
+            normalizePixels(_byteFrame(frame), IMAGE_LENGTH, frame);
+        }
+        count++;
+    }
+    frames = _frames + first * IMAGE_LENGTH;
+    return count;
+}
+
+/**
+ * Answers the slots of the last takeBatch(), and moves the tail past them.
+ *
+ * @param count The amount of slots taken.
+ * @param results The result of every slot, in order.
+ */
+void ShmRing::answer(int count, const Digit results[])
+{
+    uint64_t tail = _header->tail.load(std::memory_order_relaxed);
+    for (int i = 0; i < count; i++)
+    {
+        Slot &slot = _slots[(tail + i) & _mask];
+        slot.response = {slot.id, results[i].value, results[i].probability};
+        slot.sequence.store(tail + i + 2, std::memory_order_release);
+    }
+    _header->tail.store(tail + count, std::memory_order_relaxed);
+}
+
+/**
+ * Returns the amount of slots of the ring.
+ *
+ * @return The amount of slots.
+ */
+int ShmRing::getSlots() const
+{
+    return (int) (_mask + 1);
+}
+
+// Maps the segment of the given size and points the header and slots into it.
+void ShmRing::_map(int fd, size_t size)
+{
+    // Populated up front, so the fast path doesn't take page faults either.
+    _mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (_mapping == MAP_FAILED)
+    {
+        std::cerr << ERROR_OPEN_RING << _name << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    _header = (Header *) _mapping;
+    _slots = (Slot *) ((char *) _mapping + sizeof(Header));
+}
+
+// The size of the segment of a ring.
+size_t ShmRing::_sizeFor(uint64_t slots)
+{
+    return sizeof(Header) + (size_t) slots * (sizeof(Slot) + IMAGE_LENGTH * sizeof(float));
+}
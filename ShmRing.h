@@ -0,0 +1,155 @@
+/**
+ * @file ShmRing.h
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Header file for the ShmRing class, a ring of image slots in POSIX shared memory through which
+ * co-located producers hand images to the network and get their results back without system calls.
+ */
+
+#ifndef SHMRING_H
+#define SHMRING_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "Digit.h"
+#include "Protocol.h"
+
+#define DEFAULT_RING_SLOTS 256
+
+/**
+ * @enum FrameFormat
+ * @brief Indicator of the pixels a producer wrote into a slot.
+ */
+enum FrameFormat
+{
+    FloatFrame, // IMAGE_LENGTH float32, already the network's input.
+    ByteFrame // IMAGE_LENGTH uint8 (normalized by the consumer, in place).
+};
+
+/**
+ * The ShmRing class- a multi-producer, single-consumer ring of slots in a named shared memory
+ * segment (shm_open), mapped by the consumer and by any amount of producer processes.
+ * Every slot has an image frame and a companion response. The frames of all slots lie back to back,
+ * so the consumer runs the network on a run of consecutive published slots in place, with no copy.
+ *
+ * A slot goes through 4 states, told by its sequence number relative to the position (ticket) it
+ * was claimed at: free (ticket), published (ticket + 1), answered (ticket + 2), and free again for
+ * the next lap (ticket + slots) once its producer collected the response. Every transition is a single
+ * atomic store, claiming a slot is a compare-and-swap of the shared head; nothing blocks in the kernel.
+ * A producer which claims a slot must publish it, and collect its response, before the ring
+ * wraps around to it again (the consumer waits for it in order).
+ *
+ * Producer:
+ *   ShmRing ring("mlp"); uint64_t ticket; float *frame = (float *) ring.claim(FloatFrame, ticket);
+ *   ... write the pixels into frame ...; ring.publish(ticket, id); ... ring.collect(ticket, response);
+ * Consumer:
+ *   ShmRing ring("mlp", slots); const float *frames; int count = ring.takeBatch(max, frames);
+ *   ... run the network on frames ...; ring.answer(count, results);
+ */
+class ShmRing
+{
+public:
+    // Constructors.
+    /**
+     * Creates the shared memory segment of a ring (replacing a stale one of the same name),
+     * as its consumer. The segment is removed when the consumer's ring is destroyed.
+     * Exits (code == 1) upon failure, or if slots isn't a power of 2 (at least 4).
+     *
+     * @param name The name of the segment (shm_open() style, a leading '/' is added if missing).
+     * @param slots The amount of slots.
+     */
+    ShmRing(const std::string &name, int slots);
+
+    /**
+     * Maps the shared memory segment of an existing ring, as a producer.
+     * Exits (code == 1) if there is no such ring.
+     *
+     * @param name The name of the segment.
+     */
+    explicit ShmRing(const std::string &name);
+
+    /**
+     * Unmaps the ring (and removes its segment if this is the consumer).
+     */
+    ~ShmRing();
+
+    ShmRing(const ShmRing &other) = delete;
+
+    ShmRing &operator=(const ShmRing &other) = delete;
+
+    // Producer methods.
+    /**
+     * Claims the next free slot for an image in the given format.
+     *
+     * @param format The format of the pixels the producer writes.
+     * @param ticket Output, the position of the claimed slot (see publish() and collect()).
+     * @return Where to write IMAGE_LENGTH pixels of the format, nullptr if the ring is full.
+     */
+    void *claim(FrameFormat format, uint64_t &ticket);
+
+    /**
+     * Hands a claimed slot, whose pixels were written, to the consumer.
+     *
+     * @param ticket The position of the slot (see claim()).
+     * @param id The id the response carries.
+     */
+    void publish(uint64_t ticket, uint32_t id);
+
+    /**
+     * Takes the response of a published slot once it was answered, and frees the slot.
+     *
+     * @param ticket The position of the slot (see claim()).
+     * @param response Output, the response.
+     * @return false (response unchanged) if the slot wasn't answered yet.
+     */
+    bool collect(uint64_t ticket, ResponseFrame &response);
+
+    // Consumer methods.
+    /**
+     * Takes the run of published slots at the tail of the ring, in order and up to its end
+     * (a run never wraps around). Byte frames are normalized in place.
+     *
+     * @param maxCount The maximal amount of slots to take.
+     * @param frames Output, the first frame of the run, the others follow it (IMAGE_LENGTH floats each).
+     * @return The amount of slots taken (0 if the tail slot wasn't published yet).
+     */
+    int takeBatch(int maxCount, const float *&frames);
+
+    /**
+     * Answers the slots of the last takeBatch(), and moves the tail past them.
+     *
+     * @param count The amount of slots taken.
+     * @param results The result of every slot, in order.
+     */
+    void answer(int count, const Digit results[]);
+
+    /**
+     * Returns the amount of slots of the ring.
+     *
+     * @return The amount of slots.
+     */
+    int getSlots() const;
+
+private:
+    struct Header;
+    struct Slot;
+
+    std::string _name;
+    bool _owner;
+    size_t _size;
+    void *_mapping;
+    Header *_header;
+    Slot *_slots;
+    float *_frames;
+    uint64_t _mask;
+
+    // Maps the segment of the given size and points the header and slots into it.
+    void _map(int fd, size_t size);
+
+    static size_t _sizeFor(uint64_t slots); // The size of the segment of a ring.
+};
+
+#endif //SHMRING_H
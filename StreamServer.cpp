@@ -0,0 +1,271 @@
+/**
+ * @file StreamServer.cpp
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Implementation file for the StreamServer class which runs the network on a stream of framed
+ * images (i.e. stdin) and writes a compact record per image to another stream (i.e. stdout), in batches.
+ */
+
+#define ERROR_BAD_BATCH_SIZE "Error: Maximal batch size must be positive."
+#define ERROR_BAD_FRAME "Error: corrupt stream, a frame claims more than the maximal frame length: "
+#define ERROR_TRUNCATED_FRAME "Error: the stream ended in the middle of a frame"
+#define ERROR_STREAM_WRITE "Error: failed to write the stream's records"
+
+#define INPUT_BUFFER_BYTES (2 * MAX_STREAM_FRAME) // Holds any frame (and its length) whole.
+#define OUTPUT_BUFFER_BYTES (1 << 20)
+#define TEXT_RECORD_BYTES 22 // "%010u %c %.6f\n", the probability is at most 1.
+#define INVALID_TEXT_DIGIT '-'
+
+// Trace names.
+#define STREAM_THREAD "stream"
+#define BATCH_EVENT "run batch"
+#define WRITE_EVENT "write records"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <poll.h>
+#include <unistd.h>
+#include "ImageLoader.h"
+#include "Protocol.h"
+#include "StreamServer.h"
+#include "Tracer.h"
+
+// Returns whether a read of fd wouldn't block (data, its end or an error is ready).
+static bool _readable(int fd)
+{
+    struct pollfd request = {fd, POLLIN, 0};
+    return poll(&request, 1, 0) > 0;
+}
+
+/**
+ * Inits a server for the models of the given registry.
+ * Exits (code == 1) if maxBatchSize isn't positive.
+ *
+ * @param models The registry whose current model is served (must outlive the server).
+ * @param maxBatchSize The maximal amount of frames in a single batch.
+ * @param format How records are written.
+ */
+StreamServer::StreamServer(const ModelRegistry &models, int maxBatchSize, StreamFormat format)
+        : _models(models), _maxBatchSize(maxBatchSize), _format(format), _frames(0), _invalid(0), _batches(0),
+          _largestBatch(0), _input(INPUT_BUFFER_BYTES), _inputStart(0), _inputEnd(0), _output(OUTPUT_BUFFER_BYTES),
+          _outputLength(0)
+{
+    if (maxBatchSize <= 0)
+    {
+        std::cerr << ERROR_BAD_BATCH_SIZE << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * Takes the next buffered frame into pixels. (Private method)
+ * Exits (code == 1) if the frame is longer than MAX_STREAM_FRAME.
+ *
+ * @param pixels Output, IMAGE_LENGTH pixels (0 if the frame is invalid).
+ * @param valid Output, whether the frame is an image.
+ * @return false if the frame isn't fully buffered (nothing is taken).
+ */
+bool StreamServer::_takeFrame(float pixels[], bool &valid)
+{
+    uint32_t length;
+    if (_inputEnd - _inputStart < sizeof(length))
+    {
+        return false;
+    }
+    std::memcpy(&length, _input.data() + _inputStart, sizeof(length));
+    if (length > MAX_STREAM_FRAME)
+    {
+        std::cerr << ERROR_BAD_FRAME << length << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (_inputEnd - _inputStart < sizeof(length) + length)
+    {
+        return false;
+    }
+
+    const char *image = _input.data() + _inputStart + sizeof(length);
+    valid = true;
+    if (length == IMAGE_LENGTH * sizeof(float))
+    {
+        std::memcpy(pixels, image, length);
+    }
+    else if (length == IMAGE_LENGTH)
+    {
+        normalizePixels((const unsigned char *) image, IMAGE_LENGTH, pixels);
+    }
+    else
+    {
+        std::fill(pixels, pixels + IMAGE_LENGTH, 0.0f);
+        valid = false;
+    }
+    _inputStart += sizeof(length) + length;
+    return true;
+}
+
+/**
+ * Reads more input, after the bytes not taken yet (moved to the start of the buffer). (Private method)
+ *
+ * @param in The input file descriptor.
+ * @return false at the end of the input (or upon a read error).
+ */
+bool StreamServer::_fill(int in)
+{
+    std::memmove(_input.data(), _input.data() + _inputStart, _inputEnd - _inputStart);
+    _inputEnd -= _inputStart;
+    _inputStart = 0;
+    ssize_t count;
+    do
+    {
+        count = read(in, _input.data() + _inputEnd, _input.size() - _inputEnd);
+    } while (count < 0 && errno == EINTR);
+    if (count <= 0)
+    {
+        return false;
+    }
+    _inputEnd += count;
+    return true;
+}
+
+/**
+ * Appends the record of a frame, writing the buffered records first if they fill the buffer.
+ * (Private method)
+ *
+ * @param digit The result of the frame.
+ * @param valid Whether the frame is an image.
+ * @param out The output file descriptor.
+ */
+void StreamServer::_record(const Digit &digit, bool valid, int out)
+{
+    if (_outputLength + std::max(sizeof(StreamRecord), (size_t) TEXT_RECORD_BYTES) > _output.size())
+    {
+        _flush(out);
+    }
+    char *record = _output.data() + _outputLength;
+    if (_format == BinaryStream)
+    {
+        StreamRecord binary = {(uint32_t) _frames, valid ? digit.value : STREAM_INVALID,
+                               valid ? digit.probability : 0.0f};
+        std::memcpy(record, &binary, sizeof(binary));
+        _outputLength += sizeof(binary);
+    }
+    else
+    {
+        // snprintf needs room for its terminating NUL, which the next record overwrites.
+        char value = valid ? (char) ('0' + digit.value) : INVALID_TEXT_DIGIT;
+        _outputLength += std::snprintf(record, TEXT_RECORD_BYTES + 1, "%010u %c %.6f\n", (uint32_t) _frames, value,
+                                       valid ? digit.probability : 0.0f);
+    }
+    _frames++;
+    _invalid += !valid;
+}
+
+/**
+ * Writes the buffered records. (Private method)
+ * Exits (code == 1) if the output can't be written.
+ *
+ * @param out The output file descriptor.
+ */
+void StreamServer::_flush(int out)
+{
+    TraceScope trace(WRITE_EVENT, TRACE_OUTPUT);
+    const char *bytes = _output.data();
+    size_t length = _outputLength;
+    while (length > 0)
+    {
+        ssize_t count = write(out, bytes, length);
+        if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (count <= 0)
+        {
+            std::cerr << ERROR_STREAM_WRITE << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        bytes += count;
+        length -= count;
+    }
+    _outputLength = 0;
+}
+
+/**
+ * Answers every frame of the input until it ends.
+ * Exits (code == 1) upon a corrupt or truncated frame, or if the output can't be written.
+ *
+ * @param in The input file descriptor.
+ * @param out The output file descriptor.
+ */
+void StreamServer::serve(int in, int out)
+{
+    Tracer::nameThread(STREAM_THREAD);
+    Matrix batch(_maxBatchSize, IMAGE_LENGTH);
+    std::vector<Digit> results(_maxBatchSize);
+    std::unique_ptr<bool[]> valid(new bool[_maxBatchSize]);
+    int count = 0;
+    bool ended = false;
+    while (!ended || count > 0)
+    {
+        while (count < _maxBatchSize && _takeFrame(batch.data() + (size_t) count * IMAGE_LENGTH, valid[count]))
+        {
+            count++;
+        }
+
+        // A full batch, or a partial one that would otherwise wait for input.
+        bool waiting = ended || !_readable(in);
+        if (count == _maxBatchSize || (count > 0 && waiting))
+        {
+            {
+                TraceScope trace(BATCH_EVENT, TRACE_BATCH, count);
+                std::shared_ptr<const Model> model = _models.acquire(); // A reloaded model takes over.
+                model->predictBatch(batch.view().rowRange(0, count), results.data());
+            }
+            for (int i = 0; i < count; i++)
+            {
+                _record(results[i], valid[i], out);
+            }
+            _batches++;
+            _largestBatch = std::max(_largestBatch, (long) count);
+            count = 0;
+            continue;
+        }
+        if (waiting)
+        {
+            _flush(out); // Before blocking, the consumer may be waiting for these records.
+        }
+        if (!ended)
+        {
+            ended = !_fill(in);
+        }
+    }
+    _flush(out);
+    if (_inputEnd != _inputStart)
+    {
+        std::cerr << ERROR_TRUNCATED_FRAME << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * Prints the amount of answered frames, invalid frames and batches (and cascade counters).
+ *
+ * @param os The output stream.
+ */
+void StreamServer::printStats(std::ostream &os) const
+{
+    os << "Frames: " << _frames << ", invalid: " << _invalid << ", batches: " << _batches;
+    if (_batches > 0)
+    {
+        os << ", mean batch size: " << (double) _frames / _batches << ", largest batch: " << _largestBatch;
+    }
+    os << std::endl;
+    std::shared_ptr<const Model> model = _models.acquire();
+    if (model->getCascade() != nullptr)
+    {
+        model->getCascade()->printStats(os);
+    }
+}
@@ -0,0 +1,113 @@
+/**
+ * @file StreamServer.h
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Header file for the StreamServer class which runs the network on a stream of framed images
+ * (i.e. stdin) and writes a compact record per image to another stream (i.e. stdout), in batches.
+ *
+ * Every frame is a native-endian uint32 byte length followed by the image: IMAGE_LENGTH float32 pixels
+ * (used as is) or IMAGE_LENGTH uint8 pixels (normalized into [0, 1]). Frames of any other length
+ * (at most MAX_STREAM_FRAME bytes) are skipped and answered as invalid.
+ * Every frame is answered by a record, in the order of the frames.
+ */
+
+#ifndef STREAMSERVER_H
+#define STREAMSERVER_H
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "ModelRegistry.h"
+
+#define MAX_STREAM_FRAME (1 << 20) // Longer frames are taken for a corrupt stream.
+#define STREAM_INVALID UINT32_MAX // The value of the record of an invalid frame.
+
+/**
+ * @enum StreamFormat
+ * @brief How the records of a stream are written.
+ */
+enum StreamFormat
+{
+    BinaryStream, // A StreamRecord per frame.
+    TextStream // A fixed width line per frame: "index digit probability" ("-" digit if invalid).
+};
+
+/**
+ * @struct StreamRecord
+ * @brief The binary answer to a single frame.
+ * @var index - Index of the frame in the stream (counted from 0)
+ * @var value - Identified digit value (STREAM_INVALID for an invalid frame)
+ * @var probability - identification probability (0 for an invalid frame)
+ */
+typedef struct StreamRecord
+{
+    uint32_t index;
+    uint32_t value;
+    float probability;
+} StreamRecord;
+
+/**
+ * The StreamServer class- reads frames with large reads, gathers them into batches of up to
+ * maxBatchSize, runs the current model of a ModelRegistry on every batch and buffers the records,
+ * writing them with large writes. A partial batch is run (and the records written) as soon as
+ * no more input is ready, so a slow producer isn't kept waiting for a full batch.
+ */
+class StreamServer
+{
+public:
+    // Constructors.
+    /**
+     * Inits a server for the models of the given registry.
+     * Exits (code == 1) if maxBatchSize isn't positive.
+     *
+     * @param models The registry whose current model is served (must outlive the server).
+     * @param maxBatchSize The maximal amount of frames in a single batch.
+     * @param format How records are written.
+     */
+    StreamServer(const ModelRegistry &models, int maxBatchSize, StreamFormat format);
+    StreamServer(const StreamServer &other) = delete;
+    StreamServer &operator=(const StreamServer &other) = delete;
+
+    // Methods.
+    /**
+     * Answers every frame of the input until it ends.
+     * Exits (code == 1) upon a corrupt or truncated frame, or if the output can't be written.
+     *
+     * @param in The input file descriptor.
+     * @param out The output file descriptor.
+     */
+    void serve(int in, int out);
+
+    /**
+     * Prints the amount of answered frames, invalid frames and batches (and cascade counters).
+     *
+     * @param os The output stream.
+     */
+    void printStats(std::ostream &os) const;
+
+private:
+    const ModelRegistry &_models;
+    const int _maxBatchSize;
+    const StreamFormat _format;
+    long _frames, _invalid, _batches, _largestBatch;
+    std::vector<char> _input; // Bytes read but not taken yet are _input[_inputStart, _inputEnd).
+    size_t _inputStart, _inputEnd;
+    std::vector<char> _output; // Records not written yet are _output[0, _outputLength).
+    size_t _outputLength;
+
+    // Takes the next buffered frame into pixels, returns false if it isn't fully buffered.
+    bool _takeFrame(float pixels[], bool &valid);
+
+    // Reads more input, returns false at its end.
+    bool _fill(int in);
+
+    // Appends the record of a frame.
+    void _record(const Digit &digit, bool valid, int out);
+
+    // Writes the buffered records.
+    void _flush(int out);
+};
+
+#endif //STREAMSERVER_H
@@ -0,0 +1,203 @@
+/**
+ * @file StripReader.cpp
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Implementation file for the StripReader class which reads the sequence of digits written along
+ * a wide image, by running the network on every window of it as one batch.
+ */
+
+#define ERROR_BAD_STRIP "Error: a strip must be at least an image in size, with a positive stride"
+#define READ_STRIP_EVENT "read strip"
+#define MARGIN 4 // Columns on each side of a window which are empty in a centered digit.
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include "StripReader.h"
+#include "Tracer.h"
+
+// Returns the positions of the windows along an axis of length pixels: every stride, and the last
+// one at the edge.
+static std::vector<int> _positions(int length, int window, int stride)
+{
+    std::vector<int> positions;
+    for (int position = 0; position + window <= length; position += stride)
+    {
+        positions.push_back(position);
+    }
+    if (positions.back() + window != length)
+    {
+        positions.push_back(length - window);
+    }
+    return positions;
+}
+
+/**
+ * Constructs a reader of rows * cols strips.
+ * Exits (code == 1) if the strip is smaller than an image or the stride isn't positive.
+ *
+ * @param rows The rows of a strip.
+ * @param cols The columns of a strip.
+ * @param options How strips are scanned.
+ */
+StripReader::StripReader(int rows, int cols, const StripOptions &options) : _rows(rows), _cols(cols),
+                                                                              _options(options)
+{
+    if (rows < imgDims.rows || cols < imgDims.cols || options.stride <= 0)
+    {
+        std::cerr << ERROR_BAD_STRIP << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    _windowRows = _positions(rows, imgDims.rows, options.stride);
+    _windowCols = _positions(cols, imgDims.cols, options.stride);
+    _batch = Matrix(getWindows(), imgDims.rows * imgDims.cols);
+    _results.resize(getWindows());
+    size_t tableLength = (size_t) (rows + 1) * (cols + 1);
+    _ink.resize(tableLength);
+    _inkRows.resize(tableLength);
+    _inkCols.resize(tableLength);
+}
+
+/**
+ * Returns the amount of windows of a strip.
+ *
+ * @return The amount of windows.
+ */
+int StripReader::getWindows() const
+{
+    return (int) (_windowRows.size() * _windowCols.size());
+}
+
+/**
+ * Returns the amount of candidate windows of the last strip read.
+ *
+ * @return The amount of candidates, at most getWindows().
+ */
+int StripReader::getCandidates() const
+{
+    return (int) _candidates.size();
+}
+
+/**
+ * Fills the summed area tables of a strip. (Private method)
+ *
+ * @param pixels The strip.
+ */
+void StripReader::_sumAreas(const float pixels[])
+{
+    size_t stride = (size_t) _cols + 1;
+    for (int i = 0; i < _rows; i++)
+    {
+        double ink = 0.0, inkRows = 0.0, inkCols = 0.0; // Of the row so far.
+        for (int j = 0; j < _cols; j++)
+        {
+            double pixel = pixels[(size_t) i * _cols + j];
+            ink += pixel;
+            inkRows += pixel * i;
+            inkCols += pixel * j;
+            size_t cell = (i + 1) * stride + j + 1;
+            _ink[cell] = _ink[cell - stride] + ink;
+            _inkRows[cell] = _inkRows[cell - stride] + inkRows;
+            _inkCols[cell] = _inkCols[cell - stride] + inkCols;
+        }
+    }
+}
+
+/**
+ * Returns the sum of a table over the rows * cols area whose top left pixel is row, col. (Private method)
+ *
+ * @param table The summed area table.
+ * @param row The top row of the area.
+ * @param col The left column of the area.
+ * @param rows The rows of the area.
+ * @param cols The columns of the area.
+ * @return The sum.
+ */
+double StripReader::_areaSum(const std::vector<double> &table, int row, int col, int rows, int cols) const
+{
+    size_t stride = (size_t) _cols + 1;
+    size_t top = row * stride, bottom = (row + rows) * stride;
+    return table[bottom + col + cols] - table[bottom + col] - table[top + col + cols] + table[top + col];
+}
+
+/**
+ * Reads the digits of a strip.
+ *
+ * @param model The model to run on the windows.
+ * @param pixels The strip, rows * cols pixels row after row.
+ * @return The digits read, left to right.
+ */
+std::vector<StripDigit> StripReader::read(const Model &model, const float pixels[])
+{
+    TraceScope trace(READ_STRIP_EVENT, TRACE_BATCH);
+
+    // The windows with centered ink, each into a row of the batch, an image row at a time.
+    _sumAreas(pixels);
+    _candidates.clear();
+    float *window = _batch.data();
+    for (int row : _windowRows)
+    {
+        for (int col : _windowCols)
+        {
+            double ink = _areaSum(_ink, row, col, imgDims.rows, imgDims.cols);
+            double centerRow = _areaSum(_inkRows, row, col, imgDims.rows, imgDims.cols) / ink - row;
+            double centerCol = _areaSum(_inkCols, row, col, imgDims.rows, imgDims.cols) / ink - col;
+            double marginInk = _areaSum(_ink, row, col, imgDims.rows, MARGIN) +
+                               _areaSum(_ink, row, col + imgDims.cols - MARGIN, imgDims.rows, MARGIN);
+            if (ink < _options.minInk || marginInk > _options.marginInk * ink ||
+                std::abs(centerRow - (imgDims.rows - 1) / 2.0) > _options.centering ||
+                std::abs(centerCol - (imgDims.cols - 1) / 2.0) > _options.centering)
+            {
+                continue;
+            }
+            for (int i = 0; i < imgDims.rows; i++)
+            {
+                std::memcpy(window, pixels + (size_t) (row + i) * _cols + col, imgDims.cols * sizeof(float));
+                window += imgDims.cols;
+            }
+            _candidates.push_back({row, col, Digit()});
+        }
+    }
+    trace.setCount(getCandidates());
+    if (_candidates.empty())
+    {
+        return std::vector<StripDigit>();
+    }
+    model.predictBatch(_batch.view().rowRange(0, getCandidates()), _results.data());
+
+    // Non-maximum suppression, the most probable candidates first.
+    std::vector<StripDigit> candidates;
+    for (int i = 0; i < getCandidates(); i++)
+    {
+        if (_results[i].probability >= _options.threshold)
+        {
+            candidates.push_back({_candidates[i].row, _candidates[i].col, _results[i]});
+        }
+    }
+    std::stable_sort(candidates.begin(), candidates.end(), [](const StripDigit &a, const StripDigit &b)
+    {
+        return a.digit.probability > b.digit.probability;
+    });
+
+    int minDistance = std::max(1, (int) ((1.0f - _options.overlap) * imgDims.cols + 0.5f));
+    std::vector<StripDigit> digits;
+    for (const StripDigit &candidate : candidates)
+    {
+        bool suppressed = false;
+        for (const StripDigit &kept : digits)
+        {
+            suppressed = suppressed || std::abs(kept.col - candidate.col) < minDistance;
+        }
+        if (!suppressed)
+        {
+            digits.push_back(candidate);
+        }
+    }
+    std::sort(digits.begin(), digits.end(), [](const StripDigit &a, const StripDigit &b)
+    {
+        return a.col < b.col;
+    });
+    return digits;
+}
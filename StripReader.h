@@ -0,0 +1,124 @@
+/**
+ * @file StripReader.h
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Header file for the StripReader class which reads the sequence of digits written along a wide
+ * image, by running the network on every window of it as one batch.
+ */
+
+#ifndef STRIPREADER_H
+#define STRIPREADER_H
+
+#include <vector>
+#include "Digit.h"
+#include "Matrix.h"
+#include "ModelRegistry.h"
+
+/**
+ * @struct StripOptions
+ * @brief How a strip is scanned.
+ * @var stride - distance (pixels, both axes) between neighbouring windows
+ * @var threshold - minimal probability of a window's digit for it to be read at all
+ * @var overlap - maximal fraction of its width a read digit shares with another one
+ * @var centering - maximal distance (pixels) of the center of mass of a window's ink from its center
+ * @var minInk - minimal sum of a window's pixels
+ * @var marginInk - maximal fraction of a window's ink in its left and right margins
+ */
+typedef struct StripOptions
+{
+    int stride = 4;
+    float threshold = 0.9f;
+    float overlap = 0.25f;
+    float centering = 3.0f;
+    float minInk = 10.0f;
+    float marginInk = 0.05f;
+} StripOptions;
+
+/**
+ * @struct StripDigit
+ * @brief A digit read from a strip.
+ * @var row - top row of its window
+ * @var col - left column of its window
+ * @var digit - the digit and its probability
+ */
+typedef struct StripDigit
+{
+    int row;
+    int col;
+    Digit digit;
+} StripDigit;
+
+/**
+ * The StripReader class- reads the digits along a rows * cols image (rows, cols >= 28).
+ * Windows of 28 * 28 pixels are taken at stride positions (the last window of every axis touches the
+ * image's edge). The network was trained on digits centered by their center of mass, and is confident
+ * about off center windows too, so only windows whose ink is centered, which have ink at all and
+ * (almost) none in the 4 pixels wide margins MNIST digits leave on their sides, are candidates.
+ * The ink and its moments of every window come from summed area tables of the strip, computed once
+ * and shared by all overlapping windows.
+ * The candidates are gathered into the rows of a single batch, so the first layer of all of them is one
+ * GEMM over the packed weights. (The first layer is fully connected, every pixel of a window meets
+ * a different weight column at every offset, so overlapping windows have no partial products in common
+ * and the batch is the way their work is shared.)
+ * Candidates whose digit is less probable than the threshold are dropped, then non-maximum suppression
+ * keeps the most probable ones which don't overlap horizontally (more than the allowed overlap),
+ * read left to right.
+ * A reader keeps its batch between strips, use one per thread.
+ */
+class StripReader
+{
+public:
+    // Constructors.
+    /**
+     * Constructs a reader of rows * cols strips.
+     * Exits (code == 1) if the strip is smaller than an image or the stride isn't positive.
+     *
+     * @param rows The rows of a strip.
+     * @param cols The columns of a strip.
+     * @param options How strips are scanned.
+     */
+    StripReader(int rows, int cols, const StripOptions &options = StripOptions());
+
+    // Methods.
+    /**
+     * Returns the amount of windows of a strip.
+     *
+     * @return The amount of windows.
+     */
+    int getWindows() const;
+
+    /**
+     * Returns the amount of candidate windows of the last strip read.
+     *
+     * @return The amount of candidates, at most getWindows().
+     */
+    int getCandidates() const;
+
+    /**
+     * Reads the digits of a strip.
+     *
+     * @param model The model to run on the windows.
+     * @param pixels The strip, rows * cols pixels row after row.
+     * @return The digits read, left to right.
+     */
+    std::vector<StripDigit> read(const Model &model, const float pixels[]);
+
+private:
+    int _rows, _cols;
+    StripOptions _options;
+    std::vector<int> _windowRows, _windowCols; // Window positions along each axis.
+    Matrix _batch; // A candidate window per row.
+    std::vector<Digit> _results;
+    std::vector<StripDigit> _candidates;
+    std::vector<double> _ink, _inkRows, _inkCols; // Summed area tables of pixels, row * pixel and col * pixel.
+
+    // Fills the summed area tables of a strip.
+    void _sumAreas(const float pixels[]);
+
+    // Returns the sum of a table over the rows * cols area whose top left pixel is row, col.
+    double _areaSum(const std::vector<double> &table, int row, int col, int rows, int cols) const;
+};
+
+#endif //STRIPREADER_H
@@ -0,0 +1,358 @@
+/**
+ * @file Tracer.cpp
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Implementation file for the Tracer and TraceScope classes which record a timeline of the inference
+ * pipeline (loads, layers, batches, responses) and export it as Chrome trace-event JSON.
+ */
+
+#define ERROR_TRACE_WRITE "Error: failed to write the trace file: "
+#define TRACE_WRITTEN "Trace written to: "
+#define TRACE_DROPPED " (events dropped by full buffers: "
+#define TEMPORARY_SUFFIX ".tmp"
+
+#define CHUNK_EVENTS 16384 // Events per chunk of a thread's buffer.
+#define MAX_CHUNKS 1024 // Chunks per thread, later events are dropped (and counted).
+#define TRACE_POLL_MS 100 // How often the background thread looks for SIGUSR1.
+#define NS_PER_US 1000.0
+
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <set>
+#include <thread>
+#include <vector>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "Tracer.h"
+
+/**
+ * A recorded event, times in nanoseconds since recording started.
+ */
+struct Event
+{
+    const char *name;
+    const char *category;
+    long long start;
+    long long duration;
+    int count;
+};
+
+/**
+ * The events of a thread. Only the thread writes to it, an event is published by the release store
+ * of length (a new chunk is published by the same store).
+ */
+struct ThreadBuffer
+{
+    long tid;
+    std::string name; // Guarded by registryMutex.
+    std::atomic<Event *> chunks[MAX_CHUNKS];
+    std::atomic<size_t> length;
+    std::atomic<size_t> dropped;
+};
+
+static std::atomic<bool> recording(false);
+static Tracer::Clock::time_point origin;
+static std::string tracePath;
+
+// Buffers outlive their threads (and stop()), so a snapshot also has the events of exited threads.
+static std::mutex registryMutex;
+static std::vector<ThreadBuffer *> buffers;
+static std::set<std::string> names;
+static thread_local ThreadBuffer *threadBuffer = nullptr;
+
+static std::thread watcher;
+static std::atomic<bool> stopWatching(false);
+static volatile sig_atomic_t writeRequested = 0;
+
+// Signal handler which asks the background thread to write a snapshot.
+static void _requestWrite(int)
+{
+    writeRequested = 1;
+}
+
+// Returns the buffer of the calling thread, registering it on first use.
+static ThreadBuffer &_threadBuffer()
+{
+    if (threadBuffer == nullptr)
+    {
+        ThreadBuffer *buffer = new ThreadBuffer();
+        buffer->tid = syscall(SYS_gettid);
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffers.push_back(buffer);
+        threadBuffer = buffer;
+    }
+    return *threadBuffer;
+}
+
+// Writes a string as a JSON string.
+static void _writeString(std::ostream &os, const std::string &text)
+{
+    os << '"';
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            os << '\\' << c;
+        }
+        else if ((unsigned char) c < ' ')
+        {
+            os << ' ';
+        }
+        else
+        {
+            os << c;
+        }
+    }
+    os << '"';
+}
+
+// The background thread, writes a snapshot whenever SIGUSR1 arrived since it last looked.
+static void _watch()
+{
+    while (!stopWatching)
+    {
+        if (writeRequested)
+        {
+            writeRequested = 0;
+            Tracer::write(tracePath);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(TRACE_POLL_MS));
+    }
+}
+
+/**
+ * Starts recording. The trace is written to path by stop(), and on every SIGUSR1 until then
+ * (by a background thread).
+ *
+ * @param path The trace file.
+ */
+void Tracer::start(const std::string &path)
+{
+    if (recording)
+    {
+        return;
+    }
+    tracePath = path;
+    origin = Clock::now();
+    recording = true;
+
+    struct sigaction action = {};
+    action.sa_handler = _requestWrite;
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &action, nullptr);
+    stopWatching = false;
+    watcher = std::thread(_watch);
+}
+
+/**
+ * Stops recording and writes the trace (see start()). Does nothing if not started.
+ */
+void Tracer::stop()
+{
+    if (!recording)
+    {
+        return;
+    }
+    recording = false;
+    stopWatching = true;
+    watcher.join();
+    if (write(tracePath))
+    {
+        size_t dropped = 0;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            for (const ThreadBuffer *buffer : buffers)
+            {
+                dropped += buffer->dropped;
+            }
+        }
+        std::cerr << TRACE_WRITTEN << tracePath;
+        if (dropped > 0)
+        {
+            std::cerr << TRACE_DROPPED << dropped << ")";
+        }
+        std::cerr << std::endl;
+    }
+}
+
+/**
+ * Returns whether events are recorded.
+ *
+ * @return true between start() and stop().
+ */
+bool Tracer::enabled()
+{
+    return recording.load(std::memory_order_relaxed);
+}
+
+/**
+ * Records an event of the calling thread which began at start and ends now.
+ * Does nothing if not recording.
+ *
+ * @param name The name of the event, a string which lives as long as the process (see intern()).
+ * @param category The category of the event (TRACE_LOAD, TRACE_LAYER..).
+ * @param start When the event began.
+ * @param count The amount of images the event covered (negative if irrelevant).
+ */
+void Tracer::record(const char *name, const char *category, Clock::time_point start, int count)
+{
+    if (!enabled())
+    {
+        return;
+    }
+    Clock::time_point end = Clock::now();
+    ThreadBuffer &buffer = _threadBuffer();
+    size_t index = buffer.length.load(std::memory_order_relaxed);
+    size_t chunk = index / CHUNK_EVENTS;
+    Event *events = (chunk < MAX_CHUNKS) ? buffer.chunks[chunk].load(std::memory_order_relaxed) : nullptr;
+    if (events == nullptr && chunk < MAX_CHUNKS)
+    {
+        events = new(std::nothrow) Event[CHUNK_EVENTS];
+        buffer.chunks[chunk].store(events, std::memory_order_relaxed);
+    }
+    if (events == nullptr)
+    {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    events[index % CHUNK_EVENTS] = {name, category,
+                                    std::chrono::duration_cast<std::chrono::nanoseconds>(start - origin).count(),
+                                    std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count(),
+                                    count};
+    buffer.length.store(index + 1, std::memory_order_release);
+}
+
+/**
+ * Names the calling thread in the trace.
+ *
+ * @param name The name of the thread.
+ */
+void Tracer::nameThread(const std::string &name)
+{
+    ThreadBuffer &buffer = _threadBuffer();
+    std::lock_guard<std::mutex> lock(registryMutex);
+    buffer.name = name;
+}
+
+/**
+ * Returns a copy of a name which lives as long as the process, a single copy per distinct name.
+ *
+ * @param name The name.
+ * @return The copy.
+ */
+const char *Tracer::intern(const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    return names.insert(name).first->c_str();
+}
+
+/**
+ * Writes every event recorded so far as a trace-event JSON file (through a temporary file,
+ * so readers never see a partial trace).
+ *
+ * @param path The trace file.
+ * @return false if the file couldn't be written.
+ */
+bool Tracer::write(const std::string &path)
+{
+    std::vector<ThreadBuffer *> threads;
+    std::vector<std::string> threadNames;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        threads = buffers;
+        for (const ThreadBuffer *buffer : buffers)
+        {
+            threadNames.push_back(buffer->name);
+        }
+    }
+
+    std::string temporary = path + TEMPORARY_SUFFIX;
+    std::ofstream file(temporary, std::ios::out | std::ios::trunc);
+    long pid = getpid();
+    file << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    for (size_t i = 0; i < threads.size(); i++)
+    {
+        const ThreadBuffer &buffer = *threads[i];
+        if (!threadNames[i].empty())
+        {
+            file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+                 << ",\"tid\":" << buffer.tid << ",\"args\":{\"name\":";
+            _writeString(file, threadNames[i]);
+            file << "}}";
+            first = false;
+        }
+
+        size_t length = buffer.length.load(std::memory_order_acquire);
+        for (size_t j = 0; j < length; j++)
+        {
+            const Event &event = buffer.chunks[j / CHUNK_EVENTS].load(std::memory_order_relaxed)[j % CHUNK_EVENTS];
+            file << (first ? "" : ",\n") << "{\"name\":";
+            _writeString(file, event.name);
+            file << ",\"cat\":\"" << event.category << "\",\"ph\":\"X\",\"ts\":" << event.start / NS_PER_US
+                 << ",\"dur\":" << event.duration / NS_PER_US << ",\"pid\":" << pid << ",\"tid\":" << buffer.tid;
+            if (event.count >= 0)
+            {
+                file << ",\"args\":{\"images\":" << event.count << "}";
+            }
+            file << "}";
+            first = false;
+        }
+    }
+    file << "\n]}\n";
+    file.close();
+
+    if (!file || std::rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        std::cerr << ERROR_TRACE_WRITE << path << std::endl;
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Begins an event, if recording.
+ *
+ * @param name The name of the event, a string which lives as long as the process.
+ * @param category The category of the event.
+ * @param count The amount of images the event covers (negative if irrelevant).
+ */
+TraceScope::TraceScope(const char *name, const char *category, int count)
+        : _name(name), _category(category), _count(count), _enabled(Tracer::enabled())
+{
+    if (_enabled)
+    {
+        _start = Tracer::Clock::now();
+    }
+}
+
+/**
+ * Ends the event.
+ */
+TraceScope::~TraceScope()
+{
+    if (_enabled)
+    {
+        Tracer::record(_name, _category, _start, _count);
+    }
+}
+
+/**
+ * Sets the amount of images the event covers, when known only after it began.
+ *
+ * @param count The amount of images.
+ */
+void TraceScope::setCount(int count)
+{
+    _count = count;
+}
@@ -0,0 +1,136 @@
+/**
+ * @file Tracer.h
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Header file for the Tracer and TraceScope classes which record a timeline of the inference
+ * pipeline (loads, layers, batches, responses) and export it as Chrome trace-event JSON.
+ */
+
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <chrono>
+#include <string>
+
+// Event categories.
+#define TRACE_LOAD "load"
+#define TRACE_LAYER "layer"
+#define TRACE_ACTIVATION "activation"
+#define TRACE_BATCH "batch"
+#define TRACE_OUTPUT "output"
+
+/**
+ * The Tracer class- an optional, process wide recorder of timed events.
+ * Every thread appends its events to a buffer of its own (registered once, on its first event),
+ * so recording takes no lock and shares no cache line with other threads: an event is written
+ * and then published by a release store of the buffer's length. Buffers grow by fixed chunks
+ * which are never moved, so a snapshot is written while threads keep recording.
+ * Every event has a begin and an end, written as a complete ("X") event of the trace-event format
+ * which chrome://tracing and ui.perfetto.dev show as a timeline per thread.
+ * Off (a single relaxed load per traced section) unless started.
+ */
+class Tracer
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    // Methods.
+    /**
+     * Starts recording. The trace is written to path by stop(), and on every SIGUSR1 until then
+     * (by a background thread).
+     *
+     * @param path The trace file.
+     */
+    static void start(const std::string &path);
+
+    /**
+     * Stops recording and writes the trace (see start()). Does nothing if not started.
+     */
+    static void stop();
+
+    /**
+     * Returns whether events are recorded.
+     *
+     * @return true between start() and stop().
+     */
+    static bool enabled();
+
+    /**
+     * Records an event of the calling thread which began at start and ends now.
+     * Does nothing if not recording.
+     *
+     * @param name The name of the event, a string which lives as long as the process (see intern()).
+     * @param category The category of the event (TRACE_LOAD, TRACE_LAYER..).
+     * @param start When the event began.
+     * @param count The amount of images the event covered (negative if irrelevant).
+     */
+    static void record(const char *name, const char *category, Clock::time_point start, int count = -1);
+
+    /**
+     * Names the calling thread in the trace.
+     *
+     * @param name The name of the thread.
+     */
+    static void nameThread(const std::string &name);
+
+    /**
+     * Returns a copy of a name which lives as long as the process, a single copy per distinct name.
+     *
+     * @param name The name.
+     * @return The copy.
+     */
+    static const char *intern(const std::string &name);
+
+    /**
+     * Writes every event recorded so far as a trace-event JSON file (through a temporary file,
+     * so readers never see a partial trace).
+     *
+     * @param path The trace file.
+     * @return false if the file couldn't be written.
+     */
+    static bool write(const std::string &path);
+};
+
+/**
+ * The TraceScope class- records an event from its construction to its destruction.
+ */
+class TraceScope
+{
+public:
+    // Constructors.
+    /**
+     * Begins an event, if recording.
+     *
+     * @param name The name of the event, a string which lives as long as the process.
+     * @param category The category of the event.
+     * @param count The amount of images the event covers (negative if irrelevant).
+     */
+    TraceScope(const char *name, const char *category, int count = -1);
+
+    /**
+     * Ends the event.
+     */
+    ~TraceScope();
+
+    TraceScope(const TraceScope &other) = delete;
+
+    TraceScope &operator=(const TraceScope &other) = delete;
+
+    // Methods.
+    /**
+     * Sets the amount of images the event covers, when known only after it began.
+     *
+     * @param count The amount of images.
+     */
+    void setCount(int count);
+
+private:
+    const char *_name, *_category;
+    int _count;
+    bool _enabled;
+    Tracer::Clock::time_point _start;
+};
+
+#endif //TRACER_H
@@ -0,0 +1,414 @@
+/**
+ * @file Trainer.cpp
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Implementation file for the Trainer class which trains the weights and biases of a
+ * Dense (Relu) ... Dense (Softmax) network with minibatch backpropagation.
+ */
+
+#define ERROR_BAD_OPTIONS "Error: Invalid training options."
+#define ERROR_BAD_PARAMETER_FILE "Error: invalid Parameters file: "
+#define ERROR_WRITE_PARAMETER "Error: Failed to write Parameters file: "
+
+#define WEIGHTS_PREFIX "/w"
+#define BIAS_PREFIX "/b"
+#define SHUFFLE_CHUNK 8192
+#define ADAM_BETA1 0.9f
+#define ADAM_BETA2 0.999f
+#define ADAM_EPSILON 1e-8f
+#define LOG_EPSILON 1e-12f
+#define HE_GAIN 2.0f
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include "Trainer.h"
+#include "Activation.h"
+
+// Reads a file (raw float32, or written by BasicMatrix::write()) into a Matrix of matching size,
+// returns false on failure.
+static bool _readMatrix(const std::string &path, Matrix &matrix)
+{
+    std::ifstream is(path, std::ios::in | std::ios::binary);
+    return is.is_open() && matrix.read(is);
+}
+
+// Writes a Matrix as a raw row-major float32 file, returns false on failure.
+static bool _writeMatrix(const std::string &path, const Matrix &matrix)
+{
+    std::ofstream os(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    for (int i = 0; i < matrix.getRows() && os; i++)
+    {
+        for (int j = 0; j < matrix.getCols(); j++)
+        {
+            float value = matrix(i, j);
+            os.write((const char *) &value, sizeof(float));
+        }
+    }
+    return (bool) os;
+}
+
+// Copies count rows of length floats into a new batch Matrix.
+static Matrix _toBatch(const float pixels[], int count, int length)
+{
+    Matrix batch(count, length);
+    memcpy(batch.data(), pixels, (size_t) count * length * sizeof(float));
+    return batch;
+}
+
+// Returns the index of the largest element in a row.
+static int _argmax(const Matrix &batch, int row)
+{
+    int best = 0;
+    for (int j = 1; j < batch.getCols(); j++)
+    {
+        if (batch(row, j) > batch(row, best))
+        {
+            best = j;
+        }
+    }
+    return best;
+}
+
+/**
+ * Inits a network with He-initialized weights and zero biases.
+ *
+ * @param inputLength Amount of inputs (pixels) of the first layer.
+ * @param classes Amount of outputs of the last layer.
+ * @param options Hyper parameters.
+ */
+Trainer::Trainer(int inputLength, int classes, const TrainerOptions &options)
+        : _options(options), _step(0), _random(options.seed), _generation(0), _pending(0), _exiting(false),
+          _batchPixels(nullptr), _batchLabels(nullptr), _batchCount(0), _batchShare(0)
+{
+    if (inputLength <= 0 || classes <= 1 || options.batchSize <= 0 || options.threads <= 0 ||
+        options.learningRate <= 0.0f)
+    {
+        std::cerr << ERROR_BAD_OPTIONS << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    std::vector<int> widths(1, inputLength);
+    widths.insert(widths.end(), options.hidden.begin(), options.hidden.end());
+    widths.push_back(classes);
+    for (size_t l = 0; l + 1 < widths.size(); l++)
+    {
+        int rows = widths[l + 1], cols = widths[l];
+        Matrix weights(rows, cols);
+        std::normal_distribution<float> distribution(0.0f, std::sqrt(HE_GAIN / (float) cols));
+        for (int i = 0; i < rows; i++)
+        {
+            for (int j = 0; j < cols; j++)
+            {
+                weights(i, j) = distribution(_random);
+            }
+        }
+
+        _weights.push_back(weights);
+        _biases.emplace_back(rows, 1);
+        _weightMoments.emplace_back(rows, cols);
+        _weightSquares.emplace_back(rows, cols);
+        _biasMoments.emplace_back(rows, 1);
+        _biasSquares.emplace_back(rows, 1);
+    }
+
+    _gradients.resize(options.threads);
+    for (int t = 1; t < options.threads; t++)
+    {
+        _workers.emplace_back(&Trainer::_work, this, t);
+    }
+}
+
+/**
+ * Stops the worker threads.
+ */
+Trainer::~Trainer()
+{
+    {
+        std::lock_guard<std::mutex> lock(_poolMutex);
+        _exiting = true;
+    }
+    _workReady.notify_all();
+    for (std::thread &worker : _workers)
+    {
+        worker.join();
+    }
+}
+
+/**
+ * Replaces the parameters with the files w1.. and b1.. of the given directory.
+ * Exits (code == 1) if a file is missing or does not match its layer's dimensions.
+ *
+ * @param directory The directory to read from.
+ */
+void Trainer::loadParameters(const std::string &directory)
+{
+    for (size_t l = 0; l < _weights.size(); l++)
+    {
+        std::string weightsPath = directory + WEIGHTS_PREFIX + std::to_string(l + 1);
+        std::string biasPath = directory + BIAS_PREFIX + std::to_string(l + 1);
+        if (!_readMatrix(weightsPath, _weights[l]) || !_readMatrix(biasPath, _biases[l]))
+        {
+            std::cerr << ERROR_BAD_PARAMETER_FILE << directory << " layer " << (l + 1) << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+/**
+ * Writes the parameters into the files w1.. and b1.. of the given directory.
+ * Exits (code == 1) upon failure.
+ *
+ * @param directory The directory to write into (must exist).
+ */
+void Trainer::saveParameters(const std::string &directory) const
+{
+    for (size_t l = 0; l < _weights.size(); l++)
+    {
+        std::string weightsPath = directory + WEIGHTS_PREFIX + std::to_string(l + 1);
+        std::string biasPath = directory + BIAS_PREFIX + std::to_string(l + 1);
+        if (!_writeMatrix(weightsPath, _weights[l]) || !_writeMatrix(biasPath, _biases[l]))
+        {
+            std::cerr << ERROR_WRITE_PARAMETER << directory << " layer " << (l + 1) << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+/**
+ * Runs a single pass over the dataset, shuffled within chunks of it.
+ *
+ * @param dataset The training data (rewound first).
+ * @return The mean loss over the pass.
+ */
+float Trainer::trainEpoch(IdxDataset &dataset)
+{
+    int length = dataset.imageLength();
+    std::vector<float> chunk, batch;
+    std::vector<int> labels, batchLabels;
+    std::vector<int> order;
+    double totalLoss = 0.0;
+    long samples = 0;
+
+    dataset.rewind();
+    int count;
+    while ((count = dataset.read(SHUFFLE_CHUNK, chunk, labels)) > 0)
+    {
+        order.resize(count);
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), _random);
+
+        for (int start = 0; start < count; start += _options.batchSize)
+        {
+            int batchCount = std::min(_options.batchSize, count - start);
+            batch.resize((size_t) batchCount * length);
+            batchLabels.resize(batchCount);
+            for (int i = 0; i < batchCount; i++)
+            {
+                int sample = order[start + i];
+                std::copy_n(&chunk[(size_t) sample * length], length, &batch[(size_t) i * length]);
+                batchLabels[i] = labels[sample];
+            }
+            totalLoss += _trainBatch(batch.data(), batchLabels.data(), batchCount);
+            samples += batchCount;
+        }
+    }
+    return (samples > 0) ? (float) (totalLoss / samples) : 0.0f;
+}
+
+/**
+ * Returns the fraction of correctly classified samples.
+ *
+ * @param dataset The evaluation data (rewound first).
+ * @return The accuracy, in [0, 1].
+ */
+float Trainer::evaluate(IdxDataset &dataset) const
+{
+    std::vector<float> chunk;
+    std::vector<int> labels;
+    long correct = 0, samples = 0;
+
+    dataset.rewind();
+    int count;
+    while ((count = dataset.read(_options.batchSize, chunk, labels)) > 0)
+    {
+        Matrix output(_forward(_toBatch(chunk.data(), count, dataset.imageLength())).back());
+        for (int i = 0; i < count; i++)
+        {
+            correct += (_argmax(output, i) == labels[i]);
+        }
+        samples += count;
+    }
+    return (samples > 0) ? (float) correct / (float) samples : 0.0f;
+}
+
+// Returns the input of every layer followed by the network's output (a sample per row).
+std::vector<Matrix> Trainer::_forward(const Matrix &input) const
+{
+    std::vector<Matrix> activations(1, input);
+    for (size_t l = 0; l < _weights.size(); l++)
+    {
+        Matrix output(activations.back().multiplyTransposed(_weights[l]));
+        output.addToEachRow(_biases[l]);
+        Activation((l + 1 == _weights.size()) ? Softmax : Relu).activateRows(output);
+        activations.push_back(output);
+    }
+    return activations;
+}
+
+// Computes the summed gradients (and loss) of a share of a minibatch.
+void Trainer::_backpropagate(const float pixels[], const int labels[], int count,
+                             Gradients &gradients) const
+{
+    int layers = (int) _weights.size();
+    std::vector<Matrix> activations = _forward(_toBatch(pixels, count, _weights[0].getCols()));
+
+    // Softmax with cross-entropy: dLoss/dZ = output - one hot label.
+    Matrix delta(activations.back());
+    gradients.loss = 0.0f;
+    for (int i = 0; i < count; i++)
+    {
+        gradients.loss -= std::log(std::max(delta(i, labels[i]), LOG_EPSILON));
+        delta(i, labels[i]) -= 1.0f;
+    }
+
+    gradients.weights.assign(layers, Matrix());
+    gradients.biases.assign(layers, Matrix());
+    for (int l = layers - 1; l >= 0; l--)
+    {
+        const Matrix &input = activations[l];
+        gradients.weights[l] = delta.transpose() * input;
+
+        Matrix biasGradient(delta.getCols(), 1);
+        for (int i = 0; i < count; i++)
+        {
+            for (int j = 0; j < delta.getCols(); j++)
+            {
+                biasGradient[j] += delta(i, j);
+            }
+        }
+        gradients.biases[l] = biasGradient;
+
+        if (l > 0)
+        {
+            // Back through the weights, then through the previous layer's Relu.
+            delta = delta * _weights[l];
+            for (int i = 0; i < count; i++)
+            {
+                for (int j = 0; j < delta.getCols(); j++)
+                {
+                    if (input(i, j) <= 0.0f)
+                    {
+                        delta(i, j) = 0.0f;
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Trains on a single minibatch, split between the threads. Returns the summed loss.
+float Trainer::_trainBatch(const float pixels[], const int labels[], int count)
+{
+    int threads = std::min(_options.threads, count);
+    int share = (count + threads - 1) / threads;
+    int shares = (count + share - 1) / share;
+    std::vector<Gradients> &gradients = _gradients;
+    {
+        std::unique_lock<std::mutex> lock(_poolMutex);
+        _batchPixels = pixels;
+        _batchLabels = labels;
+        _batchCount = count;
+        _batchShare = share;
+        _pending = (int) _workers.size();
+        _generation++;
+    }
+    _workReady.notify_all();
+    _backpropagate(pixels, labels, std::min(share, count), gradients[0]);
+    {
+        std::unique_lock<std::mutex> lock(_poolMutex);
+        _workDone.wait(lock, [this] { return _pending == 0; });
+    }
+
+    float loss = gradients[0].loss;
+    for (int t = 1; t < shares; t++)
+    {
+        for (size_t l = 0; l < _weights.size(); l++)
+        {
+            gradients[0].weights[l] += gradients[t].weights[l];
+            gradients[0].biases[l] += gradients[t].biases[l];
+        }
+        loss += gradients[t].loss;
+    }
+
+    _step++;
+    float scale = 1.0f / (float) count;
+    for (size_t l = 0; l < _weights.size(); l++)
+    {
+        _update(_weights[l], gradients[0].weights[l], _weightMoments[l], _weightSquares[l], scale);
+        _update(_biases[l], gradients[0].biases[l], _biasMoments[l], _biasSquares[l], scale);
+    }
+    return loss;
+}
+
+// A worker thread, backpropagates its share of every minibatch (if the minibatch has one for it).
+void Trainer::_work(int worker)
+{
+    long seen = 0;
+    std::unique_lock<std::mutex> lock(_poolMutex);
+    while (true)
+    {
+        _workReady.wait(lock, [this, seen] { return _generation != seen || _exiting; });
+        if (_exiting)
+        {
+            return;
+        }
+        seen = _generation;
+        int start = worker * _batchShare, shareCount = std::min(_batchShare, _batchCount - start);
+        lock.unlock();
+
+        if (shareCount > 0)
+        {
+            _backpropagate(_batchPixels + (size_t) start * _weights[0].getCols(), _batchLabels + start,
+                           shareCount, _gradients[worker]);
+        }
+
+        lock.lock();
+        if (--_pending == 0)
+        {
+            _workDone.notify_one();
+        }
+    }
+}
+
+// Applies the optimizer on a single parameter Matrix (gradient is multiplied by scale first).
+void Trainer::_update(Matrix &parameter, const Matrix &gradient, Matrix &moment, Matrix &square,
+                      float scale) const
+{
+    float learningRate = _options.learningRate;
+    float correction1 = 1.0f - std::pow(ADAM_BETA1, (float) _step);
+    float correction2 = 1.0f - std::pow(ADAM_BETA2, (float) _step);
+    for (int i = 0; i < parameter.getRows(); i++)
+    {
+        for (int j = 0; j < parameter.getCols(); j++)
+        {
+            float g = gradient(i, j) * scale;
+            float &m = moment(i, j);
+            if (_options.optimizer == Sgd)
+            {
+                m = _options.momentum * m + g;
+                parameter(i, j) -= learningRate * m;
+                continue;
+            }
+
+            float &v = square(i, j);
+            m = ADAM_BETA1 * m + (1.0f - ADAM_BETA1) * g;
+            v = ADAM_BETA2 * v + (1.0f - ADAM_BETA2) * g * g;
+            parameter(i, j) -= learningRate * (m / correction1) / (std::sqrt(v / correction2) + ADAM_EPSILON);
+        }
+    }
+}
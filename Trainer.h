@@ -0,0 +1,156 @@
+/**
+ * @file Trainer.h
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Header file for the Trainer class which trains the weights and biases of a
+ * Dense (Relu) ... Dense (Softmax) network with minibatch backpropagation.
+ */
+
+#ifndef TRAINER_H
+#define TRAINER_H
+
+#include <condition_variable>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Matrix.h"
+#include "IdxDataset.h"
+
+/**
+ * @enum OptimizerType
+ * @brief Indicator of the update rule.
+ */
+enum OptimizerType
+{
+    Sgd,
+    Adam
+};
+
+/**
+ * @struct TrainerOptions
+ * @brief Hyper parameters of a Trainer.
+ * @var hidden - Widths of the hidden (Relu) layers
+ * @var batchSize - Amount of samples per update
+ * @var threads - Amount of threads every minibatch is split between
+ * @var optimizer - The update rule (Sgd uses momentum)
+ * @var learningRate - Step size
+ * @var momentum - Momentum of Sgd
+ * @var seed - Seed of the weights initialization and of the shuffling
+ */
+typedef struct TrainerOptions
+{
+    std::vector<int> hidden = {128, 64, 20};
+    int batchSize = 64;
+    int threads = 1;
+    OptimizerType optimizer = Adam;
+    float learningRate = 0.001f;
+    float momentum = 0.9f;
+    unsigned int seed = 1;
+} TrainerOptions;
+
+/**
+ * The Trainer class- trains a network of Dense layers (Relu on hidden layers, Softmax on the
+ * last one) under cross-entropy loss. Every minibatch is split between threads which compute
+ * gradients of their share in parallel, and the summed gradients update the parameters.
+ * The threads are started once, with the Trainer, and wait for every following minibatch.
+ * Parameters are stored exactly as mlpnetwork loads them (w1.., b1.., raw row-major float32).
+ */
+class Trainer
+{
+public:
+    // Constructors.
+    /**
+     * Inits a network with He-initialized weights and zero biases.
+     *
+     * @param inputLength Amount of inputs (pixels) of the first layer.
+     * @param classes Amount of outputs of the last layer.
+     * @param options Hyper parameters.
+     */
+    Trainer(int inputLength, int classes, const TrainerOptions &options);
+
+    /**
+     * Stops the worker threads.
+     */
+    ~Trainer();
+
+    Trainer(const Trainer &other) = delete;
+
+    Trainer &operator=(const Trainer &other) = delete;
+
+    // Methods.
+    /**
+     * Replaces the parameters with the files w1.. and b1.. of the given directory.
+     * Exits (code == 1) if a file is missing or does not match its layer's dimensions.
+     *
+     * @param directory The directory to read from.
+     */
+    void loadParameters(const std::string &directory);
+
+    /**
+     * Writes the parameters into the files w1.. and b1.. of the given directory.
+     * Exits (code == 1) upon failure.
+     *
+     * @param directory The directory to write into (must exist).
+     */
+    void saveParameters(const std::string &directory) const;
+
+    /**
+     * Runs a single pass over the dataset, shuffled within chunks of it.
+     *
+     * @param dataset The training data (rewound first).
+     * @return The mean loss over the pass.
+     */
+    float trainEpoch(IdxDataset &dataset);
+
+    /**
+     * Returns the fraction of correctly classified samples.
+     *
+     * @param dataset The evaluation data (rewound first).
+     * @return The accuracy, in [0, 1].
+     */
+    float evaluate(IdxDataset &dataset) const;
+
+private:
+    struct Gradients
+    {
+        std::vector<Matrix> weights, biases;
+        float loss;
+    };
+
+    const TrainerOptions _options;
+    std::vector<Matrix> _weights, _biases;
+    std::vector<Matrix> _weightMoments, _biasMoments, _weightSquares, _biasSquares;
+    long _step;
+    std::mt19937 _random;
+
+    // The worker threads, and the minibatch they share (share t of it is worker t's, 0 is the caller's).
+    std::vector<std::thread> _workers;
+    std::mutex _poolMutex;
+    std::condition_variable _workReady, _workDone;
+    long _generation; // Incremented for every minibatch handed to the workers.
+    int _pending; // Workers which didn't finish the current minibatch yet.
+    bool _exiting;
+    const float *_batchPixels;
+    const int *_batchLabels;
+    int _batchCount, _batchShare;
+    std::vector<Gradients> _gradients;
+
+    // Returns the input of every layer followed by the network's output.
+    std::vector<Matrix> _forward(const Matrix &input) const;
+    // Computes the summed gradients (and loss) of a share of a minibatch.
+    void _backpropagate(const float pixels[], const int labels[], int count, Gradients &gradients) const;
+    // Trains on a single minibatch.
+    float _trainBatch(const float pixels[], const int labels[], int count);
+    // A worker thread, backpropagates its share of every minibatch.
+    void _work(int worker);
+    // Applies the optimizer on a single parameter Matrix.
+    void _update(Matrix &parameter, const Matrix &gradient, Matrix &moment, Matrix &square,
+                 float scale) const;
+};
+
+#endif //TRAINER_H
@@ -8,101 +8,293 @@
  * the most likely digit and the probaility that the network is correct.
  */
 
-#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <iostream>
+#include <vector>
+#include <unistd.h>
 
 #include "Matrix.h"
+#include "MatrixAllocator.h"
+#include "MemoryPlacement.h"
 #include "Activation.h"
+#include "BulkLoader.h"
 #include "Dense.h"
+#include "IdxDataset.h"
+#include "KernelTuner.h"
+#include "ImageLoader.h"
 #include "MlpNetwork.h"
+#include "MlpCascade.h"
+#include "ModelRegistry.h"
+#include "PerfCounters.h"
+#include "InferenceServer.h"
+#include "PreforkSupervisor.h"
+#include "Protocol.h"
+#include "RingServer.h"
+#include "ShmRing.h"
+#include "StreamServer.h"
+#include "StripReader.h"
+#include "Tracer.h"
 
 #define QUIT "q"
 #define INSERT_IMAGE_PATH "Please insert image path:"
-#define ERROR_INAVLID_PARAMETER "Error: invalid Parameters file for layer: "
 #define ERROR_INVALID_INPUT "Error: Failed to retrieve input. Exiting.."
 #define ERROR_INVALID_IMG "Error: invalid image path or size: "
+#define NO_TUNING "No kernel tuning for this CPU and model in: "
+#define ERROR_INVALID_DATASET "Error: evaluation dataset is empty or has images of another size"
 #define USAGE_MSG "Usage:\n" \
-                  "\t./mlpnetwork w1 w2 w3 w4 b1 b2 b3 b4\n" \
+                  "\t./mlpnetwork [options] w1 w2 w3 w4 b1 b2 b3 b4\n" \
                   "\twi - the i'th layer's weights\n" \
-                  "\tbi - the i'th layer's biases"
+                  "\tbi - the i'th layer's biases\n" \
+                  "\tSIGHUP reloads the parameters files, without stopping inference\n" \
+                  "Options:\n" \
+                  "\t--perf - report hardware counters per layer on exit (not with --serve, whose inferences\n" \
+                  "\t         run off the main thread)\n" \
+                  "\t--serve <port|socket path> - serve requests instead of the interactive loop\n" \
+                  "\t--max-batch <n> - maximal requests per batch when serving (default 32)\n" \
+                  "\t--max-delay <us> - maximal time a request waits for its batch (default 500)\n" \
+                  "\t--workers <n> - serve from n forked worker processes sharing the weights\n" \
+                  "\t--shm <name> - serve co-located producers through a shared memory ring instead\n" \
+                  "\t               (see ShmRing.h)\n" \
+                  "\t--shm-slots <n> - slots of the shared memory ring, a power of 2 (default 256)\n" \
+                  "\t--cache <n> - cache the results of up to n recently served images\n" \
+                  "\t--allocator <pool|system> - where Matrix storage comes from (default pool)\n" \
+                  "\t--huge-pages - back the weights, pool slabs and batch arenas with huge pages\n" \
+                  "\t--numa-replicas - keep a copy of the weights on every NUMA node, used by its cores\n" \
+                  "\t--pin - pin every worker to a core, round robin over the NUMA nodes\n" \
+                  "\t        (without --workers, the process to the first node)\n" \
+                  "\t--pack-cache <path> - load the packed weights stored in path instead of the parameters\n" \
+                  "\t                      files while they are unchanged (rewritten otherwise, not with --cascade)\n" \
+                  "\t--tuning <path> - run the kernel configuration measured best for this CPU and model,\n" \
+                  "\t                  as stored in the tuning file path\n" \
+                  "\t--autotune - measure the kernel configurations of the model and store the fastest\n" \
+                  "\t             in the --tuning file (then exit)\n" \
+                  "\t--cascade <p> - run a cheap first stage, escalating images it gives\n" \
+                  "\t                a probability below p to the full network\n" \
+                  "\t--cascade-margin <m> - also escalate if its 2 most likely probabilities\n" \
+                  "\t                       are less than m apart (default 0)\n" \
+                  "\t--evaluate <images> <labels> - report accuracy and time per image of the full\n" \
+                  "\t                               network and of the cascade over IDX files\n" \
+                  "\t--score <directory|manifest> - print the result of every image file in a directory\n" \
+                  "\t                               (or listed in a manifest, a path per line), loaded in bulk\n" \
+                  "\t--stream <binary|text> - answer framed images from stdin with records to stdout instead,\n" \
+                  "\t                         in batches of up to --max-batch (see StreamServer.h)\n" \
+                  "\t--strip <rows>x<cols> - read the digits along rows * cols images instead (see StripReader.h)\n" \
+                  "\t--stride <s> - distance between the windows of a strip (default 4)\n" \
+                  "\t--strip-threshold <p> - minimal probability of a digit read from a strip (default 0.9)\n" \
+                  "\t--trace <path> - record a timeline of loads, layers, batches and outputs, written to path\n" \
+                  "\t                 as Chrome trace-event JSON on exit and on SIGUSR1 (not with --workers)"
+#define OPTION_PREFIX "--"
+#define PERF_FLAG "--perf"
+#define SERVE_OPTION "--serve"
+#define MAX_BATCH_OPTION "--max-batch"
+#define MAX_DELAY_OPTION "--max-delay"
+#define WORKERS_OPTION "--workers"
+#define SHM_OPTION "--shm"
+#define SHM_SLOTS_OPTION "--shm-slots"
+#define CACHE_OPTION "--cache"
+#define ALLOCATOR_OPTION "--allocator"
+#define HUGE_PAGES_FLAG "--huge-pages"
+#define NUMA_REPLICAS_FLAG "--numa-replicas"
+#define PIN_FLAG "--pin"
+#define PACK_CACHE_OPTION "--pack-cache"
+#define TUNING_OPTION "--tuning"
+#define AUTOTUNE_FLAG "--autotune"
+#define CASCADE_OPTION "--cascade"
+#define CASCADE_MARGIN_OPTION "--cascade-margin"
+#define EVALUATE_OPTION "--evaluate"
+#define SCORE_OPTION "--score"
+#define TRACE_OPTION "--trace"
+#define STREAM_OPTION "--stream"
+#define STRIP_OPTION "--strip"
+#define STRIDE_OPTION "--stride"
+#define STRIP_THRESHOLD_OPTION "--strip-threshold"
+#define STRIP_DIMS_SEPARATOR 'x'
+#define PARAMS_SECTION "params"
+#define IMAGE_SECTION "image load"
+#define MAIN_THREAD "main"
+#define LOAD_EVENT "load image"
+#define PRINT_EVENT "print result"
+#define EVALUATE_ROUNDS 3 // Timings are the fastest of the rounds.
+#define SCORE_BATCH 256 // Images loaded (and inferred) together when scoring files.
+#define PERCENT 100.0
 
 
 #define ARGS_START_IDX 1
 #define ARGS_COUNT (ARGS_START_IDX + (MLP_SIZE * 2))
-#define WEIGHTS_START_IDX ARGS_START_IDX
-#define BIAS_START_IDX (ARGS_START_IDX + MLP_SIZE)
-
-
-
 
 /**
- * Prints program usage to stdout.
+ * @struct Options
+ * @brief The command line options given before the parameter paths.
  */
-void usage()
+typedef struct Options
 {
-    std::cout << USAGE_MSG << std::endl;
-}
+    bool perf = false;
+    bool autotune = false;
+    std::string serveAddress;
+    ServerOptions server;
+    int workers = 0;
+    std::string shmName;
+    int shmSlots = DEFAULT_RING_SLOTS;
+    AllocationMode allocation = PoolAllocation;
+    PlacementOptions placement;
+    ModelOptions model;
+    std::string evaluateImages;
+    std::string evaluateLabels;
+    std::string scorePath;
+    std::string tracePath;
+    bool stream = false;
+    StreamFormat streamFormat = BinaryStream;
+    MatrixDims strip = {0, 0};
+    StripOptions stripOptions;
+} Options;
 
 /**
- * Given a binary file path and a matrix,
- * reads the content of the file into the matrix.
- * file must match matrix in size in order to read successfully.
- * @param filePath - path of the binary file to read
- * @param mat -  matrix to read the file into.
- * @return boolean status
- *          true - success
- *          false - failure
+ * Prints program usage to stdout.
  */
-bool readFileToMatrix(const std::string &filePath, Matrix &mat)
+void usage()
 {
-    std::ifstream is;
-    is.open(filePath, std::ios::in | std::ios::binary | std::ios::ate);
-    if(!is.is_open())
-    {
-        return false;
-    }
-
-    long int matByteSize = (long int) mat.getCols() * mat.getRows() * sizeof(float);
-    if(is.tellg() != matByteSize)
-    {
-        is.close();
-        return false;
-    }
-
-    is.seekg(0, std::ios_base::beg);
-    is >> mat;
-    is.close();
-    return true;
+    std::cout << USAGE_MSG << std::endl;
 }
 
 /**
- * Loads MLP parameters from weights & biases paths
- * to Weights[] and Biases[].
- * Exits (code == 1) upon failures.
- * @param paths array of programs arguments, expected to be mlp parameters
- *        path.
- * @param weights array of matrix, weigths[i] is the i'th layer weights matrix
- * @param biases array of matrix, biases[i] is the i'th layer bias matrix
- *          (which is actually a vector)
+ * Parses the options at the start of the arguments and skips them,
+ * so argv[ARGS_START_IDX] is the first parameter path afterwards.
+ * Prints usage and exits (code == 1) upon unknown or incomplete options.
+ * @param argc count of args, updated
+ * @param argv args values, updated
+ * @return the parsed options
  */
-void loadParameters(char *paths[ARGS_COUNT], Matrix weights[MLP_SIZE], Matrix biases[MLP_SIZE])
+Options parseOptions(int &argc, char **&argv)
 {
-    for(int i = 0; i < MLP_SIZE; i++)
+    Options options;
+    while(argc > ARGS_START_IDX && std::string(argv[ARGS_START_IDX]).rfind(OPTION_PREFIX, 0) == 0)
     {
-        weights[i] = Matrix(weightsDims[i].rows, weightsDims[i].cols);
-        biases[i] = Matrix(biasDims[i].rows, biasDims[i].cols);
-
-        std::string weightsPath(paths[WEIGHTS_START_IDX + i]);
-        std::string biasPath(paths[BIAS_START_IDX + i]);
-
-        if(!(readFileToMatrix(weightsPath, weights[i]) &&
-           readFileToMatrix(biasPath, biases[i])))
+        std::string option(argv[ARGS_START_IDX]);
+        bool hasValue = argc > ARGS_START_IDX + 1;
+        int consumed = 2;
+        if(option == PERF_FLAG)
+        {
+            options.perf = true;
+            consumed = 1;
+        }
+        else if(option == AUTOTUNE_FLAG)
+        {
+            options.autotune = true;
+            consumed = 1;
+        }
+        else if(option == HUGE_PAGES_FLAG)
+        {
+            options.placement.hugePages = true;
+            consumed = 1;
+        }
+        else if(option == NUMA_REPLICAS_FLAG)
+        {
+            options.placement.replicate = true;
+            consumed = 1;
+        }
+        else if(option == PIN_FLAG)
+        {
+            options.placement.pin = true;
+            consumed = 1;
+        }
+        else if(option == SERVE_OPTION && hasValue && isValidAddress(argv[ARGS_START_IDX + 1]))
+        {
+            options.serveAddress = argv[ARGS_START_IDX + 1];
+        }
+        else if(option == MAX_BATCH_OPTION && hasValue)
+        {
+            options.server.maxBatchSize = std::atoi(argv[ARGS_START_IDX + 1]);
+        }
+        else if(option == MAX_DELAY_OPTION && hasValue)
+        {
+            options.server.maxQueueDelayUs = std::atol(argv[ARGS_START_IDX + 1]);
+        }
+        else if(option == WORKERS_OPTION && hasValue)
+        {
+            options.workers = std::atoi(argv[ARGS_START_IDX + 1]);
+        }
+        else if(option == SHM_OPTION && hasValue)
+        {
+            options.shmName = argv[ARGS_START_IDX + 1];
+        }
+        else if(option == SHM_SLOTS_OPTION && hasValue)
+        {
+            options.shmSlots = std::atoi(argv[ARGS_START_IDX + 1]);
+        }
+        else if(option == CACHE_OPTION && hasValue)
+        {
+            options.server.cacheEntries = std::strtoul(argv[ARGS_START_IDX + 1], nullptr, 10);
+        }
+        else if(option == ALLOCATOR_OPTION && hasValue &&
+                (std::string(argv[ARGS_START_IDX + 1]) == "pool" ||
+                 std::string(argv[ARGS_START_IDX + 1]) == "system"))
+        {
+            options.allocation = (std::string(argv[ARGS_START_IDX + 1]) == "pool") ? PoolAllocation
+                                                                                   : SystemAllocation;
+        }
+        else if(option == PACK_CACHE_OPTION && hasValue)
+        {
+            options.model.packCache = argv[ARGS_START_IDX + 1];
+        }
+        else if(option == TUNING_OPTION && hasValue)
+        {
+            options.model.tuningFile = argv[ARGS_START_IDX + 1];
+        }
+        else if(option == CASCADE_OPTION && hasValue)
+        {
+            options.model.cascade = true;
+            options.model.cascadeOptions.threshold = std::strtof(argv[ARGS_START_IDX + 1], nullptr);
+        }
+        else if(option == CASCADE_MARGIN_OPTION && hasValue)
+        {
+            options.model.cascadeOptions.margin = std::strtof(argv[ARGS_START_IDX + 1], nullptr);
+        }
+        else if(option == SCORE_OPTION && hasValue)
+        {
+            options.scorePath = argv[ARGS_START_IDX + 1];
+        }
+        else if(option == TRACE_OPTION && hasValue)
+        {
+            options.tracePath = argv[ARGS_START_IDX + 1];
+        }
+        else if(option == STREAM_OPTION && hasValue &&
+                (std::string(argv[ARGS_START_IDX + 1]) == "binary" ||
+                 std::string(argv[ARGS_START_IDX + 1]) == "text"))
+        {
+            options.stream = true;
+            options.streamFormat = (std::string(argv[ARGS_START_IDX + 1]) == "binary") ? BinaryStream : TextStream;
+        }
+        else if(option == STRIP_OPTION && hasValue &&
+                std::strchr(argv[ARGS_START_IDX + 1], STRIP_DIMS_SEPARATOR) != nullptr)
+        {
+            options.strip.rows = std::atoi(argv[ARGS_START_IDX + 1]);
+            options.strip.cols = std::atoi(std::strchr(argv[ARGS_START_IDX + 1], STRIP_DIMS_SEPARATOR) + 1);
+        }
+        else if(option == STRIDE_OPTION && hasValue)
+        {
+            options.stripOptions.stride = std::atoi(argv[ARGS_START_IDX + 1]);
+        }
+        else if(option == STRIP_THRESHOLD_OPTION && hasValue)
+        {
+            options.stripOptions.threshold = std::strtof(argv[ARGS_START_IDX + 1], nullptr);
+        }
+        else if(option == EVALUATE_OPTION && argc > ARGS_START_IDX + 2)
+        {
+            options.evaluateImages = argv[ARGS_START_IDX + 1];
+            options.evaluateLabels = argv[ARGS_START_IDX + 2];
+            consumed = 3;
+        }
+        else
         {
-            std::cerr << ERROR_INAVLID_PARAMETER << (i + 1) << std::endl;
+            usage();
             exit(EXIT_FAILURE);
         }
-
+        argc -= consumed;
+        argv += consumed;
     }
+    return options;
 }
 
 /**
@@ -113,11 +305,14 @@ void loadParameters(char *paths[ARGS_COUNT], Matrix weights[MLP_SIZE], Matrix bi
  *                  print image & netowrk prediction
  *             }
  * Exits (code == 1) on fatal errors: unable to read user input path.
- * @param mlp MlpNetwork to use in order to predict img.
+ * @param models registry of the model to use in order to predict img (the current one per image).
+ * @param profiler profiler to attribute image loading to (or nullptr).
  */
-void mlpCli(MlpNetwork &mlp)
+void mlpCli(const ModelRegistry &models, PerfProfiler *profiler)
 {
+    int imageSection = (profiler != nullptr) ? profiler->addSection(IMAGE_SECTION) : 0;
     Matrix img(imgDims.rows, imgDims.cols);
+    MatrixArena arena;
     std::string imgPath;
 
     std::cout << INSERT_IMAGE_PATH << std::endl;
@@ -130,10 +325,25 @@ void mlpCli(MlpNetwork &mlp)
 
     while(imgPath != QUIT)
     {
-        if(readFileToMatrix(imgPath, img))
+        if(profiler != nullptr)
         {
-            Matrix imgVec = img;
-            Digit output = mlp(imgVec.vectorize());
+            profiler->begin(imageSection);
+        }
+        // Raw float32, raw uint8, PGM or IDX, converted straight into the network's input.
+        Tracer::Clock::time_point loadStart = Tracer::Clock::now();
+        bool imgRead = loadImage(imgPath, imgDims.rows, imgDims.cols, img.data()) != UnknownImage;
+        Tracer::record(LOAD_EVENT, TRACE_LOAD, loadStart, 1);
+        if(profiler != nullptr)
+        {
+            profiler->end(imageSection);
+        }
+
+        if(imgRead)
+        {
+            ArenaScope scope(arena); // Temporaries of the inference are released together.
+            MatrixView input = img.view().reshape(imgDims.rows * imgDims.cols, 1);
+            Digit output = (*models.acquire())(input);
+            TraceScope trace(PRINT_EVENT, TRACE_OUTPUT, 1);
             std::cout << "Image processed:" << std::endl
                       << img << std::endl;
             std::cout << "Mlp result: " << output.value <<
@@ -154,6 +364,237 @@ void mlpCli(MlpNetwork &mlp)
     }
 }
 
+/**
+ * Command line interface for reading strips of digits, looping like mlpCli on:
+ * retrieve a strip path, read its digits, print them and where they were found.
+ * Exits (code == 1) on fatal errors: unable to read user input path.
+ * @param models registry of the model to read with (the current one per strip).
+ * @param dims the dimensions of every strip.
+ * @param options how strips are scanned.
+ */
+void mlpStrip(const ModelRegistry &models, const MatrixDims &dims, const StripOptions &options)
+{
+    StripReader reader(dims.rows, dims.cols, options);
+    Matrix strip(dims.rows, dims.cols);
+    MatrixArena arena;
+    std::string stripPath;
+
+    std::cout << INSERT_IMAGE_PATH << std::endl;
+    std::cin >> stripPath;
+    while(std::cin.good() && stripPath != QUIT)
+    {
+        Tracer::Clock::time_point loadStart = Tracer::Clock::now();
+        bool stripRead = loadImage(stripPath, dims.rows, dims.cols, strip.data()) != UnknownImage;
+        Tracer::record(LOAD_EVENT, TRACE_LOAD, loadStart, 1);
+        if(stripRead)
+        {
+            ArenaScope scope(arena);
+            std::vector<StripDigit> digits = reader.read(*models.acquire(), strip.data());
+            TraceScope trace(PRINT_EVENT, TRACE_OUTPUT, 1);
+            std::cout << "Strip result: ";
+            for(const StripDigit &digit : digits)
+            {
+                std::cout << digit.digit.value;
+            }
+            std::cout << std::endl;
+            for(const StripDigit &digit : digits)
+            {
+                std::cout << "\t" << digit.digit.value << " at row " << digit.row << " column " << digit.col
+                          << " probability: " << digit.digit.probability << std::endl;
+            }
+        }
+        else
+        {
+            std::cout << ERROR_INVALID_IMG << stripPath << std::endl;
+        }
+
+        std::cout << INSERT_IMAGE_PATH << std::endl;
+        std::cin >> stripPath;
+    }
+    if(!std::cin.good())
+    {
+        std::cout << ERROR_INVALID_INPUT << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * Measures the kernel configurations of the current model on this CPU, prints the timings and
+ * stores the fastest in the tuning file (next to the entries of other CPUs and models).
+ * Exits (code == 1) if the tuning file can't be written.
+ * @param models registry of the model to tune.
+ * @param tuningFile path of the tuning file.
+ */
+void mlpAutotune(const ModelRegistry &models, const std::string &tuningFile)
+{
+    std::shared_ptr<const Model> model = models.acquire();
+    const ExecutionPlan &plan = model->getNetwork().getPlan();
+    PlanTuning tuning = KernelTuner::tune(plan, std::cout);
+    if(!KernelTuner::store(tuningFile, plan, tuning))
+    {
+        exit(EXIT_FAILURE);
+    }
+    std::cout << "Stored in: " << tuningFile << std::endl;
+}
+
+/**
+ * Prints the result of every image file of a directory (or manifest) as path, digit and probability,
+ * a line each. The files are loaded SCORE_BATCH at a time by a BulkLoader, straight into the batch
+ * the model runs on. Prints the time spent loading and inferring to stderr.
+ * @param models registry of the model to use (the current one per batch).
+ * @param path a directory or a manifest of image files
+ */
+void mlpScore(const ModelRegistry &models, const std::string &path)
+{
+    std::vector<std::string> files = listImageFiles(path);
+    int length = imgDims.rows * imgDims.cols;
+    BulkLoader loader;
+    Matrix batch(SCORE_BATCH, length);
+    std::vector<Digit> results(SCORE_BATCH);
+    std::unique_ptr<bool[]> loaded(new bool[SCORE_BATCH]);
+    double loadUs = 0.0, inferUs = 0.0;
+    size_t scored = 0;
+
+    for(size_t first = 0; first < files.size(); first += SCORE_BATCH)
+    {
+        size_t count = std::min(files.size() - first, (size_t) SCORE_BATCH);
+        std::vector<std::string> chunk(files.begin() + first, files.begin() + first + count);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        scored += loader.load(chunk, imgDims.rows, imgDims.cols, batch.data(), loaded.get());
+        std::chrono::steady_clock::time_point loadedAt = std::chrono::steady_clock::now();
+        models.acquire()->predictBatch(MatrixView(batch.data(), (int) count, length, length), results.data());
+        loadUs += std::chrono::duration<double, std::micro>(loadedAt - start).count();
+        inferUs += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - loadedAt).count();
+
+        TraceScope trace(PRINT_EVENT, TRACE_OUTPUT, (int) count);
+        for(size_t i = 0; i < count; i++)
+        {
+            if(loaded[i])
+            {
+                std::cout << chunk[i] << "\t" << results[i].value << "\t" << results[i].probability << "\n";
+            }
+            else
+            {
+                std::cerr << ERROR_INVALID_IMG << chunk[i] << std::endl;
+            }
+        }
+    }
+    std::cout.flush();
+
+    std::cerr << "Scored " << scored << " of " << files.size() << " images ("
+              << (loader.usesIoUring() ? "io_uring" : "system calls") << ")";
+    if(!files.empty())
+    {
+        std::cerr << ", load: " << loadUs / files.size() << "us, inference: " << inferUs / files.size()
+                  << "us per image";
+    }
+    std::cerr << std::endl;
+}
+
+/**
+ * Returns the time (microseconds) of the fastest of EVALUATE_ROUNDS runs.
+ * @param run the run to time
+ * @return the time of the fastest run
+ */
+template<typename Run>
+double fastestUs(Run run)
+{
+    double fastest = 0.0;
+    for(int i = 0; i < EVALUATE_ROUNDS; i++)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        run();
+        std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+        fastest = (i == 0) ? elapsed.count() : std::min(fastest, elapsed.count());
+    }
+    return fastest;
+}
+
+/**
+ * Prints a row of the evaluation table.
+ * @param name name of the row
+ * @param escalated percent of the images escalated (negative for none)
+ * @param correct amount of correctly recognized images
+ * @param count amount of images
+ * @param us mean time per image
+ */
+void printEvaluation(const std::string &name, double escalated, int correct, int count, double us)
+{
+    std::cout << name << "\t";
+    if(escalated < 0)
+    {
+        std::cout << "-";
+    }
+    else
+    {
+        std::cout << escalated << "%";
+    }
+    std::cout << "\t" << (PERCENT * correct / count) << "%\t" << us << "us" << std::endl;
+}
+
+/**
+ * Reports the accuracy / latency trade-off of the cascade over a labeled IDX dataset:
+ * the full network alone, the cascade at thresholds from 0.5 to 0.99 (times estimated from
+ * the measured time of every stage and the escalated fraction), and the configured cascade
+ * (measured, batched).
+ * Exits (code == 1) if the dataset is unreadable or has images of another size.
+ * @param mlp the full network
+ * @param cascade the cascade in front of it
+ * @param imagesPath path of the IDX images file
+ * @param labelsPath path of the IDX labels file
+ */
+void mlpEvaluate(const MlpNetwork &mlp, const MlpCascade &cascade, const std::string &imagesPath,
+                 const std::string &labelsPath)
+{
+    IdxDataset dataset(imagesPath, labelsPath, weightsDims[MLP_SIZE - 1].rows);
+    std::vector<float> pixels;
+    std::vector<int> labels;
+    int count = dataset.read(dataset.size(), pixels, labels);
+    if(count == 0 || dataset.imageLength() != imgDims.rows * imgDims.cols)
+    {
+        std::cerr << ERROR_INVALID_DATASET << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    Matrix batch(count, dataset.imageLength());
+    memcpy(batch.data(), pixels.data(), pixels.size() * sizeof(float));
+
+    std::vector<Digit> full(count), first(count), cascaded(count);
+    std::vector<float> margins(count);
+    double fullUs = fastestUs([&]() { mlp.predictBatch(batch, full.data()); }) / count;
+    double firstUs = fastestUs([&]() { cascade.firstStage(batch, first.data(), margins.data()); }) / count;
+    double cascadeUs = fastestUs([&]() { cascade.predictBatch(batch, cascaded.data()); }) / count;
+
+    std::cout << "model\tescalated\taccuracy\ttime/image" << std::endl;
+    int fullCorrect = 0, cascadeCorrect = 0;
+    for(int i = 0; i < count; i++)
+    {
+        fullCorrect += (int) full[i].value == labels[i];
+        cascadeCorrect += (int) cascaded[i].value == labels[i];
+    }
+    printEvaluation("full", -1.0, fullCorrect, count, fullUs);
+
+    CascadeOptions sweep = cascade.getOptions();
+    for(float threshold : {0.5f, 0.6f, 0.7f, 0.8f, 0.9f, 0.95f, 0.99f})
+    {
+        sweep.threshold = threshold;
+        int escalated = 0, correct = 0;
+        for(int i = 0; i < count; i++)
+        {
+            bool confident = MlpCascade::isConfident(first[i], margins[i], sweep);
+            escalated += !confident;
+            correct += (int) (confident ? first[i] : full[i]).value == labels[i];
+        }
+        double fraction = (double) escalated / count;
+        printEvaluation("p>=" + std::to_string(threshold).substr(0, 4), PERCENT * fraction, correct, count,
+                        firstUs + fraction * fullUs);
+    }
+
+    std::cout << "measured cascade (p>=" << cascade.getOptions().threshold << ", margin>="
+              << cascade.getOptions().margin << "):" << std::endl;
+    cascade.printStats(std::cout);
+    printEvaluation("cascade", -1.0, cascadeCorrect, count, cascadeUs);
+}
+
 /**
  * Program's main
  * @param argc count of args
@@ -162,20 +603,118 @@ void mlpCli(MlpNetwork &mlp)
  */
 int main(int argc, char **argv)
 {
-    if(argc != ARGS_COUNT)
+    Options options = parseOptions(argc, argv);
+    bool perf = options.perf;
+    if(argc != ARGS_COUNT || (!options.tracePath.empty() && options.workers > 0) ||
+       (options.autotune && options.model.tuningFile.empty()) || (perf && !options.serveAddress.empty()))
     {
         usage();
         exit(EXIT_FAILURE);
     }
+    if(!options.tracePath.empty())
+    {
+        Tracer::start(options.tracePath);
+        Tracer::nameThread(MAIN_THREAD);
+    }
 
-    Matrix weights[MLP_SIZE];
-    Matrix biases[MLP_SIZE];
-    loadParameters(argv, weights, biases);
+    MatrixAllocator::setMode(options.allocation);
+    MemoryPlacement::configure(options.placement);
+    if(options.placement.pin && options.workers == 0)
+    {
+        MemoryPlacement::pinToNode(0); // Workers pin themselves.
+    }
+    PerfProfiler *profiler = perf ? new PerfProfiler() : nullptr;
+    int paramsSection = perf ? profiler->addSection(PARAMS_SECTION) : 0;
 
-    MlpNetwork mlp(weights, biases);
+    // The weights of every layer, followed by the biases of every layer.
+    std::vector<std::string> paths(argv + ARGS_START_IDX, argv + ARGS_COUNT);
+    options.model.profiler = profiler;
+    if(!options.evaluateImages.empty())
+    {
+        options.model.packCache.clear(); // The evaluated cascade is built out of the raw weights.
+    }
+    if(perf)
+    {
+        profiler->begin(paramsSection);
+    }
+    ModelRegistry *models = new ModelRegistry(paths, options.model);
+    if(perf)
+    {
+        profiler->end(paramsSection);
+    }
 
-    mlpCli(mlp);
+    if(!options.autotune && !options.model.tuningFile.empty() && !models->acquire()->isTuned())
+    {
+        std::cerr << NO_TUNING << options.model.tuningFile << std::endl;
+    }
 
+    if(options.autotune)
+    {
+        mlpAutotune(*models, options.model.tuningFile);
+    }
+    else if(!options.evaluateImages.empty())
+    {
+        std::shared_ptr<const Model> model = models->acquire();
+        MlpCascade cascade(model->getNetwork(), options.model.cascadeOptions);
+        mlpEvaluate(model->getNetwork(), cascade, options.evaluateImages, options.evaluateLabels);
+    }
+    else if(!options.scorePath.empty())
+    {
+        mlpScore(*models, options.scorePath);
+    }
+    else if(options.stream)
+    {
+        models->watchReloads();
+        StreamServer server(*models, options.server.maxBatchSize, options.streamFormat);
+        server.serve(STDIN_FILENO, STDOUT_FILENO);
+        server.printStats(std::cerr);
+    }
+    else if(options.strip.rows != 0 || options.strip.cols != 0)
+    {
+        models->watchReloads();
+        mlpStrip(*models, options.strip, options.stripOptions);
+    }
+    else if(!options.shmName.empty())
+    {
+        models->watchReloads();
+        ShmRing ring(options.shmName, options.shmSlots);
+        RingServer server(*models, options.server.maxBatchSize);
+        server.serve(ring);
+        server.printStats(std::cerr);
+    }
+    else if(options.serveAddress.empty())
+    {
+        models->watchReloads();
+        mlpCli(*models, profiler);
+        if(models->acquire()->getCascade() != nullptr)
+        {
+            models->acquire()->getCascade()->printStats(std::cerr);
+        }
+    }
+    else if(options.workers > 0)
+    {
+        PreforkSupervisor supervisor(*models, options.workers, options.server);
+        supervisor.run(openListener(options.serveAddress));
+    }
+    else
+    {
+        models->watchReloads();
+        InferenceServer server(*models, options.server);
+        server.serve(openListener(options.serveAddress));
+        server.printStats(std::cerr);
+    }
+
+    Tracer::stop();
+    if(MemoryPlacement::active())
+    {
+        MemoryPlacement::printStats(std::cerr);
+    }
+    delete models; // Before the profiler, which every model reports to.
+    if(perf)
+    {
+        profiler->report(std::cerr);
+        delete profiler;
+    }
 
     return EXIT_SUCCESS;
 }
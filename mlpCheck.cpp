@@ -0,0 +1,451 @@
+/**
+ * @file mlpCheck.cpp
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Checks the formats and kernels which nothing else exercises directly (run by make check):
+ * quantization and the matrix file format of every element type, the legacy raw float32 parameters,
+ * mixed precision products and layers against their float references, the packed panels of a layer
+ * and the sequence protocol of the shared memory ring.
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+#include "Dense.h"
+#include "ElementType.h"
+#include "ImageLoader.h"
+#include "Matrix.h"
+#include "PackedWeights.h"
+#include "ShmRing.h"
+
+#define CHECK_FAILED "FAILED: "
+#define CHECKS_PASSED "All checks passed"
+#define CHECKS_FAILED " check(s) failed"
+
+#define SEED 5489
+#define ROWS 13 // Not a multiple of PackedWeights::PANEL_ROWS, so the last panel is padded.
+#define COLS 37
+#define BATCH 11 // Not a multiple of any batch tile.
+#define BF16_EPSILON (1.0 / 256) // Relative rounding error of a bfloat16 (8 significant bits).
+#define FLOAT_EPSILON 1e-5
+#define RING_NAME "mlpcheck-"
+#define RING_SLOTS 4
+#define RING_LAPS 3
+
+static int failures = 0;
+
+/**
+ * Counts (and reports) a failed check.
+ * @param passed Whether the check passed.
+ * @param what What was checked.
+ */
+void check(bool passed, const std::string &what)
+{
+    if(!passed)
+    {
+        std::cerr << CHECK_FAILED << what << std::endl;
+        failures++;
+    }
+}
+
+/**
+ * Returns a matrix of uniformly distributed values.
+ * @param rows rows of the matrix
+ * @param cols columns of the matrix
+ * @param low the smallest value
+ * @param high the largest value
+ * @param random the generator
+ * @return the matrix
+ */
+Matrix randomMatrix(int rows, int cols, float low, float high, std::mt19937 &random)
+{
+    std::uniform_real_distribution<float> distribution(low, high);
+    Matrix matrix(rows, cols);
+    for(int i = 0; i < rows * cols; i++)
+    {
+        matrix.data()[i] = distribution(random);
+    }
+    return matrix;
+}
+
+/**
+ * Returns the largest difference between the elements of two float matrices of the same dimensions
+ * (infinity if their dimensions differ).
+ * @param a a matrix
+ * @param b a matrix
+ * @return the largest difference
+ */
+double maxDifference(const BasicMatrix<float> &a, const BasicMatrix<float> &b)
+{
+    if(a.getRows() != b.getRows() || a.getCols() != b.getCols())
+    {
+        return INFINITY;
+    }
+    double largest = 0;
+    for(int i = 0; i < a.getRows() * a.getCols(); i++)
+    {
+        largest = std::max(largest, std::fabs((double) a.data()[i] - b.data()[i]));
+    }
+    return largest;
+}
+
+/**
+ * Returns the largest magnitude of a product of the given matrices, as if no term ever cancelled:
+ * max over i, j of sum over k of |a(i, k) * b(k, j)|, the scale of the rounding error of the product.
+ * @param a the left matrix (n * k)
+ * @param b the right matrix (k * m)
+ * @return the largest magnitude
+ */
+double productMagnitude(const Matrix &a, const Matrix &b)
+{
+    double largest = 0;
+    for(int i = 0; i < a.getRows(); i++)
+    {
+        for(int j = 0; j < b.getCols(); j++)
+        {
+            double sum = 0;
+            for(int k = 0; k < a.getCols(); k++)
+            {
+                sum += std::fabs((double) a.at(i, k) * b.at(k, j));
+            }
+            largest = std::max(largest, sum);
+        }
+    }
+    return largest;
+}
+
+/**
+ * Checks that quantizing a matrix into T loses at most half a unit (or bfloat16 rounding),
+ * and that its file round trips, both into T as it is and into a float matrix as its real values.
+ * @param values the values (non negative ones for uint8_t)
+ * @param name the name of the element type
+ */
+template<typename T>
+void checkElementType(const Matrix &values, const std::string &name)
+{
+    BasicMatrix<T> quantized = BasicMatrix<T>::quantize(values);
+    BasicMatrix<float> real = quantized.dequantize();
+    double bound = std::is_integral<T>::value ? quantized.getScale() / 2.0 + FLOAT_EPSILON : 0;
+    for(int i = 0; i < values.getRows() * values.getCols(); i++)
+    {
+        double tolerance = std::is_integral<T>::value ? bound
+                : (std::is_same<T, BFloat16>::value ? BF16_EPSILON * std::fabs(values.data()[i]) : 0);
+        if(std::fabs((double) real.data()[i] - values.data()[i]) > tolerance)
+        {
+            check(false, name + " quantize/dequantize");
+            break;
+        }
+    }
+
+    std::stringstream file;
+    quantized.write(file);
+    BasicMatrix<T> sameType(values.getRows(), values.getCols());
+    check(sameType.read(file) && sameType.getScale() == quantized.getScale() &&
+          std::memcmp(sameType.data(), quantized.data(), sizeof(T) * values.getRows() * values.getCols()) == 0,
+          name + " write/read round trip");
+
+    std::stringstream converted(file.str());
+    BasicMatrix<float> asFloat(values.getRows(), values.getCols());
+    check(asFloat.read(converted) && maxDifference(asFloat, real) == 0, name + " read into f32");
+
+    std::stringstream truncated(file.str().substr(0, file.str().size() - 1));
+    check(!sameType.read(truncated), name + " truncated file is rejected");
+}
+
+/**
+ * Checks that parameters files of raw float32 elements (no header) are still read, into any type.
+ * @param random the generator
+ */
+void checkLegacyRead(std::mt19937 &random)
+{
+    Matrix values = randomMatrix(ROWS, COLS, -1, 1, random);
+    std::string raw((const char *) values.data(), sizeof(float) * ROWS * COLS);
+
+    std::stringstream file(raw);
+    Matrix matrix(ROWS, COLS);
+    file >> matrix;
+    check(maxDifference(matrix, values) == 0, "legacy raw float32 read");
+
+    std::stringstream quantizedFile(raw);
+    BasicMatrix<int8_t> quantized(ROWS, COLS);
+    check(quantized.read(quantizedFile) &&
+          maxDifference(quantized.dequantize(), BasicMatrix<int8_t>::quantize(values).dequantize()) == 0,
+          "legacy raw float32 read into i8");
+
+    std::stringstream shortFile(raw.substr(sizeof(float)));
+    check(!matrix.read(shortFile), "legacy raw float32 file of the wrong size is rejected");
+}
+
+/**
+ * Checks the mixed precision products against the product of the float values they hold
+ * (the exact same values, so only float rounding differs) and against the float product of
+ * the values before quantization (quantization error).
+ * @param random the generator
+ */
+void checkProducts(std::mt19937 &random)
+{
+    Matrix weights = randomMatrix(ROWS, COLS, -1, 1, random);
+    Matrix pixels = randomMatrix(COLS, BATCH, 0, 1, random);
+    double magnitude = productMagnitude(weights, pixels);
+    Matrix reference(multiply(static_cast<const BasicMatrix<float> &>(weights),
+                              static_cast<const BasicMatrix<float> &>(pixels)));
+
+    BasicMatrix<int8_t> a = BasicMatrix<int8_t>::quantize(weights);
+    BasicMatrix<uint8_t> b = BasicMatrix<uint8_t>::quantize(pixels);
+    BasicMatrix<float> integer = multiply(a, b).dequantize();
+    BasicMatrix<float> held = multiply(a.dequantize(), b.dequantize());
+    check(maxDifference(integer, held) <= FLOAT_EPSILON * magnitude, "i8 x u8 product vs f32 of its values");
+    double quantizationError = (a.getScale() + b.getScale()) / 2.0 * COLS;
+    check(maxDifference(integer, reference) <= quantizationError, "i8 x u8 product vs f32 product");
+
+    BasicMatrix<BFloat16> brain = BasicMatrix<BFloat16>::quantize(weights);
+    BasicMatrix<float> mixed = multiply(brain, static_cast<const BasicMatrix<float> &>(pixels));
+    check(maxDifference(mixed, multiply(brain.dequantize(), static_cast<const BasicMatrix<float> &>(pixels)))
+          <= FLOAT_EPSILON * magnitude, "bf16 x f32 product vs f32 of its values");
+    check(maxDifference(mixed, reference) <= BF16_EPSILON * magnitude, "bf16 x f32 product vs f32 product");
+}
+
+/**
+ * Checks the double precision layers of reduced precision weights against float layers of the
+ * weights' real values, and applyBatch() against applying the layer on every sample alone.
+ * @param random the generator
+ */
+void checkDense(std::mt19937 &random)
+{
+    Matrix weights = randomMatrix(ROWS, COLS, -1, 1, random);
+    Matrix bias = randomMatrix(ROWS, 1, -1, 1, random);
+    Matrix batch = randomMatrix(BATCH, COLS, 0, 1, random);
+    double tolerance = FLOAT_EPSILON * (productMagnitude(weights, batch.transpose()) + 1);
+
+    Dense layer(weights, bias, Relu);
+    Matrix output = layer.applyBatch(batch);
+    bool rowsMatch = true;
+    for(int s = 0; s < BATCH; s++)
+    {
+        Matrix sample(COLS, 1);
+        std::memcpy(sample.data(), batch.data() + (size_t) s * COLS, sizeof(float) * COLS);
+        Matrix single = layer(sample);
+        for(int i = 0; i < ROWS; i++)
+        {
+            rowsMatch = rowsMatch && std::fabs(single.at(i, 0) - output.at(s, i)) <= tolerance;
+        }
+    }
+    check(rowsMatch, "f32 applyBatch vs a sample at a time");
+
+    BasicMatrix<int8_t> integer = BasicMatrix<int8_t>::quantize(weights);
+    Matrix integerValues(integer.dequantize());
+    check(maxDifference(BasicDense<int8_t, double>(integer, bias, Relu).applyBatch(batch),
+                        Dense(integerValues, bias, Relu).applyBatch(batch)) <= tolerance,
+          "i8 (f64) applyBatch vs f32 layer");
+
+    BasicMatrix<BFloat16> brain = BasicMatrix<BFloat16>::quantize(weights);
+    Matrix brainValues(brain.dequantize());
+    check(maxDifference(BasicDense<BFloat16, double>(brain, bias, Relu).applyBatch(batch),
+                        Dense(brainValues, bias, Relu).applyBatch(batch)) <= tolerance,
+          "bf16 (f64) applyBatch vs f32 layer");
+}
+
+/**
+ * Checks a packed layer against W x + b for a single sample and for a batch (with every batch tile,
+ * which have to agree exactly), and its write/read round trip.
+ * @param random the generator
+ */
+void checkPacked(std::mt19937 &random)
+{
+    Matrix weights = randomMatrix(ROWS, COLS, -1, 1, random);
+    Matrix bias = randomMatrix(ROWS, 1, -1, 1, random);
+    Matrix batch = randomMatrix(BATCH, COLS, -1, 1, random);
+    double tolerance = FLOAT_EPSILON * (productMagnitude(weights, batch.transpose()) + 1);
+    Matrix expected(BATCH, ROWS);
+    for(int s = 0; s < BATCH; s++)
+    {
+        for(int i = 0; i < ROWS; i++)
+        {
+            double sum = bias.at(i, 0);
+            for(int k = 0; k < COLS; k++)
+            {
+                sum += (double) weights.at(i, k) * batch.at(s, k);
+            }
+            expected.data()[(size_t) s * ROWS + i] = (float) sum;
+        }
+    }
+
+    PackedWeights packed(weights, bias);
+    Matrix single(1, ROWS);
+    packed.apply(batch.data(), single.data());
+    bool singleMatches = true;
+    for(int i = 0; i < ROWS; i++)
+    {
+        singleMatches = singleMatches && std::fabs(single.at(0, i) - expected.at(0, i)) <= tolerance;
+    }
+    check(singleMatches, "packed apply vs W x + b");
+
+    Matrix output(BATCH, ROWS);
+    packed.applyBatch(batch.data(), BATCH, output.data());
+    check(maxDifference(output, expected) <= tolerance, "packed applyBatch vs W x + b");
+
+    for(int tile : {1, 2, 4, PackedWeights::MAX_BATCH_TILE})
+    {
+        Matrix tiled(BATCH, ROWS), relu(BATCH, ROWS), reference(BATCH, ROWS);
+        (packed.*PackedWeights::batchKernel(false, tile))(batch.data(), BATCH, tiled.data());
+        (packed.*PackedWeights::batchKernel(true, tile))(batch.data(), BATCH, relu.data());
+        for(int i = 0; i < BATCH * ROWS; i++)
+        {
+            reference.data()[i] = std::max(output.data()[i], 0.0f);
+        }
+        check(maxDifference(tiled, output) == 0, "packed kernel of tile " + std::to_string(tile));
+        check(maxDifference(relu, reference) == 0, "packed Relu kernel of tile " + std::to_string(tile));
+    }
+
+    std::stringstream file;
+    packed.write(file);
+    PackedWeights read;
+    Matrix readOutput(BATCH, ROWS);
+    bool readOk = read.read(file);
+    if(readOk)
+    {
+        read.applyBatch(batch.data(), BATCH, readOutput.data());
+    }
+    check(readOk && read.getRows() == ROWS && read.getCols() == COLS &&
+          read.getPackedLength() == packed.getPackedLength() &&
+          std::memcmp(read.getPanels(), packed.getPanels(), sizeof(float) * packed.getPackedLength()) == 0 &&
+          maxDifference(readOutput, output) == 0, "packed write/read round trip");
+
+    std::stringstream truncated(file.str().substr(0, file.str().size() - 1));
+    check(!read.read(truncated), "truncated packed layer is rejected");
+}
+
+/**
+ * Checks the slot states of the shared memory ring over several laps: a full ring claims nothing,
+ * unpublished slots aren't taken, unanswered ones aren't collected, a run stops at the end of the ring,
+ * and byte frames are normalized.
+ */
+void checkRing()
+{
+    std::string name = RING_NAME + std::to_string(getpid());
+    ShmRing consumer(name, RING_SLOTS);
+    ShmRing producer(name);
+    uint64_t tickets[RING_SLOTS];
+    Digit results[RING_SLOTS];
+    ResponseFrame response;
+    const float *frames;
+    bool ordered = true, normalized = true;
+
+    for(int lap = 0; lap < RING_LAPS; lap++)
+    {
+        // Half a ring per step, so runs start mid-ring too.
+        for(int half = 0; half < 2; half++)
+        {
+            int count = RING_SLOTS / 2;
+            for(int i = 0; i < count; i++)
+            {
+                unsigned char *pixels = (unsigned char *) producer.claim(ByteFrame, tickets[i]);
+                if(pixels == nullptr)
+                {
+                    check(false, "ring claims a free slot");
+                    return;
+                }
+                std::memset(pixels, i, IMAGE_LENGTH);
+            }
+            check(consumer.takeBatch(RING_SLOTS, frames) == 0, "ring takes no unpublished slot");
+
+            for(int i = 0; i < count; i++)
+            {
+                producer.publish(tickets[i], (uint32_t) (lap * RING_SLOTS + half * count + i));
+            }
+            check(consumer.takeBatch(RING_SLOTS, frames) == count, "ring takes the published run");
+            for(int i = 0; i < count; i++)
+            {
+                float pixel;
+                unsigned char byte = (unsigned char) i;
+                normalizePixels(&byte, 1, &pixel);
+                normalized = normalized && frames[(size_t) i * IMAGE_LENGTH] == pixel &&
+                             frames[(size_t) (i + 1) * IMAGE_LENGTH - 1] == pixel;
+                results[i] = {(unsigned int) i, (float) lap};
+            }
+            check(!producer.collect(tickets[0], response), "ring collects no unanswered slot");
+
+            consumer.answer(count, results);
+            for(int i = 0; i < count; i++)
+            {
+                ordered = ordered && producer.collect(tickets[i], response) &&
+                          response.id == (uint32_t) (lap * RING_SLOTS + half * count + i) &&
+                          response.value == (uint32_t) i && response.probability == (float) lap;
+            }
+        }
+    }
+    check(ordered, "ring responses match their requests");
+    check(normalized, "ring normalizes byte frames");
+
+    // From mid-ring, a run of all but one slot is taken in two: up to the end of the ring, then the rest.
+    bool split = true;
+    for(int step = 0; step < 2; step++)
+    {
+        int count = (step == 0) ? RING_SLOTS / 2 : RING_SLOTS - 1;
+        for(int i = 0; i < count; i++)
+        {
+            split = split && producer.claim(FloatFrame, tickets[i]) != nullptr;
+            producer.publish(tickets[i], (uint32_t) i);
+        }
+        for(int taken = 0, run; taken < count; taken += run)
+        {
+            run = consumer.takeBatch(RING_SLOTS, frames);
+            split = split && run == ((step == 0 || taken > 0) ? count - taken : RING_SLOTS / 2);
+            if(run == 0)
+            {
+                break;
+            }
+            consumer.answer(run, results);
+        }
+        for(int i = 0; i < count; i++)
+        {
+            split = split && producer.collect(tickets[i], response) && response.id == (uint32_t) i;
+        }
+    }
+    check(split, "ring run stops at the end of the ring");
+
+    for(int i = 0; i < RING_SLOTS; i++)
+    {
+        producer.claim(FloatFrame, tickets[0]);
+    }
+    check(producer.claim(FloatFrame, tickets[0]) == nullptr, "full ring claims nothing");
+}
+
+/**
+ * Runs all checks.
+ * @return 0 if all of them passed, 1 otherwise.
+ */
+int main()
+{
+    std::mt19937 random(SEED);
+    Matrix values = randomMatrix(ROWS, COLS, -1, 1, random);
+    Matrix nonNegative = randomMatrix(ROWS, COLS, 0, 1, random);
+    checkElementType<float>(values, "f32");
+    checkElementType<double>(values, "f64");
+    checkElementType<BFloat16>(values, "bf16");
+    checkElementType<int8_t>(values, "i8");
+    checkElementType<uint8_t>(nonNegative, "u8");
+    checkElementType<int32_t>(values, "i32");
+    checkLegacyRead(random);
+    checkProducts(random);
+    checkDense(random);
+    checkPacked(random);
+    checkRing();
+
+    if(failures > 0)
+    {
+        std::cerr << failures << CHECKS_FAILED << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << CHECKS_PASSED << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,510 @@
+/**
+ * @file mlpCompress.cpp
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Compresses the first (and optionally the second) layer of a network into low rank factors
+ * with a truncated SVD, optionally stores the other layers in reduced precision, writes the compressed
+ * network and reports its error, cost and accuracy versus the rank.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+#include "Dense.h"
+#include "ElementType.h"
+#include "IdxDataset.h"
+#include "LowRankDense.h"
+#include "ModelRegistry.h"
+
+#define USAGE_MSG "Usage:\n" \
+                  "\t./mlpcompress [options] w1 w2 w3 w4 b1 b2 b3 b4\n" \
+                  "\twi - the i'th layer's weights\n" \
+                  "\tbi - the i'th layer's biases\n" \
+                  "Options:\n" \
+                  "\t--rank <r> - rank of the first layer's factors (default 32)\n" \
+                  "\t--rank2 <r> - also factorize the second layer, with rank r\n" \
+                  "\t--out <dir> - directory to write the compressed w1.. b1.. into (default compressed)\n" \
+                  "\t--precision <type>[,<type>..] - element type of the weights of the layers which aren't\n" \
+                  "\t                                factorized, one for all or one per layer\n" \
+                  "\t                                (f32 (default), f64, bf16, i8 or i32)\n" \
+                  "\t--evaluate <images> <labels> - also report accuracy and time per image\n" \
+                  "\t                               versus the rank over IDX files, and how often the\n" \
+                  "\t                               written network agrees with a double precision run"
+#define ERROR_CREATE_DIR "Error: Failed to create output directory: "
+#define ERROR_WRITE_PARAMETER "Error: Failed to write Parameters file: "
+#define ERROR_INVALID_DATASET "Error: evaluation dataset is empty or has images of another size"
+
+#define OPTION_PREFIX "--"
+#define ARGS_START_IDX 1
+#define DEFAULT_RANK 32
+#define DEFAULT_OUT_DIR "compressed"
+#define PRECISION_SEPARATOR ','
+#define DIR_MODE 0755
+#define EVALUATE_ROUNDS 3 // Timings are the fastest of the rounds.
+#define PERCENT 100.0
+
+/**
+ * Prints program usage to stdout and exits (code == 1).
+ */
+void usage()
+{
+    std::cout << USAGE_MSG << std::endl;
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * Writes a Matrix as a raw row-major float32 file (the format mlpnetwork loads).
+ * Exits (code == 1) upon failure.
+ * @param path path of the file
+ * @param matrix the matrix to write
+ */
+void writeMatrix(const std::string &path, const Matrix &matrix)
+{
+    std::ofstream os(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    os.write((const char *) matrix.data(),
+             (std::streamsize) ((size_t) matrix.getRows() * matrix.getCols() * sizeof(float)));
+    if(!os.flush())
+    {
+        std::cerr << ERROR_WRITE_PARAMETER << path << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * Writes a Matrix converted to T elements (see BasicMatrix::quantize() and BasicMatrix::write()).
+ * Exits (code == 1) upon failure.
+ * @param path path of the file
+ * @param matrix the matrix to write
+ * @return the real values of the written elements
+ */
+template<typename T>
+Matrix writeConverted(const std::string &path, const Matrix &matrix)
+{
+    BasicMatrix<T> converted = BasicMatrix<T>::quantize(matrix);
+    std::ofstream os(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    converted.write(os);
+    if(!os.flush())
+    {
+        std::cerr << ERROR_WRITE_PARAMETER << path << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    return Matrix(converted.dequantize());
+}
+
+/**
+ * Writes a Matrix in an element type, float32 as a raw file (loadable by every version).
+ * Exits (code == 1) upon failure.
+ * @param path path of the file
+ * @param matrix the matrix to write
+ * @param type the element type
+ * @return the real values of the written elements
+ */
+Matrix writeMatrix(const std::string &path, const Matrix &matrix, ElementType type)
+{
+    switch(type)
+    {
+        case DoubleElement:
+            return writeConverted<double>(path, matrix);
+        case BFloat16Element:
+            return writeConverted<BFloat16>(path, matrix);
+        case Int8Element:
+            return writeConverted<int8_t>(path, matrix);
+        case Int32Element:
+            return writeConverted<int32_t>(path, matrix);
+        default:
+            writeMatrix(path, matrix);
+            return matrix;
+    }
+}
+
+/**
+ * Parses the element types of the layers, one for all or a comma separated one per layer.
+ * Weights are signed, so unsigned types (which clamp negative values to 0) are rejected.
+ * @param list the types
+ * @param types output, the type of every layer
+ * @return false if the list is malformed
+ */
+bool parsePrecision(const std::string &list, ElementType types[MLP_SIZE])
+{
+    std::vector<ElementType> parsed;
+    std::istringstream stream(list);
+    std::string name;
+    while(std::getline(stream, name, PRECISION_SEPARATOR))
+    {
+        ElementType type;
+        if(!parseElementType(name, type) || type == UInt8Element)
+        {
+            return false;
+        }
+        parsed.push_back(type);
+    }
+    if(parsed.size() != 1 && parsed.size() != MLP_SIZE)
+    {
+        return false;
+    }
+    for(int layer = 0; layer < MLP_SIZE; layer++)
+    {
+        types[layer] = parsed[(parsed.size() == 1) ? 0 : layer];
+    }
+    return true;
+}
+
+/**
+ * Returns the first rank columns of u and rows of v, the truncation of a full rank SVD.
+ * @param u the outer factor of full rank
+ * @param v the inner factor of full rank
+ * @param rank the rank to truncate to
+ * @param truncatedU output, the truncated outer factor
+ * @param truncatedV output, the truncated inner factor
+ */
+void truncate(const Matrix &u, const Matrix &v, int rank, Matrix &truncatedU, Matrix &truncatedV)
+{
+    truncatedU = Matrix(u.colRange(0, rank));
+    truncatedV = Matrix(v.rowRange(0, rank));
+}
+
+/**
+ * Returns the Frobenius norm of a - b, relative to the norm of a.
+ * @param a the reference matrix
+ * @param b the approximation
+ * @return the relative error
+ */
+double relativeError(const Matrix &a, const Matrix &b)
+{
+    double error = 0.0, norm = 0.0;
+    for(int i = 0; i < a.getRows(); i++)
+    {
+        for(int j = 0; j < a.getCols(); j++)
+        {
+            double difference = (double) a.at(i, j) - b.at(i, j);
+            error += difference * difference;
+            norm += (double) a.at(i, j) * a.at(i, j);
+        }
+    }
+    return std::sqrt(error / norm);
+}
+
+/**
+ * Returns the multiplications a network takes per image.
+ * @param factors the factorized layers
+ * @return the amount of multiplications
+ */
+long multiplications(const LowRankFactors &factors)
+{
+    long total = 0;
+    for(int i = 0; i < MLP_SIZE; i++)
+    {
+        int rank = factors.ranks[i];
+        total += (rank == 0) ? (long) weightsDims[i].rows * weightsDims[i].cols
+                             : (long) rank * (weightsDims[i].rows + weightsDims[i].cols);
+    }
+    return total;
+}
+
+/**
+ * Returns the accuracy of a network over a batch, and the time (microseconds) per image
+ * of the fastest of EVALUATE_ROUNDS passes.
+ * @param mlp the network
+ * @param batch the images, one per row
+ * @param labels the label of every image
+ * @param us output, the time per image
+ * @return the fraction of correctly recognized images
+ */
+double evaluate(const MlpNetwork &mlp, const Matrix &batch, const std::vector<int> &labels, double &us)
+{
+    std::vector<Digit> results(batch.getRows());
+    for(int round = 0; round < EVALUATE_ROUNDS; round++)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        mlp.predictBatch(batch, results.data());
+        std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+        double roundUs = elapsed.count() / batch.getRows();
+        us = (round == 0) ? roundUs : std::min(us, roundUs);
+    }
+
+    int correct = 0;
+    for(int i = 0; i < batch.getRows(); i++)
+    {
+        correct += (int) results[i].value == labels[i];
+    }
+    return (double) correct / batch.getRows();
+}
+
+/**
+ * Applies a layer on a batch as written (its weights converted to T elements, see writeMatrix()),
+ * accumulating in double precision.
+ * @param weights the weights of the layer
+ * @param bias the bias of the layer
+ * @param type the activation of the layer
+ * @param batch the input, a sample in every row
+ * @return the output, a sample in every row
+ */
+template<typename T>
+Matrix referenceLayer(const Matrix &weights, const Matrix &bias, ActivationType type, const Matrix &batch)
+{
+    BasicMatrix<T> converted = BasicMatrix<T>::quantize(weights);
+    return BasicDense<T, double>(converted, bias, type).applyBatch(batch);
+}
+
+/**
+ * Applies the written network on a batch in double precision, every layer in the element type
+ * it was written in (a factorized layer as the product of its float factors).
+ * @param weights the weights of every layer before conversion (the product of its factors if factorized)
+ * @param biases the bias of every layer
+ * @param factors the factorized layers
+ * @param precision the element type of every layer which isn't factorized
+ * @param batch the images, one per row
+ * @return the probabilities of every image, one per row
+ */
+Matrix reference(const Matrix weights[], const Matrix biases[], const LowRankFactors &factors,
+                 const ElementType precision[], const Matrix &batch)
+{
+    Matrix output(batch);
+    for(int layer = 0; layer < MLP_SIZE; layer++)
+    {
+        ActivationType type = (layer == MLP_SIZE - 1) ? Softmax : Relu;
+        switch((factors.ranks[layer] > 0) ? FloatElement : precision[layer])
+        {
+            case DoubleElement:
+                output = referenceLayer<double>(weights[layer], biases[layer], type, output);
+                break;
+            case BFloat16Element:
+                output = referenceLayer<BFloat16>(weights[layer], biases[layer], type, output);
+                break;
+            case Int8Element:
+                output = referenceLayer<int8_t>(weights[layer], biases[layer], type, output);
+                break;
+            case Int32Element:
+                output = referenceLayer<int32_t>(weights[layer], biases[layer], type, output);
+                break;
+            default:
+                output = referenceLayer<float>(weights[layer], biases[layer], type, output);
+        }
+    }
+    return output;
+}
+
+/**
+ * Returns the fraction of images a network recognizes as the double precision reference of the
+ * written network does (see reference()), and the largest difference of their probabilities.
+ * @param mlp the network
+ * @param probabilities the reference probabilities of every image, one per row
+ * @param batch the images, one per row
+ * @param difference output, the largest difference of the probability of a recognized digit
+ * @return the fraction of images recognized as the reference does
+ */
+double agreement(const MlpNetwork &mlp, const Matrix &probabilities, const Matrix &batch, double &difference)
+{
+    std::vector<Digit> results(batch.getRows());
+    mlp.predictBatch(batch, results.data());
+    int agreed = 0;
+    difference = 0.0;
+    for(int i = 0; i < batch.getRows(); i++)
+    {
+        const float *row = probabilities.data() + (size_t) i * probabilities.getCols();
+        unsigned int expected = (unsigned int) (std::max_element(row, row + probabilities.getCols()) - row);
+        agreed += (int) (results[i].value == expected);
+        difference = std::max(difference, std::fabs((double) results[i].probability - row[results[i].value]));
+    }
+    return (double) agreed / batch.getRows();
+}
+
+/**
+ * Program's main
+ * @param argc count of args
+ * @param argv args values
+ * @return program exit status code
+ */
+int main(int argc, char **argv)
+{
+    int rank = DEFAULT_RANK, rank2 = 0;
+    std::string outDir(DEFAULT_OUT_DIR), imagesPath, labelsPath;
+    ElementType precision[MLP_SIZE] = {FloatElement, FloatElement, FloatElement, FloatElement};
+
+    int i = ARGS_START_IDX;
+    while(i < argc && std::string(argv[i]).rfind(OPTION_PREFIX, 0) == 0)
+    {
+        std::string option(argv[i]);
+        if(i + 1 >= argc)
+        {
+            usage();
+        }
+        std::string value(argv[i + 1]);
+        if(option == "--rank")
+        {
+            rank = std::atoi(value.c_str());
+        }
+        else if(option == "--rank2")
+        {
+            rank2 = std::atoi(value.c_str());
+        }
+        else if(option == "--out")
+        {
+            outDir = value;
+        }
+        else if(option == "--precision")
+        {
+            if(!parsePrecision(value, precision))
+            {
+                usage();
+            }
+        }
+        else if(option == "--evaluate" && i + 2 < argc)
+        {
+            imagesPath = value;
+            labelsPath = argv[i + 2];
+            i++;
+        }
+        else
+        {
+            usage();
+        }
+        i += 2;
+    }
+    if(argc - i != 2 * MLP_SIZE || rank < 1 || rank > std::min(weightsDims[0].rows, weightsDims[0].cols) ||
+       rank2 < 0 || rank2 > std::min(weightsDims[1].rows, weightsDims[1].cols))
+    {
+        usage();
+    }
+
+    ModelRegistry models(std::vector<std::string>(argv + i, argv + argc), ModelOptions());
+    std::shared_ptr<const Model> model = models.acquire();
+    const MlpNetwork &mlp = model->getNetwork();
+    Matrix weights[MLP_SIZE], biases[MLP_SIZE];
+    for(int layer = 0; layer < MLP_SIZE; layer++)
+    {
+        weights[layer] = mlp.getWeights(layer);
+        biases[layer] = mlp.getBias(layer);
+    }
+
+    // A single full rank SVD per layer, every rank is its truncation.
+    Matrix fullU[2], fullV[2];
+    LowRankDense::factorize(weights[0], std::min(weights[0].getRows(), weights[0].getCols()), fullU[0], fullV[0]);
+    LowRankFactors factors;
+    if(rank2 > 0)
+    {
+        LowRankDense::factorize(weights[1], std::min(weights[1].getRows(), weights[1].getCols()),
+                                fullU[1], fullV[1]);
+        truncate(fullU[1], fullV[1], rank2, factors.u[1], factors.v[1]);
+        factors.ranks[1] = rank2;
+    }
+
+    Matrix batch;
+    std::vector<int> labels;
+    if(!imagesPath.empty())
+    {
+        IdxDataset dataset(imagesPath, labelsPath, weightsDims[MLP_SIZE - 1].rows);
+        std::vector<float> pixels;
+        int count = dataset.read(dataset.size(), pixels, labels);
+        if(count == 0 || dataset.imageLength() != weights[0].getCols())
+        {
+            std::cerr << ERROR_INVALID_DATASET << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        batch = Matrix(count, dataset.imageLength());
+        memcpy(batch.data(), pixels.data(), pixels.size() * sizeof(float));
+    }
+
+    std::cout << "rank\terror\tmultiplications";
+    if(!imagesPath.empty())
+    {
+        std::cout << "\taccuracy\ttime/image";
+        double us;
+        double accuracy = evaluate(mlp, batch, labels, us);
+        std::cout << std::endl << "full\t0\t" << multiplications(LowRankFactors()) << "\t"
+                  << PERCENT * accuracy << "%\t" << us << "us";
+    }
+    std::cout << std::endl;
+
+    std::vector<int> ranks = {4, 8, 16, 24, 32, 48, 64, 96, fullV[0].getRows()};
+    ranks.push_back(rank);
+    std::sort(ranks.begin(), ranks.end());
+    ranks.erase(std::unique(ranks.begin(), ranks.end()), ranks.end());
+    for(int candidate : ranks)
+    {
+        if(candidate > fullV[0].getRows())
+        {
+            continue;
+        }
+        truncate(fullU[0], fullV[0], candidate, factors.u[0], factors.v[0]);
+        factors.ranks[0] = candidate;
+        Matrix approximation(factors.u[0] * factors.v[0]);
+        std::cout << candidate << ((candidate == rank) ? "*" : "") << "\t"
+                  << relativeError(weights[0], approximation) << "\t" << multiplications(factors);
+        if(!imagesPath.empty())
+        {
+            Matrix compressed[MLP_SIZE] = {approximation, weights[1], weights[2], weights[3]};
+            MlpNetwork factored(compressed, biases, &factors);
+            double us;
+            double accuracy = evaluate(factored, batch, labels, us);
+            std::cout << "\t" << PERCENT * accuracy << "%\t" << us << "us";
+        }
+        std::cout << std::endl;
+    }
+
+    truncate(fullU[0], fullV[0], rank, factors.u[0], factors.v[0]);
+    factors.ranks[0] = rank;
+    if(mkdir(outDir.c_str(), DIR_MODE) != 0 && errno != EEXIST)
+    {
+        std::cerr << ERROR_CREATE_DIR << outDir << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    Matrix written[MLP_SIZE];
+    for(int layer = 0; layer < MLP_SIZE; layer++)
+    {
+        std::string weightsPath = outDir + "/w" + std::to_string(layer + 1);
+        if(factors.ranks[layer] > 0 && !LowRankDense::write(weightsPath, factors.u[layer], factors.v[layer]))
+        {
+            std::cerr << ERROR_WRITE_PARAMETER << weightsPath << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        else if(factors.ranks[layer] > 0)
+        {
+            written[layer] = factors.u[layer] * factors.v[layer];
+        }
+        else
+        {
+            written[layer] = writeMatrix(weightsPath, weights[layer], precision[layer]);
+        }
+        writeMatrix(outDir + "/b" + std::to_string(layer + 1), biases[layer]);
+    }
+    std::cout << "Compressed parameters (rank " << rank << ", precision";
+    for(int layer = 0; layer < MLP_SIZE; layer++)
+    {
+        std::cout << " " << ((factors.ranks[layer] > 0) ? "factors" : elementName(precision[layer]));
+    }
+    std::cout << ") written to: " << outDir << std::endl;
+    if(!imagesPath.empty())
+    {
+        // As loaded back: reduced precision layers are dequantized into the float network.
+        MlpNetwork compressed(written, biases, &factors);
+        double us;
+        double accuracy = evaluate(compressed, batch, labels, us);
+        std::cout << "Written network accuracy: " << PERCENT * accuracy << "%" << std::endl;
+
+        Matrix unconverted[MLP_SIZE];
+        for(int layer = 0; layer < MLP_SIZE; layer++)
+        {
+            unconverted[layer] = (factors.ranks[layer] > 0) ? written[layer] : weights[layer];
+        }
+        double difference;
+        double agreed = agreement(compressed, reference(unconverted, biases, factors, precision, batch), batch,
+                                  difference);
+        std::cout << "Double precision agreement: " << PERCENT * agreed << "% (largest probability difference: "
+                  << difference << ")" << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
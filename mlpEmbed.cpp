@@ -0,0 +1,176 @@
+/**
+ * @file mlpEmbed.cpp
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Generates the source of a model compiled into the binary (see EmbeddedNetwork.h): compiles
+ * the parameters files into an MlpNetwork and writes the packed panels of every step of its plan
+ * as constant arrays, every float spelled exactly.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "EmbeddedNetwork.h"
+#include "ModelRegistry.h"
+
+#define USAGE_MSG "Usage:\n" \
+                  "\t./mlpembed <output.cpp> w1 w2 w3 w4 b1 b2 b3 b4\n" \
+                  "\twi - the i'th layer's weights (raw, typed or low rank factors, as mlpnetwork loads)\n" \
+                  "\tbi - the i'th layer's biases"
+#define ERROR_INVALID_PARAMETER "Error: invalid Parameters file for layer: "
+#define ERROR_NOT_FINITE "Error: The network holds a value which is not finite, in step: "
+#define ERROR_WRITE_SOURCE "Error: Failed to write the generated source: "
+
+#define ARGS_START_IDX 2
+#define ARGS_COUNT (ARGS_START_IDX + (MLP_SIZE * 2))
+#define FLOATS_PER_LINE 6
+#define FLOAT_LITERAL_LENGTH 32
+
+/**
+ * Prints program usage to stdout and exits (code == 1).
+ */
+void usage()
+{
+    std::cout << USAGE_MSG << std::endl;
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * Returns the C++ name of an activation.
+ * @param activation the activation
+ * @return its enumerator
+ */
+const char *activationName(ActivationType activation)
+{
+    switch(activation)
+    {
+        case Relu:
+            return "Relu";
+        case Softmax:
+            return "Softmax";
+        default:
+            return "Identity";
+    }
+}
+
+/**
+ * Returns a float literal of exactly the given value (hexadecimal, so it never rounds).
+ * @param value the value (finite)
+ * @return the literal
+ */
+std::string floatLiteral(float value)
+{
+    char literal[FLOAT_LITERAL_LENGTH];
+    std::snprintf(literal, sizeof(literal), "%af", (double) value);
+    return literal;
+}
+
+/**
+ * Writes the generated source of a compiled network.
+ * Exits (code == 1) if a value isn't finite.
+ * @param os the output stream
+ * @param output path of the generated source
+ * @param plan the plan of the network
+ * @param source the parameters files the network was compiled from
+ */
+void writeSource(std::ostream &os, const std::string &output, const ExecutionPlan &plan, const std::string &source)
+{
+    os << "/**\n"
+       << " * @file " << output.substr(output.find_last_of('/') + 1) << "\n"
+       << " *\n"
+       << " * @brief Generated by mlpembed from: " << source << "\n"
+       << " * Do not edit, regenerate (make mlpnetwork-embedded) instead.\n"
+       << " */\n\n"
+       << "#include \"EmbeddedNetwork.h\"\n";
+
+    for(int i = 0; i < plan.getSteps(); i++)
+    {
+        const PackedWeights &layer = plan.getLayer(i);
+        const float *panels = layer.getPanels();
+        os << "\nstatic constexpr EmbeddedLayer<" << layer.getRows() << ", " << layer.getCols() << "> STEP_"
+           << i + 1 << " = {{";
+        for(size_t k = 0; k < layer.getPackedLength(); k++)
+        {
+            if(!std::isfinite(panels[k]))
+            {
+                std::cerr << ERROR_NOT_FINITE << plan.getName(i) << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            os << (k % FLOATS_PER_LINE == 0 ? "\n        " : " ") << floatLiteral(panels[k])
+               << (k + 1 < layer.getPackedLength() ? "," : "");
+        }
+        os << "\n}};\n";
+        if(i > 0)
+        {
+            os << "static_assert(STEP_" << i + 1 << ".cols == STEP_" << i << ".rows, \"Steps " << i << " and "
+               << i + 1 << " don't fit.\");\n";
+        }
+    }
+
+    os << "\nconst EmbeddedStep EMBEDDED_STEPS[] = {";
+    for(int i = 0; i < plan.getSteps(); i++)
+    {
+        os << (i == 0 ? "" : ",") << "\n        embeddedStep(STEP_" << i + 1 << ", "
+           << activationName(plan.getActivation(i)) << ", \"" << plan.getName(i) << "\")";
+    }
+    os << "\n};\n"
+       << "const int EMBEDDED_STEP_COUNT = " << plan.getSteps() << ";\n"
+       << "const char *const EMBEDDED_SOURCE = \"" << source << "\";\n";
+}
+
+/**
+ * Program's main
+ * @param argc count of args
+ * @param argv args values
+ * @return program exit status code
+ */
+int main(int argc, char **argv)
+{
+    if(argc != ARGS_COUNT)
+    {
+        usage();
+    }
+
+    std::vector<std::string> paths(argv + ARGS_START_IDX, argv + ARGS_COUNT);
+    ModelParameters parameters;
+    int failedLayer = ModelRegistry::loadParameters(paths, parameters);
+    if(failedLayer != 0)
+    {
+        std::cerr << ERROR_INVALID_PARAMETER << failedLayer << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    MlpNetwork mlp(parameters.weights, parameters.biases, &parameters.factors);
+
+    std::string source;
+    for(const std::string &path : paths)
+    {
+        source += source.empty() ? "" : " ";
+        for(char c : path)
+        {
+            source += (c == '"' || c == '\\') ? std::string("\\") + c : std::string(1, c); // A string literal.
+        }
+    }
+
+    // Through a temporary file, so a failed run never leaves a partial source behind for make.
+    std::string output(argv[1]), temporary = output + ".tmp";
+    std::ofstream os(temporary, std::ios::out | std::ios::trunc);
+    writeSource(os, output, mlp.getPlan(), source);
+    os.close();
+    if(!os || std::rename(temporary.c_str(), output.c_str()) != 0)
+    {
+        std::cerr << ERROR_WRITE_SOURCE << output << std::endl;
+        std::remove(temporary.c_str());
+        exit(EXIT_FAILURE);
+    }
+
+    std::cout << "Embedded " << mlp.getPlan().getSteps() << " steps of " << source << " into " << output
+              << std::endl;
+    return EXIT_SUCCESS;
+}
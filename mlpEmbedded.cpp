@@ -0,0 +1,81 @@
+/**
+ * @file mlpEmbedded.cpp
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Reads digit images and prints the most likely digit and its probability, with the network
+ * compiled into the binary (see EmbeddedNetwork.h): no parameters file is read at startup.
+ */
+
+#include <iostream>
+#include <string>
+
+#include "EmbeddedNetwork.h"
+#include "ImageLoader.h"
+#include "MatrixAllocator.h"
+#include "MlpNetwork.h"
+
+#define QUIT "q"
+#define INSERT_IMAGE_PATH "Please insert image path:"
+#define ERROR_INVALID_INPUT "Error: Failed to retrieve input. Exiting.."
+#define ERROR_INVALID_IMG "Error: invalid image path or size: "
+#define USAGE_MSG "Usage:\n" \
+                  "\t./mlpnetwork-embedded\n" \
+                  "\tthe network is compiled in (see mlpembed), reads image paths until q"
+
+/**
+ * Program's main
+ * @param argc count of args
+ * @param argv args values
+ * @return program exit status code
+ */
+int main(int argc, char **argv)
+{
+    (void) argv;
+    if(argc != 1)
+    {
+        std::cout << USAGE_MSG << std::endl << "Embedded model: " << EMBEDDED_SOURCE << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    EmbeddedNetwork mlp;
+    Matrix img(imgDims.rows, imgDims.cols);
+    MatrixArena arena;
+    std::string imgPath;
+
+    std::cout << INSERT_IMAGE_PATH << std::endl;
+    std::cin >> imgPath;
+    if(!std::cin.good())
+    {
+        std::cout << ERROR_INVALID_INPUT << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    while(imgPath != QUIT)
+    {
+        if(loadImage(imgPath, imgDims.rows, imgDims.cols, img.data()) != UnknownImage)
+        {
+            ArenaScope scope(arena); // Temporaries of the inference are released together.
+            Digit output = mlp(img.view().reshape(imgDims.rows * imgDims.cols, 1));
+            std::cout << "Image processed:" << std::endl
+                      << img << std::endl;
+            std::cout << "Mlp result: " << output.value <<
+                      " at probability: " << output.probability << std::endl;
+        }
+        else
+        {
+            std::cout << ERROR_INVALID_IMG << imgPath << std::endl;
+        }
+
+        std::cout << INSERT_IMAGE_PATH << std::endl;
+        std::cin >> imgPath;
+        if(!std::cin.good())
+        {
+            std::cout << ERROR_INVALID_INPUT << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
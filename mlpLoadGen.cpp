@@ -0,0 +1,259 @@
+/**
+ * @file mlpLoadGen.cpp
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Load generator for the inference server. Keeps a fixed amount of requests in flight
+ * on every connection (or shared memory ring producer) and reports throughput and latency percentiles.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+#include "Protocol.h"
+#include "ShmRing.h"
+
+#define USAGE_MSG "Usage:\n" \
+                  "\t./mlploadgen <port|socket path|shm:name> connections requests depth image...\n" \
+                  "\tshm:name - produce into the shared memory ring of mlpnetwork --shm name\n" \
+                  "\tconnections - amount of concurrent client connections (or ring producers)\n" \
+                  "\trequests - amount of requests sent on every connection\n" \
+                  "\tdepth - amount of requests in flight on every connection\n" \
+                  "\timage - raw float32 image files to send (round robin)"
+#define ERROR_INVALID_IMG "Error: invalid image path or size: "
+#define ERROR_LOST_CONNECTION "Error: Lost connection to the server."
+#define ERROR_BAD_RESPONSE "Error: Unexpected response id."
+
+#define ADDRESS_IDX 1
+#define CONNECTIONS_IDX 2
+#define REQUESTS_IDX 3
+#define DEPTH_IDX 4
+#define IMAGES_START_IDX 5
+#define PERCENT 100.0
+#define SHM_PREFIX "shm:"
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * @struct Request
+ * @brief A request frame as sent on the wire.
+ */
+typedef struct Request
+{
+    RequestHeader header;
+    float image[IMAGE_LENGTH];
+} Request;
+
+/**
+ * Reads a raw float32 image file.
+ * Exits (code == 1) upon failure.
+ * @param path path of the image
+ * @param image the buffer to fill
+ */
+void readImage(const std::string &path, float image[IMAGE_LENGTH])
+{
+    std::ifstream is(path, std::ios::in | std::ios::binary);
+    if(!is.read((char *) image, IMAGE_LENGTH * sizeof(float)) || is.peek() != EOF)
+    {
+        std::cerr << ERROR_INVALID_IMG << path << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * Runs a single connection, keeping depth requests in flight.
+ * @param address the server address
+ * @param images the images to send
+ * @param requests amount of requests to send
+ * @param depth amount of requests in flight
+ * @param latencies output, latency of every request in microseconds
+ */
+void runConnection(const std::string &address, const std::vector<Request> &images, int requests,
+                   int depth, std::vector<double> &latencies)
+{
+    int fd = connectTo(address);
+    std::vector<Clock::time_point> sent(requests);
+    int nextToSend = 0;
+
+    auto send = [&]() {
+        Request request = images[nextToSend % images.size()];
+        request.header.id = (uint32_t) nextToSend;
+        sent[nextToSend] = Clock::now();
+        if(!writeFully(fd, &request, sizeof(request)))
+        {
+            std::cerr << ERROR_LOST_CONNECTION << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        nextToSend++;
+    };
+
+    while(nextToSend < std::min(depth, requests))
+    {
+        send();
+    }
+    for(int received = 0; received < requests; received++)
+    {
+        ResponseFrame response;
+        if(!readFully(fd, &response, sizeof(response)))
+        {
+            std::cerr << ERROR_LOST_CONNECTION << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        if(response.id >= (uint32_t) nextToSend)
+        {
+            std::cerr << ERROR_BAD_RESPONSE << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        latencies.push_back(std::chrono::duration<double, std::micro>(
+                Clock::now() - sent[response.id]).count());
+        if(nextToSend < requests)
+        {
+            send();
+        }
+    }
+    close(fd);
+}
+
+/**
+ * Runs a single producer of a shared memory ring, keeping depth requests in flight.
+ * Yields while the ring is full and the oldest request wasn't answered yet.
+ * @param name the name of the ring
+ * @param images the images to send
+ * @param requests amount of requests to send
+ * @param depth amount of requests in flight
+ * @param latencies output, latency of every request in microseconds
+ */
+void runRingProducer(const std::string &name, const std::vector<Request> &images, int requests,
+                     int depth, std::vector<double> &latencies)
+{
+    ShmRing ring(name);
+    std::vector<Clock::time_point> sent(requests);
+    std::deque<uint64_t> inFlight; // Tickets, oldest first.
+    int nextToSend = 0;
+
+    for(int received = 0; received < requests;)
+    {
+        bool progressed = false;
+        while(nextToSend < requests && (int) inFlight.size() < depth)
+        {
+            uint64_t ticket;
+            float *frame = (float *) ring.claim(FloatFrame, ticket);
+            if(frame == nullptr)
+            {
+                break;
+            }
+            memcpy(frame, images[nextToSend % images.size()].image, IMAGE_LENGTH * sizeof(float));
+            sent[nextToSend] = Clock::now();
+            ring.publish(ticket, (uint32_t) nextToSend);
+            inFlight.push_back(ticket);
+            nextToSend++;
+            progressed = true;
+        }
+
+        ResponseFrame response;
+        if(!inFlight.empty() && ring.collect(inFlight.front(), response))
+        {
+            if(response.id >= (uint32_t) nextToSend)
+            {
+                std::cerr << ERROR_BAD_RESPONSE << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            latencies.push_back(std::chrono::duration<double, std::micro>(
+                    Clock::now() - sent[response.id]).count());
+            inFlight.pop_front();
+            received++;
+        }
+        else if(!progressed)
+        {
+            std::this_thread::yield(); // The consumer may share this core.
+        }
+    }
+}
+
+/**
+ * Returns the given percentile of sorted values.
+ * @param sorted sorted values
+ * @param percentile the percentile (0-100)
+ * @return the value at the percentile
+ */
+double percentile(const std::vector<double> &sorted, double percentile)
+{
+    size_t index = (size_t) (percentile / PERCENT * (double) (sorted.size() - 1));
+    return sorted[index];
+}
+
+/**
+ * Program's main
+ * @param argc count of args
+ * @param argv args values
+ * @return program exit status code
+ */
+int main(int argc, char **argv)
+{
+    if(argc <= IMAGES_START_IDX)
+    {
+        std::cout << USAGE_MSG << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    std::string address(argv[ADDRESS_IDX]);
+    bool ring = address.rfind(SHM_PREFIX, 0) == 0;
+    int connections = std::atoi(argv[CONNECTIONS_IDX]);
+    int requests = std::atoi(argv[REQUESTS_IDX]);
+    int depth = std::atoi(argv[DEPTH_IDX]);
+    if(connections <= 0 || requests <= 0 || depth <= 0 || (!ring && !isValidAddress(address)))
+    {
+        std::cout << USAGE_MSG << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    std::vector<Request> images(argc - IMAGES_START_IDX);
+    for(size_t i = 0; i < images.size(); i++)
+    {
+        readImage(argv[IMAGES_START_IDX + i], images[i].image);
+    }
+
+    std::vector<std::vector<double>> latencies(connections);
+    std::vector<std::thread> threads;
+    Clock::time_point start = Clock::now();
+    for(int i = 0; i < connections; i++)
+    {
+        if(ring)
+        {
+            threads.emplace_back(runRingProducer, address.substr(strlen(SHM_PREFIX)), std::cref(images),
+                                 requests, depth, std::ref(latencies[i]));
+        }
+        else
+        {
+            threads.emplace_back(runConnection, address, std::cref(images), requests, depth,
+                                 std::ref(latencies[i]));
+        }
+    }
+    for(std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<double> all;
+    for(const std::vector<double> &connectionLatencies : latencies)
+    {
+        all.insert(all.end(), connectionLatencies.begin(), connectionLatencies.end());
+    }
+    std::sort(all.begin(), all.end());
+
+    std::cout << "Requests: " << all.size() << " in " << seconds << "s ("
+              << (double) all.size() / seconds << " req/s)" << std::endl;
+    std::cout << "Latency (us): p50 " << percentile(all, 50) << ", p90 " << percentile(all, 90)
+              << ", p99 " << percentile(all, 99) << ", max " << all.back() << std::endl;
+    return EXIT_SUCCESS;
+}
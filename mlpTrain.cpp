@@ -0,0 +1,176 @@
+/**
+ * @file mlpTrain.cpp
+ * @author  Jason Elter <jason.elter@mail.huji.ac.il>
+ * @version 1.0
+ * @date 18 October 2026
+ *
+ * @brief Trains a network on IDX data and writes its weights and biases
+ * in the format mlpnetwork loads.
+ */
+
+#include <cerrno>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+
+#include "IdxDataset.h"
+#include "Trainer.h"
+
+#define USAGE_MSG "Usage:\n" \
+                  "\t./mlptrain [options] train-images train-labels [test-images test-labels]\n" \
+                  "\tIDX files, images as uint8 (scaled into [0, 1]) or float32.\n" \
+                  "Options:\n" \
+                  "\t--hidden <w,w,..> - widths of the hidden layers (default 128,64,20)\n" \
+                  "\t--epochs <n> - passes over the training data (default 10)\n" \
+                  "\t--batch <n> - samples per update (default 64)\n" \
+                  "\t--threads <n> - threads every minibatch is split between (default 1)\n" \
+                  "\t--optimizer <sgd|adam> - update rule (default adam)\n" \
+                  "\t--lr <x> - learning rate (default 0.001)\n" \
+                  "\t--seed <n> - seed of the initialization and shuffling (default 1)\n" \
+                  "\t--init <dir> - start from the w1.. b1.. files of a directory\n" \
+                  "\t--out <dir> - directory to write w1.. b1.. into (default trained)"
+#define ERROR_CREATE_DIR "Error: Failed to create output directory: "
+
+#define OPTION_PREFIX "--"
+#define ARGS_START_IDX 1
+#define TRAIN_ARGS 2
+#define TRAIN_AND_TEST_ARGS 4
+#define CLASSES 10
+#define DEFAULT_EPOCHS 10
+#define DEFAULT_OUT_DIR "trained"
+#define DIR_MODE 0755
+
+/**
+ * Prints program usage to stdout and exits (code == 1).
+ */
+void usage()
+{
+    std::cout << USAGE_MSG << std::endl;
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * Parses a comma separated list of layer widths.
+ * @param list the list
+ * @return the widths
+ */
+std::vector<int> parseWidths(const std::string &list)
+{
+    std::vector<int> widths;
+    std::stringstream stream(list);
+    std::string width;
+    while(std::getline(stream, width, ','))
+    {
+        int value = std::atoi(width.c_str());
+        if(value <= 0)
+        {
+            usage();
+        }
+        widths.push_back(value);
+    }
+    return widths;
+}
+
+/**
+ * Program's main
+ * @param argc count of args
+ * @param argv args values
+ * @return program exit status code
+ */
+int main(int argc, char **argv)
+{
+    TrainerOptions options;
+    int epochs = DEFAULT_EPOCHS;
+    std::string initDir, outDir(DEFAULT_OUT_DIR);
+
+    int i = ARGS_START_IDX;
+    for(; i < argc && std::string(argv[i]).rfind(OPTION_PREFIX, 0) == 0; i += 2)
+    {
+        std::string option(argv[i]);
+        if(i + 1 >= argc)
+        {
+            usage();
+        }
+        std::string value(argv[i + 1]);
+        if(option == "--hidden")
+        {
+            options.hidden = parseWidths(value);
+        }
+        else if(option == "--epochs")
+        {
+            epochs = std::atoi(value.c_str());
+        }
+        else if(option == "--batch")
+        {
+            options.batchSize = std::atoi(value.c_str());
+        }
+        else if(option == "--threads")
+        {
+            options.threads = std::atoi(value.c_str());
+        }
+        else if(option == "--optimizer" && (value == "sgd" || value == "adam"))
+        {
+            options.optimizer = (value == "sgd") ? Sgd : Adam;
+        }
+        else if(option == "--lr")
+        {
+            options.learningRate = std::strtof(value.c_str(), nullptr);
+        }
+        else if(option == "--seed")
+        {
+            options.seed = (unsigned int) std::strtoul(value.c_str(), nullptr, 10);
+        }
+        else if(option == "--init")
+        {
+            initDir = value;
+        }
+        else if(option == "--out")
+        {
+            outDir = value;
+        }
+        else
+        {
+            usage();
+        }
+    }
+
+    int positional = argc - i;
+    if((positional != TRAIN_ARGS && positional != TRAIN_AND_TEST_ARGS) || epochs < 0)
+    {
+        usage();
+    }
+
+    IdxDataset train(argv[i], argv[i + 1], CLASSES);
+    IdxDataset *test = (positional == TRAIN_AND_TEST_ARGS) ? new IdxDataset(argv[i + 2], argv[i + 3], CLASSES)
+                                                          : nullptr;
+
+    Trainer trainer(train.imageLength(), CLASSES, options);
+    if(!initDir.empty())
+    {
+        trainer.loadParameters(initDir);
+    }
+
+    for(int epoch = 1; epoch <= epochs; epoch++)
+    {
+        float loss = trainer.trainEpoch(train);
+        std::cout << "Epoch " << epoch << ": loss " << loss;
+        if(test != nullptr)
+        {
+            std::cout << ", test accuracy " << trainer.evaluate(*test);
+        }
+        std::cout << std::endl;
+    }
+
+    if(mkdir(outDir.c_str(), DIR_MODE) != 0 && errno != EEXIST)
+    {
+        std::cerr << ERROR_CREATE_DIR << outDir << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    trainer.saveParameters(outDir);
+    std::cout << "Parameters written to: " << outDir << std::endl;
+
+    delete test;
+    return EXIT_SUCCESS;
+}